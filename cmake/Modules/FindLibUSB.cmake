@@ -0,0 +1,28 @@
+INCLUDE(FindPkgConfig)
+if(NOT LIBUSB_FOUND)
+  pkg_check_modules (LIBUSB_PKG libusb-1.0)
+  find_path(LIBUSB_INCLUDE_DIRS NAMES libusb.h
+    PATHS
+    ${LIBUSB_PKG_INCLUDE_DIRS}
+    /usr/include/libusb-1.0
+    /usr/local/include/libusb-1.0
+  )
+
+  find_library(LIBUSB_LIBRARIES NAMES usb-1.0
+    PATHS
+    ${LIBUSB_PKG_LIBRARY_DIRS}
+    /usr/lib
+    /usr/local/lib
+  )
+
+if(LIBUSB_INCLUDE_DIRS AND LIBUSB_LIBRARIES)
+  set(LIBUSB_FOUND TRUE CACHE INTERNAL "libusb-1.0 found")
+  message(STATUS "Found libusb-1.0: ${LIBUSB_INCLUDE_DIRS}, ${LIBUSB_LIBRARIES}")
+else(LIBUSB_INCLUDE_DIRS AND LIBUSB_LIBRARIES)
+  set(LIBUSB_FOUND FALSE CACHE INTERNAL "libusb-1.0 found")
+  message(STATUS "libusb-1.0 not found.")
+endif(LIBUSB_INCLUDE_DIRS AND LIBUSB_LIBRARIES)
+
+mark_as_advanced(LIBUSB_LIBRARIES LIBUSB_INCLUDE_DIRS)
+
+endif(NOT LIBUSB_FOUND)
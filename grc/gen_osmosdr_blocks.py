@@ -28,10 +28,10 @@ parameters:
 - id: type
   label: '${direction.title()}put Type'
   dtype: enum
-  options: [fc32]
-  option_labels: [Complex Float32]
+  options: [fc32, sc16, sc8]
+  option_labels: [Complex Float32, Complex Int16, Complex Int8]
   option_attributes:
-      type: [fc32]
+      type: [fc32, sc16, sc8]
   hide: part
 - id: args
   label: 'Device Arguments'
@@ -82,6 +82,12 @@ inputs:
 % if sourk == 'source':
 
 outputs:
+- domain: message
+  id: psd
+  optional: true
+- domain: message
+  id: signal_stats
+  optional: true
 % endif
 - domain: stream
   dtype: ${'$'}{type.type}
@@ -92,6 +98,9 @@ outputs:
 - domain: message
   id: async_msgs
   optional: true
+- domain: message
+  id: tx_underflow
+  optional: true
 % endif
 
 templates:
@@ -100,7 +109,7 @@ templates:
      import time
   make: |
     osmosdr.${sourk}(
-        args="numchan=" + str(${'$'}{nchan}) + " " + ${'$'}{args}
+        args="numchan=" + str(${'$'}{nchan}) + " otype=${'$'}{type} " + ${'$'}{args}
     )
     % for m in range(max_mboards):
     ${'%'} if context.get('num_mboards')() > ${m}:
@@ -180,7 +189,7 @@ documentation: |-
   By using the osmocom $sourk block you can take advantage of a common software api in your application(s) independent of the underlying radio hardware.
 
   Output Type:
-  This parameter controls the data type of the stream in gnuradio. Only complex float32 samples are supported at the moment.
+  This parameter controls the data type of the stream in gnuradio. Integer samples are interleaved I/Q at full scale. They are passed through natively by rtl and hackrf (int8) and bladerf (int16), and converted from and to complex float32 for the other devices. Software DC offset and IQ balance correction only apply to complex float32 streams.
 
   Device Arguments:
   The device argument is a comma delimited string used to locate devices on your system. Device arguments for multiple devices may be given by separating them with a space.
@@ -195,8 +204,9 @@ documentation: |-
     miri=0[,buffers=32] ...
     rtl=serial_number ...
     rtl=0[,rtl_xtal=28.8e6][,tuner_xtal=28.8e6] ...
-    rtl=1[,buffers=32][,buflen=N*512] ...
+    rtl=1[,buffers=32][,buflen=N*512][,overflow=drop_oldest|drop_newest|zero_fill] ...
     rtl=2[,direct_samp=0|1|2][,offset_tune=0|1][,bias=0|1] ...
+    rtl=3[,ddc=0|1][,ddc_rate=2.4e6] ...
     rtl_tcp=127.0.0.1:1234[,psize=16384][,direct_samp=0|1|2][,offset_tune=0|1][,bias=0|1] ...
     osmosdr=0[,buffers=32][,buflen=N*512] ...
     file='/path/to/your file',rate=1e6[,freq=100e6][,repeat=true][,throttle=true] ...
@@ -204,19 +214,45 @@ documentation: |-
     sdr-ip=127.0.0.1[:50000]
     cloudiq=127.0.0.1[:50000]
     sdr-iq=/dev/ttyUSB0
-    airspy=0[,bias=0|1][,linearity][,sensitivity]
+    airspy=0[,bias=0|1][,linearity][,sensitivity][,overflow=drop_oldest|drop_newest|zero_fill][,ddc=0|1][,ddc_rate=2.5e6]
   % endif
   % if sourk == 'sink':
     file='/path/to/your file',rate=1e6[,freq=100e6][,append=true][,throttle=true] ...
+    hackrf=0[,prefill=4|20ms]
+    bladerf=0[,prefill=4|20ms]
+    soapy=0[,prefill=4|20ms]
   % endif
     redpitaya=192.168.1.100[:1001]
     freesrp=0[,fx3='path/to/fx3.img',fpga='path/to/fpga.bin',loopback]
-    hackrf=0[,buffers=32][,bias=0|1][,bias_tx=0|1]
+    hackrf=0[,buffers=32][,bias=0|1][,bias_tx=0|1][,ddc=0|1][,ddc_rate=8e6]
     bladerf=0[,tamer=internal|external|external_1pps][,smb=25e6]
     uhd[,serial=...][,lo_offset=0][,mcr=52e6][,nchan=2][,subdev='\\\\'B:0 A:0\\\\''] ...
 
   Num Channels:
   Selects the total number of channels in this multi-device configuration. Required when specifying multiple device arguments.
+  % if sourk == 'source':
+  A device given channelize=N (e.g. rtl=0,channelize=16[,bw=100e3][,threads=4]) adds N channels per device channel, numbered after all the device channels. They run at 1/N of the sample rate, channel k centered k*rate/N above the device (the upper half below it). Tuning one of them moves the device, bw sets the filter of all of them.
+  A device given vfos=K (e.g. rtl=0,vfos=3[,vfo_decim=10:20:40]) adds K receivers per device channel, following the channelized ones. Each one is decimated by its own factor and tuned and filtered on its own through the frequency and bandwidth of its channel, without moving the device.
+  A device given psd=N (e.g. rtl=0,psd=1024[,psd_avg=8][,psd_rate=10][,psd_window=hann]) publishes the averaged N point power spectrum of its channels in dB on the psd message port, computed on a worker thread from snapshots of the stream.
+  A device given gate=T (e.g. rtl=0,gate=-40[,gate_hyst=3][,gate_pre=1e-3][,gate_post=1e-3][,gate_min=0]) passes on only the bursts above T dBFS on its channels, tagged burst_start and burst_end, with pre- and post-roll in seconds.
+  An rtl, hackrf or bladerf device given stats=S (e.g. rtl=0,stats=1) publishes the clipped samples, mean I/Q, power and peak of its channels every S seconds on the signal_stats message port.
+  A device given lo_shift=F (e.g. rtl=0,lo_shift=250e3) is tuned F Hz above the center frequency and shifted back digitally, keeping the DC spike out of the center. The shift also takes the fraction of the frequency correction the device can't apply. The rx_freq tags report the center frequency set, not the one of the device.
+  An rtl, hackrf or airspy device given ddc=1 runs at a fixed rate (ddc_rate, 2.4e6, 8e6 and the lowest airspy rate by default) and decimates it to any lower rate set, exact to the Hz. Its output is complex float32 only.
+  % endif
+
+  % if sourk == 'source':
+  Stream Tags:
+  Devices supporting it drop the samples captured while a setting settles (settle=S seconds overrides the default). The first valid sample carries an rx_freq, rx_rate or rx_gain tag with the new value, a named gain stage is tagged as (name . gain).
+  Combined devices are started together, the first sample of every channel carries an rx_time tag of their common start. The rtl, rtl_tcp, hackrf and airspy sources also tag rx_time after dropped samples and once per second, from the host time estimated out of the arrival of the device buffers.
+  On overflow these sources and airspyhf drop the oldest or the newest samples or zero fill them, as chosen by overflow=drop_oldest|drop_newest|zero_fill. The sample following the lost ones is tagged overflow with their count.
+  % endif
+  % if sourk == 'sink':
+  Underflows:
+  hackrf, bladerf and soapy devices are started once prefill buffers (prefill=N) or milliseconds (prefill=Nms) of samples are queued. Every underflow after that is published as a dict (underflows, samples, total_samples) on the tx_underflow message port.
+  % endif
+
+  Command Port:
+  Control requests may also be sent to the command message port as a dict in the format of gr-uhd, with the keys freq, gain, rate, bandwidth, antenna and chan (all channels if omitted), or as a single (key . value) pair. They are applied in the order received.
 
   Sample Rate:
   The sample rate is the number of samples per second output by this block on each channel.
@@ -104,6 +104,11 @@ namespace osmosdr {
      * The device hint "nofake" switches off dummy devices created
      * by "file" (and other) implementations.
      *
+     * All backends are probed concurrently, each one is given "timeout"
+     * seconds (default 5) to respond. Results are cached process wide for
+     * "cache_ttl" seconds (default 5) or until a USB device is attached or
+     * removed, "nocache" forces a new scan.
+     *
      * \param hint a partially (or fully) filled in logical device
      * \return a vector of logical devices for all radios on the system
      */
@@ -0,0 +1,123 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef INCLUDED_OSMOSDR_SETTINGS_H
+#define INCLUDED_OSMOSDR_SETTINGS_H
+
+#include <osmosdr/api.h>
+#include <complex>
+#include <limits>
+#include <vector>
+
+#include <stdint.h>
+
+namespace osmosdr {
+
+  /*!
+   * Settings for a single channel, as applied by apply_settings().
+   * Members left at NAN are not touched.
+   */
+  struct OSMOSDR_API channel_settings_t
+  {
+    channel_settings_t(void) :
+      center_freq(std::numeric_limits<double>::quiet_NaN()),
+      gain(std::numeric_limits<double>::quiet_NaN()),
+      bandwidth(std::numeric_limits<double>::quiet_NaN())
+    {}
+
+    //! center frequency in Hz
+    double center_freq;
+    //! overall gain in dB
+    double gain;
+    //! filter bandwidth in Hz, 0 selects the bandwidth automatically
+    double bandwidth;
+  };
+
+  //! A typedef for a vector of channel settings, indexed by channel
+  typedef std::vector<channel_settings_t> channel_settings_vector_t;
+
+  /*!
+   * A complete configuration: the sample rate shared by all devices
+   * and the settings of each channel. The channel vector may be shorter
+   * than the number of channels, missing channels are not touched.
+   */
+  struct OSMOSDR_API settings_t
+  {
+    settings_t(void) :
+      sample_rate(std::numeric_limits<double>::quiet_NaN())
+    {}
+
+    //! sample rate in Sps
+    double sample_rate;
+    //! per-channel settings
+    channel_settings_vector_t channels;
+  };
+
+  /*!
+   * A single step of a frequency hopping schedule: the samples taken after
+   * tuning to center_freq and settling. Gain is left untouched if NAN.
+   */
+  struct OSMOSDR_API hop_t
+  {
+    hop_t(double center_freq = 0, uint64_t dwell = 0,
+          double gain = std::numeric_limits<double>::quiet_NaN()) :
+      center_freq(center_freq),
+      dwell(dwell),
+      gain(gain)
+    {}
+
+    //! center frequency in Hz
+    double center_freq;
+    //! number of samples to deliver at this frequency
+    uint64_t dwell;
+    //! overall gain in dB
+    double gain;
+  };
+
+  //! A typedef for a hopping schedule, repeated until replaced
+  typedef std::vector<hop_t> hop_schedule_t;
+
+  /*!
+   * Statistics of the samples of a channel over one measuring interval,
+   * relative to the full scale of the converter.
+   */
+  struct OSMOSDR_API signal_stats_t
+  {
+    signal_stats_t(void) :
+      samples(0),
+      clipped(0),
+      power(-std::numeric_limits<double>::infinity()),
+      peak(-std::numeric_limits<double>::infinity())
+    {}
+
+    //! number of samples measured, 0 if none were
+    uint64_t samples;
+    //! samples with I or Q at full scale
+    uint64_t clipped;
+    //! mean of I and Q, the DC offset
+    std::complex<double> mean;
+    //! mean power in dBFS
+    double power;
+    //! peak power in dBFS
+    double peak;
+  };
+
+} //namespace osmosdr
+
+#endif /* INCLUDED_OSMOSDR_SETTINGS_H */
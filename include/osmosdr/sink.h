@@ -23,8 +23,11 @@
 #include <osmosdr/api.h>
 #include <osmosdr/ranges.h>
 #include <osmosdr/time_spec.h>
+#include <osmosdr/settings.h>
 #include <gnuradio/hier_block2.h>
 
+#include <future>
+
 namespace osmosdr {
 
 class sink;
@@ -275,6 +278,62 @@ public:
    */
   virtual osmosdr::freq_range_t get_bandwidth_range( size_t chan = 0 ) = 0;
 
+  /*!
+   * Apply a complete configuration, configuring the devices concurrently.
+   * \param settings the sample rate and the per-channel settings to apply
+   * \return the actual values reported back, NAN for untouched values
+   */
+  virtual osmosdr::settings_t apply_settings( const osmosdr::settings_t &settings ) = 0;
+
+  /*!
+   * Drop the cached device state, the getters query the devices again.
+   */
+  virtual void refresh_state( void ) = 0;
+
+  /*! Queue set_sample_rate() on the control thread, the future gets its result. */
+  virtual std::future<double> set_sample_rate_async( double rate ) = 0;
+
+  /*! Queue set_center_freq() on the control thread, the future gets its result. */
+  virtual std::future<double> set_center_freq_async( double freq, size_t chan = 0 ) = 0;
+
+  /*! Queue set_freq_corr() on the control thread, the future gets its result. */
+  virtual std::future<double> set_freq_corr_async( double ppm, size_t chan = 0 ) = 0;
+
+  /*! Queue set_gain_mode() on the control thread, the future gets its result. */
+  virtual std::future<bool> set_gain_mode_async( bool automatic, size_t chan = 0 ) = 0;
+
+  /*! Queue set_gain() on the control thread, the future gets its result. */
+  virtual std::future<double> set_gain_async( double gain, size_t chan = 0 ) = 0;
+
+  /*! Queue set_gain() on the control thread, the future gets its result. */
+  virtual std::future<double> set_gain_async( double gain,
+                                              const std::string & name,
+                                              size_t chan = 0 ) = 0;
+
+  /*! Queue set_if_gain() on the control thread, the future gets its result. */
+  virtual std::future<double> set_if_gain_async( double gain, size_t chan = 0 ) = 0;
+
+  /*! Queue set_bb_gain() on the control thread, the future gets its result. */
+  virtual std::future<double> set_bb_gain_async( double gain, size_t chan = 0 ) = 0;
+
+  /*! Queue set_antenna() on the control thread, the future gets its result. */
+  virtual std::future<std::string> set_antenna_async( const std::string & antenna,
+                                                      size_t chan = 0 ) = 0;
+
+  /*! Queue set_dc_offset() on the control thread, the future gets its result. */
+  virtual std::future<void> set_dc_offset_async( const std::complex<double> &offset,
+                                                  size_t chan = 0 ) = 0;
+
+  /*! Queue set_iq_balance() on the control thread, the future gets its result. */
+  virtual std::future<void> set_iq_balance_async( const std::complex<double> &balance,
+                                                   size_t chan = 0 ) = 0;
+
+  /*! Queue set_bandwidth() on the control thread, the future gets its result. */
+  virtual std::future<double> set_bandwidth_async( double bandwidth, size_t chan = 0 ) = 0;
+
+  /*! Queue apply_settings() on the control thread, the future gets its result. */
+  virtual std::future<osmosdr::settings_t> apply_settings_async( const osmosdr::settings_t &settings ) = 0;
+
   /*!
    * Set the time source for the device.
    * This sets the method of time synchronization,
@@ -371,6 +430,27 @@ public:
    * \param time_spec the new time
    */
   virtual void set_time_unknown_pps(const ::osmosdr::time_spec_t &time_spec) = 0;
+
+  /*!
+   * Set the device time the following control calls take effect at.
+   * \param time_spec the time the commands take effect at
+   * \param mboard the motherboard index 0 to M-1, all of them by default
+   */
+  virtual void set_command_time(const ::osmosdr::time_spec_t &time_spec,
+                                size_t mboard = ALL_MBOARDS) = 0;
+
+  /*!
+   * Apply the following control calls as soon as possible again.
+   * \param mboard the motherboard index 0 to M-1, all of them by default
+   */
+  virtual void clear_command_time(size_t mboard = ALL_MBOARDS) = 0;
+
+  /*!
+   * Get the number of underflows since the device was opened.
+   * \param mboard the motherboard index 0 to M-1, all of them by default
+   * \return the count, 0 for devices not reporting underflows
+   */
+  virtual uint64_t get_underflows(size_t mboard = ALL_MBOARDS) = 0;
 };
 
 } /* namespace osmosdr */
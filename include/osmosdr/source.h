@@ -23,8 +23,11 @@
 #include <osmosdr/api.h>
 #include <osmosdr/ranges.h>
 #include <osmosdr/time_spec.h>
+#include <osmosdr/settings.h>
 #include <gnuradio/hier_block2.h>
 
+#include <future>
+
 namespace osmosdr {
 
 class source;
@@ -58,6 +61,13 @@ public:
    */
   virtual size_t get_num_channels( void ) = 0;
 
+  /*!
+   * Get the device (mboard index) a channel belongs to.
+   * \param chan the channel index 0 to N-1
+   * \return the device index
+   */
+  virtual size_t get_mboard( size_t chan = 0 ) = 0;
+
   /*!
    * \brief seek file to \p seek_point relative to \p whence
    *
@@ -319,6 +329,86 @@ public:
    */
   virtual osmosdr::freq_range_t get_bandwidth_range( size_t chan = 0 ) = 0;
 
+  /*!
+   * Apply a complete configuration, configuring the devices concurrently.
+   * \param settings the sample rate and the per-channel settings to apply
+   * \return the actual values reported back, NAN for untouched values
+   */
+  virtual osmosdr::settings_t apply_settings( const osmosdr::settings_t &settings ) = 0;
+
+  /*!
+   * Drop the cached device state, the getters query the devices again.
+   */
+  virtual void refresh_state( void ) = 0;
+
+  /*!
+   * Record the following settings until commit_config() or the stream start.
+   */
+  virtual void begin_config( void ) = 0;
+
+  /*!
+   * Apply the settings recorded since begin_config() to all devices.
+   */
+  virtual void commit_config( void ) = 0;
+
+  /*!
+   * Hop the device of a channel through a schedule, repeated until replaced.
+   * \param hops the schedule, an empty one stops hopping
+   * \param chan the channel index 0 to N-1
+   */
+  virtual void set_hop_schedule( const osmosdr::hop_schedule_t &hops,
+                                 size_t chan = 0 ) = 0;
+
+  /*! Queue set_sample_rate() on the control thread, the future gets its result. */
+  virtual std::future<double> set_sample_rate_async( double rate ) = 0;
+
+  /*! Queue set_center_freq() on the control thread, the future gets its result. */
+  virtual std::future<double> set_center_freq_async( double freq, size_t chan = 0 ) = 0;
+
+  /*! Queue set_freq_corr() on the control thread, the future gets its result. */
+  virtual std::future<double> set_freq_corr_async( double ppm, size_t chan = 0 ) = 0;
+
+  /*! Queue set_gain_mode() on the control thread, the future gets its result. */
+  virtual std::future<bool> set_gain_mode_async( bool automatic, size_t chan = 0 ) = 0;
+
+  /*! Queue set_gain() on the control thread, the future gets its result. */
+  virtual std::future<double> set_gain_async( double gain, size_t chan = 0 ) = 0;
+
+  /*! Queue set_gain() on the control thread, the future gets its result. */
+  virtual std::future<double> set_gain_async( double gain,
+                                              const std::string & name,
+                                              size_t chan = 0 ) = 0;
+
+  /*! Queue set_if_gain() on the control thread, the future gets its result. */
+  virtual std::future<double> set_if_gain_async( double gain, size_t chan = 0 ) = 0;
+
+  /*! Queue set_bb_gain() on the control thread, the future gets its result. */
+  virtual std::future<double> set_bb_gain_async( double gain, size_t chan = 0 ) = 0;
+
+  /*! Queue set_antenna() on the control thread, the future gets its result. */
+  virtual std::future<std::string> set_antenna_async( const std::string & antenna,
+                                                      size_t chan = 0 ) = 0;
+
+  /*! Queue set_dc_offset_mode() on the control thread, the future gets its result. */
+  virtual std::future<void> set_dc_offset_mode_async( int mode, size_t chan = 0 ) = 0;
+
+  /*! Queue set_iq_balance_mode() on the control thread, the future gets its result. */
+  virtual std::future<void> set_iq_balance_mode_async( int mode, size_t chan = 0 ) = 0;
+
+  /*! Queue set_dc_offset() on the control thread, the future gets its result. */
+  virtual std::future<void> set_dc_offset_async( const std::complex<double> &offset,
+                                                  size_t chan = 0 ) = 0;
+
+  /*! Queue set_iq_balance() on the control thread, the future gets its result. */
+  virtual std::future<void> set_iq_balance_async( const std::complex<double> &balance,
+                                                   size_t chan = 0 ) = 0;
+
+  /*! Queue set_bandwidth() on the control thread, the future gets its result. */
+  virtual std::future<double> set_bandwidth_async( double bandwidth, size_t chan = 0 ) = 0;
+
+  /*! Queue apply_settings() on the control thread, the future gets its result. */
+  virtual std::future<osmosdr::settings_t> apply_settings_async( const osmosdr::settings_t &settings ) = 0;
+
   /*!
    * Set the time source for the device.
    * This sets the method of time synchronization,
@@ -415,6 +505,27 @@ public:
    * \param time_spec the new time
    */
   virtual void set_time_unknown_pps(const ::osmosdr::time_spec_t &time_spec) = 0;
+
+  /*!
+   * Set the device time the following control calls take effect at.
+   * \param time_spec the time the commands take effect at
+   * \param mboard the motherboard index 0 to M-1, all of them by default
+   */
+  virtual void set_command_time(const ::osmosdr::time_spec_t &time_spec,
+                                size_t mboard = ALL_MBOARDS) = 0;
+
+  /*!
+   * Apply the following control calls as soon as possible again.
+   * \param mboard the motherboard index 0 to M-1, all of them by default
+   */
+  virtual void clear_command_time(size_t mboard = ALL_MBOARDS) = 0;
+
+  /*!
+   * Get the sample statistics of a channel over the last stats= interval.
+   * \param chan the channel index 0 to N-1
+   * \return the statistics, with no samples for devices not gathering them
+   */
+  virtual osmosdr::signal_stats_t get_signal_stats(size_t chan = 0) = 0;
 };
 
 } /* namespace osmosdr */
@@ -0,0 +1,90 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef INCLUDED_OSMOSDR_SWEEP_H
+#define INCLUDED_OSMOSDR_SWEEP_H
+
+#include <osmosdr/api.h>
+#include <osmosdr/source.h>
+#include <gnuradio/hier_block2.h>
+
+namespace osmosdr {
+
+class sweep;
+
+/*!
+ * \brief Sweeps an osmosdr source across a frequency span.
+ * \ingroup block
+ *
+ * The source is hopped through the steps of the span with
+ * source::set_hop_schedule(). Every step is measured with averaged,
+ * Blackman-Harris windowed FFTs, of which only the center bins are
+ * kept, the edges being discarded as the overlap between steps.
+ *
+ * Each complete sweep is published on the "sweep" message port as a PDU:
+ * the metadata dict holds start_freq and bin_width in Hz and the sweep
+ * count, the vector the power per bin in dBFS across the whole span.
+ */
+class OSMOSDR_API sweep : virtual public gr::hier_block2
+{
+public:
+  typedef boost::shared_ptr< sweep > sptr;
+
+  /*!
+   * \brief Return a shared_ptr to a new instance of sweep.
+   *
+   * The sample rate of the source has to be set beforehand.
+   *
+   * \param source the source to sweep
+   * \param start_freq the lower edge of the span in Hz
+   * \param stop_freq the upper edge of the span in Hz
+   * \param fft_size the number of bins per FFT
+   * \param averages the number of FFTs averaged per step
+   * \param overlap the fraction of each FFT discarded at the edges
+   * \param parallel split the span across one channel of each device of
+   *        the source, there have to be at least two
+   * \return a new osmosdr sweep block object
+   */
+  static sptr make( osmosdr::source::sptr source,
+                    double start_freq, double stop_freq,
+                    size_t fft_size = 1024, size_t averages = 8,
+                    double overlap = 0.25, bool parallel = false );
+
+  /*!
+   * Get the number of bins of a complete sweep.
+   * \return the length of the published vectors
+   */
+  virtual size_t get_num_bins( void ) = 0;
+
+  /*!
+   * Get the width of a single bin.
+   * \return the bin width in Hz
+   */
+  virtual double get_bin_width( void ) = 0;
+
+  /*!
+   * Get the center frequencies the source is tuned to.
+   * \return the step frequencies in Hz, in order of the span
+   */
+  virtual std::vector< double > get_step_freqs( void ) = 0;
+};
+
+} /* namespace osmosdr */
+
+#endif /* INCLUDED_OSMOSDR_SWEEP_H */
@@ -30,6 +30,7 @@
 #include <stdexcept>
 #include <iostream>
 #include <algorithm>
+#include <cmath>
 
 #include <boost/assign.hpp>
 #include <boost/format.hpp>
@@ -58,6 +59,22 @@ using namespace boost::assign;
 #define AIRSPY_FUNC_STR(func, arg) \
   boost::str(boost::format(func "(%1%)") % arg) + " has failed"
 
+#define RX_LATENCY (16 * 65536) /* samples in the libairspy transfers in flight */
+#define SETTLE_TIME 1e-3 /* synthesizer lock after a change */
+
+/* deferred settings, in the order they are applied to the device */
+enum {
+  CFG_SAMPLE_RATE,
+  CFG_BANDWIDTH,
+  CFG_FREQ_CORR,
+  CFG_CENTER_FREQ,
+  CFG_GAIN_MODE,
+  CFG_GAIN,
+  CFG_LNA_GAIN,
+  CFG_MIX_GAIN,
+  CFG_IF_GAIN
+};
+
 airspy_source_c_sptr make_airspy_source_c (const std::string & args)
 {
   return gnuradio::get_initial_sptr(new airspy_source_c (args));
@@ -85,6 +102,8 @@ airspy_source_c::airspy_source_c (const std::string &args)
         gr::io_signature::make(MIN_IN, MAX_IN, sizeof (gr_complex)),
         gr::io_signature::make(MIN_OUT, MAX_OUT, sizeof (gr_complex))),
     _dev(NULL),
+    _ddc_enabled(false),
+    _ddc_rate(0),
     _sample_rate(0),
     _center_freq(0),
     _freq_corr(0),
@@ -135,6 +154,36 @@ airspy_source_c::airspy_source_c (const std::string &args)
 
   std::cerr << std::endl;
 
+  _tagger.set_latency( RX_LATENCY );
+  _tagger.set_settle_time( SETTLE_TIME );
+
+  if ( dict.count( "settle" ) )
+    _tagger.set_settle_time( boost::lexical_cast<double>( dict["settle"] ) );
+
+  _overflow = stream_tagger::DROP_OLDEST;
+
+  if ( dict.count( "overflow" ) )
+    _overflow = stream_tagger::parse_overflow_policy( dict["overflow"] );
+
+  _zeros_pending = 0;
+
+  if ( dict.count( "ddc" ) )
+    _ddc_enabled = boost::lexical_cast<bool>( dict["ddc"] );
+
+  /* the lowest device rate by default */
+  _ddc_rate = _sample_rates.size() ? _sample_rates[0].first : 0;
+
+  if ( dict.count( "ddc_rate" ) )
+    _ddc_rate = boost::lexical_cast<double>( dict["ddc_rate"] );
+
+  if ( _ddc_enabled ) {
+    ret = airspy_set_sample_type( _dev, AIRSPY_SAMPLE_INT16_IQ );
+    AIRSPY_THROW_ON_ERROR(ret, "Failed to set the sample type")
+  }
+
+  /* the defaults are applied together with the user settings on start */
+  _config.begin();
+
   set_center_freq( (get_freq_range().start() + get_freq_range().stop()) / 2.0 );
   set_sample_rate( get_sample_rates().start() );
   set_bandwidth( 0 );
@@ -211,18 +260,53 @@ int airspy_source_c::_airspy_rx_callback(airspy_transfer *transfer)
 {
   airspy_source_c *obj = (airspy_source_c *)transfer->ctx;
 
-  return obj->airspy_rx_callback((float *)transfer->samples, transfer->sample_count);
+  return obj->airspy_rx_callback(transfer->samples, transfer->sample_count);
 }
 
 int airspy_source_c::airspy_rx_callback(void *samples, int sample_count)
 {
-  size_t i, n_avail, to_copy, num_samples = sample_count;
+  size_t i, n_avail, to_drop, to_copy, num_samples = sample_count;
   float *sample = (float *)samples;
 
+  const osmosdr::time_spec_t arrival = osmosdr::time_spec_t::get_system_time();
+
+  if ( _ddc_enabled ) { /* counted and queued as decimated samples */
+    if ( _ddc_out.size() < num_samples )
+      _ddc_out.resize( num_samples );
+
+    num_samples = _ddc.process( (const int16_t *)samples, num_samples, &_ddc_out[0] );
+    sample = (float *)&_ddc_out[0];
+  }
+
   _fifo_lock.lock();
 
+  _tagger.received( num_samples, arrival );
+
   n_avail = _fifo->capacity() - _fifo->size();
-  to_copy = (n_avail < num_samples ? n_avail : num_samples);
+
+  /* zeros owed by earlier overruns come first, they keep the time */
+  for (; _zeros_pending && n_avail; _zeros_pending--, n_avail--)
+    _fifo->push_back( gr_complex( 0, 0 ) );
+
+  to_drop = (n_avail < num_samples ? num_samples - n_avail : 0);
+  to_copy = num_samples - to_drop;
+
+  if ( _overflow == stream_tagger::DROP_OLDEST ) {
+    /* the oldest samples make room, the newest are the ones wanted */
+    for (i = 0; i < to_drop && !_fifo->empty(); i++)
+      _fifo->pop_front();
+
+    /* whatever did not fit even into an empty fifo */
+    sample += 2 * (to_drop - i);
+    to_copy = num_samples - (to_drop - i);
+
+    _tagger.lost_oldest( to_drop );
+  } else if ( to_drop && _overflow == stream_tagger::DROP_NEWEST ) {
+    _tagger.lost_newest( to_drop );
+  } else if ( to_drop ) {
+    _zeros_pending += to_drop;
+    _tagger.zero_filled( to_drop );
+  }
 
   for (i = 0; i < to_copy; i++ )
   {
@@ -236,13 +320,13 @@ int airspy_source_c::airspy_rx_callback(void *samples, int sample_count)
   _fifo_lock.unlock();
 
   /* We have made some new samples available to the consumer in work() */
-  if (to_copy) {
+  if (num_samples) {
     //std::cerr << "+" << std::flush;
     _samp_avail.notify_one();
   }
 
   /* Indicate overrun, if neccesary */
-  if (to_copy < num_samples)
+  if (to_drop)
     std::cerr << "O" << std::flush;
 
   return 0; // TODO: return -1 on error/stop
@@ -253,6 +337,10 @@ bool airspy_source_c::start()
   if ( ! _dev )
     return false;
 
+  _config.commit();
+
+  _tagger.sync_start();
+
   int ret = airspy_start_rx( _dev, _airspy_rx_callback, (void *)this );
   if ( ret != AIRSPY_SUCCESS ) {
     std::cerr << "Failed to start RX streaming (" << ret << ")" << std::endl;
@@ -307,7 +395,35 @@ int airspy_source_c::work( int noutput_items,
 
   //std::cerr << "-" << std::flush;
 
-  return noutput_items;
+  /* still under the fifo lock, a concurrent overrun must see them consumed */
+  int nitems = _tagger.process( this, output_items, noutput_items );
+
+  lock.unlock();
+
+  /* still in cache from the FIFO copy above */
+  _corrector.process( (gr_complex *)output_items[0], nitems );
+
+  return nitems;
+}
+
+stream_tagger *airspy_source_c::get_stream_tagger()
+{
+  return &_tagger;
+}
+
+void airspy_source_c::begin_config()
+{
+  _config.begin();
+}
+
+void airspy_source_c::commit_config()
+{
+  _config.commit();
+}
+
+unsigned int airspy_source_c::get_config_generation()
+{
+  return _config.generation();
 }
 
 std::vector<std::string> airspy_source_c::get_devices()
@@ -349,23 +465,36 @@ osmosdr::meta_range_t airspy_source_c::get_sample_rates()
 {
   osmosdr::meta_range_t range;
 
+  /* anything up to the ddc rate, the device rates above it pass through */
+  if ( _ddc_enabled )
+    range += osmosdr::range_t( _ddc_rate / DDC_MAX_DECIMATION, _ddc_rate );
+
   for (size_t i = 0; i < _sample_rates.size(); i++)
-    range += osmosdr::range_t( _sample_rates[i].first );
+    if ( ! _ddc_enabled || _sample_rates[i].first > _ddc_rate )
+      range += osmosdr::range_t( _sample_rates[i].first );
 
   return range;
 }
 
 double airspy_source_c::set_sample_rate( double rate )
 {
+  if ( _config.defer( CFG_SAMPLE_RATE, rate,
+                      [this]( double v ) { set_sample_rate( v ); } ) )
+    return rate;
+
   int ret = AIRSPY_SUCCESS;
 
   if (_dev) {
     bool found_supported_rate = false;
     uint32_t samp_rate_index = 0;
+    double device_rate = rate;
+
+    if ( _ddc_enabled && rate <= _ddc_rate )
+      device_rate = _ddc_rate;
 
     for( unsigned int i = 0; i < _sample_rates.size(); i++ )
     {
-      if( _sample_rates[i].first == rate )
+      if( _sample_rates[i].first == device_rate )
       {
         samp_rate_index = _sample_rates[i].second;
 
@@ -376,12 +505,19 @@ double airspy_source_c::set_sample_rate( double rate )
     if ( ! found_supported_rate )
     {
       throw std::runtime_error(
-        boost::str( boost::format("Unsupported samplerate: %gM") % (rate/1e6) ) );
+        boost::str( boost::format("Unsupported samplerate: %gM") % (device_rate/1e6) ) );
     }
 
+    _tagger.begin_change();
     ret = airspy_set_samplerate( _dev, samp_rate_index );
     if ( AIRSPY_SUCCESS == ret ) {
-      _sample_rate = rate;
+      _sample_rate = device_rate;
+      if ( _ddc_enabled ) {
+        rate = _ddc.set_rates( device_rate, rate );
+        _tagger.set_latency( RX_LATENCY * rate / device_rate );
+      }
+      _tagger.set_sample_rate( rate );
+      _tagger.end_change( pmt::mp("rx_rate"), pmt::from_double( rate ) );
     } else {
       AIRSPY_THROW_ON_ERROR( ret, AIRSPY_FUNC_STR( "airspy_set_samplerate", rate ) )
     }
@@ -392,6 +528,13 @@ double airspy_source_c::set_sample_rate( double rate )
 
 double airspy_source_c::get_sample_rate()
 {
+  double rate;
+  if ( _config.pending( CFG_SAMPLE_RATE, rate ) )
+    return rate;
+
+  if ( _ddc_enabled && _sample_rate > 0 )
+    return _ddc.output_rate();
+
   return _sample_rate;
 }
 
@@ -406,15 +549,23 @@ osmosdr::freq_range_t airspy_source_c::get_freq_range( size_t chan )
 
 double airspy_source_c::set_center_freq( double freq, size_t chan )
 {
+  if ( _config.defer( CFG_CENTER_FREQ, freq,
+                      [this, chan]( double v ) { set_center_freq( v, chan ); } ) )
+    return freq;
+
   int ret;
 
   #define APPLY_PPM_CORR(val, ppm) ((val) * (1.0 + (ppm) * 0.000001))
 
   if (_dev) {
     double corr_freq = APPLY_PPM_CORR( freq, _freq_corr );
+    _tagger.begin_change();
     ret = airspy_set_freq( _dev, uint64_t(corr_freq) );
     if ( AIRSPY_SUCCESS == ret ) {
+      if ( _ddc_enabled ) /* the nco takes the fraction of a Hz the tuner can't */
+        _ddc.set_shift( corr_freq - std::floor( corr_freq ) );
       _center_freq = freq;
+      _tagger.end_change( pmt::mp("rx_freq"), pmt::from_double( freq ) );
     } else {
       AIRSPY_THROW_ON_ERROR( ret, AIRSPY_FUNC_STR( "airspy_set_freq", corr_freq ) )
     }
@@ -425,20 +576,33 @@ double airspy_source_c::set_center_freq( double freq, size_t chan )
 
 double airspy_source_c::get_center_freq( size_t chan )
 {
+  double freq;
+  if ( _config.pending( CFG_CENTER_FREQ, freq ) )
+    return freq;
+
   return _center_freq;
 }
 
 double airspy_source_c::set_freq_corr( double ppm, size_t chan )
 {
+  if ( _config.defer( CFG_FREQ_CORR, ppm,
+                      [this, chan]( double v ) { set_freq_corr( v, chan ); } ) )
+    return ppm;
+
   _freq_corr = ppm;
 
-  set_center_freq( _center_freq );
+  if ( _center_freq > 0 ) /* not tuned yet if applied from the deferred config */
+    set_center_freq( _center_freq );
 
   return get_freq_corr( chan );
 }
 
 double airspy_source_c::get_freq_corr( size_t chan )
 {
+  double ppm;
+  if ( _config.pending( CFG_FREQ_CORR, ppm ) )
+    return ppm;
+
   return _freq_corr;
 }
 
@@ -479,6 +643,10 @@ osmosdr::gain_range_t airspy_source_c::get_gain_range( const std::string & name,
 
 bool airspy_source_c::set_gain_mode( bool automatic, size_t chan )
 {
+  if ( _config.defer( CFG_GAIN_MODE, automatic,
+                      [this, chan]( double v ) { set_gain_mode( v != 0, chan ); } ) )
+    return automatic;
+
   if ( automatic ) {
       airspy_set_lna_agc( _dev, 1 );
       airspy_set_mixer_agc( _dev, 1 );
@@ -497,11 +665,19 @@ bool airspy_source_c::set_gain_mode( bool automatic, size_t chan )
 
 bool airspy_source_c::get_gain_mode( size_t chan )
 {
+  double automatic;
+  if ( _config.pending( CFG_GAIN_MODE, automatic ) )
+    return automatic != 0;
+
   return _auto_gain;
 }
 
 double airspy_source_c::set_gain( double gain, size_t chan )
 {
+  if ( _config.defer( CFG_GAIN, gain,
+                      [this, chan]( double v ) { set_gain( v, chan ); } ) )
+    return gain;
+
   int ret = AIRSPY_SUCCESS;
   osmosdr::gain_range_t gains = get_gain_range( chan );
 
@@ -510,16 +686,20 @@ double airspy_source_c::set_gain( double gain, size_t chan )
     uint8_t value = clip_gain;
 
     if ( _gain_policy == linearity ) {
+        _tagger.begin_change();
         ret = airspy_set_linearity_gain( _dev, value );
         if ( AIRSPY_SUCCESS == ret ) {
           _gain = clip_gain;
+          _tagger.end_change( pmt::mp("rx_gain"), pmt::from_double( _gain ) );
         } else {
           AIRSPY_THROW_ON_ERROR( ret, AIRSPY_FUNC_STR( "airspy_set_linearity_gain", value ) )
         }
     } else if ( _gain_policy == sensitivity ) {
+        _tagger.begin_change();
         ret = airspy_set_sensitivity_gain( _dev, value );
         if ( AIRSPY_SUCCESS == ret ) {
           _gain = clip_gain;
+          _tagger.end_change( pmt::mp("rx_gain"), pmt::from_double( _gain ) );
         } else {
           AIRSPY_THROW_ON_ERROR( ret, AIRSPY_FUNC_STR( "airspy_set_sensitivity_gain", value ) )
         }
@@ -548,20 +728,35 @@ double airspy_source_c::set_gain( double gain, const std::string & name, size_t
 
 double airspy_source_c::get_gain( size_t chan )
 {
+  double gain;
+  if ( _config.pending( CFG_GAIN, gain ) )
+    return gain;
+
   return _gain;
 }
 
 double airspy_source_c::get_gain( const std::string & name, size_t chan )
 {
+  double gain;
+
   if ( "LNA" == name ) {
+    if ( _config.pending( CFG_LNA_GAIN, gain ) )
+      return gain;
+
     return _lna_gain;
   }
 
   if ( "MIX" == name ) {
+    if ( _config.pending( CFG_MIX_GAIN, gain ) )
+      return gain;
+
     return _mix_gain;
   }
 
   if ( "IF" == name ) {
+    if ( _config.pending( CFG_IF_GAIN, gain ) )
+      return gain;
+
     return _vga_gain;
   }
 
@@ -570,6 +765,10 @@ double airspy_source_c::get_gain( const std::string & name, size_t chan )
 
 double airspy_source_c::set_lna_gain( double gain, size_t chan )
 {
+  if ( _config.defer( CFG_LNA_GAIN, gain,
+                      [this, chan]( double v ) { set_lna_gain( v, chan ); } ) )
+    return gain;
+
   int ret = AIRSPY_SUCCESS;
   osmosdr::gain_range_t gains = get_gain_range( "LNA", chan );
 
@@ -577,9 +776,12 @@ double airspy_source_c::set_lna_gain( double gain, size_t chan )
     double clip_gain = gains.clip( gain, true );
     uint8_t value = clip_gain;
 
+    _tagger.begin_change();
     ret = airspy_set_lna_gain( _dev, value );
     if ( AIRSPY_SUCCESS == ret ) {
       _lna_gain = clip_gain;
+      _tagger.end_change( pmt::mp("rx_gain"),
+                          pmt::cons( pmt::mp("LNA"), pmt::from_double( _lna_gain ) ) );
     } else {
       AIRSPY_THROW_ON_ERROR( ret, AIRSPY_FUNC_STR( "airspy_set_lna_gain", value ) )
     }
@@ -590,6 +792,10 @@ double airspy_source_c::set_lna_gain( double gain, size_t chan )
 
 double airspy_source_c::set_mix_gain(double gain, size_t chan)
 {
+  if ( _config.defer( CFG_MIX_GAIN, gain,
+                      [this, chan]( double v ) { set_mix_gain( v, chan ); } ) )
+    return gain;
+
   int ret;
   osmosdr::gain_range_t gains = get_gain_range( "MIX", chan );
 
@@ -597,9 +803,12 @@ double airspy_source_c::set_mix_gain(double gain, size_t chan)
     double clip_gain = gains.clip( gain, true );
     uint8_t value = clip_gain;
 
+    _tagger.begin_change();
     ret = airspy_set_mixer_gain( _dev, value );
     if ( AIRSPY_SUCCESS == ret ) {
       _mix_gain = clip_gain;
+      _tagger.end_change( pmt::mp("rx_gain"),
+                          pmt::cons( pmt::mp("MIX"), pmt::from_double( _mix_gain ) ) );
     } else {
       AIRSPY_THROW_ON_ERROR( ret, AIRSPY_FUNC_STR( "airspy_set_mixer_gain", value ) )
     }
@@ -610,6 +819,10 @@ double airspy_source_c::set_mix_gain(double gain, size_t chan)
 
 double airspy_source_c::set_if_gain(double gain, size_t chan)
 {
+  if ( _config.defer( CFG_IF_GAIN, gain,
+                      [this, chan]( double v ) { set_if_gain( v, chan ); } ) )
+    return gain;
+
   int ret;
   osmosdr::gain_range_t gains = get_gain_range( "MIX", chan );
 
@@ -617,9 +830,12 @@ double airspy_source_c::set_if_gain(double gain, size_t chan)
     double clip_gain = gains.clip( gain, true );
     uint8_t value = clip_gain;
 
+    _tagger.begin_change();
     ret = airspy_set_vga_gain( _dev, value );
     if ( AIRSPY_SUCCESS == ret ) {
       _vga_gain = clip_gain;
+      _tagger.end_change( pmt::mp("rx_gain"),
+                          pmt::cons( pmt::mp("IF"), pmt::from_double( _vga_gain ) ) );
     } else {
       AIRSPY_THROW_ON_ERROR( ret, AIRSPY_FUNC_STR( "airspy_set_vga_gain", value ) )
     }
@@ -649,6 +865,10 @@ std::string airspy_source_c::get_antenna( size_t chan )
 
 double airspy_source_c::set_bandwidth( double bandwidth, size_t chan )
 {
+  if ( _config.defer( CFG_BANDWIDTH, bandwidth,
+                      [this, chan]( double v ) { set_bandwidth( v, chan ); } ) )
+    return bandwidth;
+
   if (bandwidth == 0.f)
     return get_bandwidth( chan );
 
@@ -711,3 +931,28 @@ osmosdr::freq_range_t airspy_source_c::get_bandwidth_range( size_t chan )
 
   return bandwidths;
 }
+
+void airspy_source_c::set_dc_offset_mode( int mode, size_t chan )
+{
+  _corrector.set_dc_offset_mode( mode );
+}
+
+void airspy_source_c::set_dc_offset( const std::complex<double> &offset, size_t chan )
+{
+  _corrector.set_dc_offset( offset );
+}
+
+void airspy_source_c::set_iq_balance_mode( int mode, size_t chan )
+{
+  _corrector.set_iq_balance_mode( mode );
+}
+
+void airspy_source_c::set_iq_balance( const std::complex<double> &balance, size_t chan )
+{
+  _corrector.set_iq_balance( balance );
+}
+
+iq_corrector *airspy_source_c::get_iq_corrector()
+{
+  return &_corrector;
+}
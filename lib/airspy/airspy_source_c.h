@@ -32,6 +32,10 @@
 #include <libairspy/airspy.h>
 
 #include "source_iface.h"
+#include "stream_tagger.h"
+#include "deferred_config.h"
+#include "iq_corrector.h"
+#include "ddc.h"
 
 class airspy_source_c;
 
@@ -88,6 +92,12 @@ public:
 
   static std::vector< std::string > get_devices();
 
+  stream_tagger *get_stream_tagger( void );
+
+  void begin_config( void );
+  void commit_config( void );
+  unsigned int get_config_generation( void );
+
   size_t get_num_channels( void );
 
   osmosdr::meta_range_t get_sample_rates( void );
@@ -122,6 +132,14 @@ public:
   double get_bandwidth( size_t chan = 0 );
   osmosdr::freq_range_t get_bandwidth_range( size_t chan = 0 );
 
+  void set_dc_offset_mode( int mode, size_t chan = 0 );
+  void set_dc_offset( const std::complex<double> &offset, size_t chan = 0 );
+
+  void set_iq_balance_mode( int mode, size_t chan = 0 );
+  void set_iq_balance( const std::complex<double> &balance, size_t chan = 0 );
+
+  iq_corrector *get_iq_corrector( void );
+
 private:
   static int _airspy_rx_callback(airspy_transfer* transfer);
   int airspy_rx_callback(void *samples, int sample_count);
@@ -130,8 +148,19 @@ private:
 
   boost::circular_buffer<gr_complex> *_fifo;
   std::mutex _fifo_lock;
+  stream_tagger::overflow_policy _overflow;
+  size_t _zeros_pending; /* owed to the fifo by earlier overruns */
   std::condition_variable _samp_avail;
 
+  bool _ddc_enabled; /* int16 transfers, decimated before the fifo */
+  double _ddc_rate;
+  ddc _ddc;
+  std::vector<gr_complex> _ddc_out;
+
+  stream_tagger _tagger;
+  deferred_config _config;
+  iq_corrector _corrector;
+
   std::vector< std::pair<double, uint32_t> > _sample_rates;
   double _sample_rate;
   double _center_freq;
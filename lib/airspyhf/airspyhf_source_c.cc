@@ -113,6 +113,13 @@ airspyhf_source_c::airspyhf_source_c (const std::string &args)
 
   std::cerr << std::endl;
 
+  _overflow = stream_tagger::DROP_NEWEST;
+
+  if ( dict.count( "overflow" ) )
+    _overflow = stream_tagger::parse_overflow_policy( dict["overflow"] );
+
+  _zeros_pending = 0;
+
   set_center_freq( (get_freq_range().start() + get_freq_range().stop()) / 2.0 );
   set_sample_rate( get_sample_rates().start() );
 
@@ -164,13 +171,40 @@ int airspyhf_source_c::_airspyhf_rx_callback(airspyhf_transfer_t *transfer)
 
 int airspyhf_source_c::airspyhf_rx_callback(void *samples, int sample_count)
 {
-  size_t i, n_avail, to_copy, num_samples = sample_count;
+  size_t i, n_avail, to_drop, to_copy, num_samples = sample_count;
   float *sample = (float *)samples;
 
+  const osmosdr::time_spec_t arrival = osmosdr::time_spec_t::get_system_time();
+
   _fifo_lock.lock();
 
+  _tagger.received( num_samples, arrival );
+
   n_avail = _fifo->capacity() - _fifo->size();
-  to_copy = (n_avail < num_samples ? n_avail : num_samples);
+
+  /* zeros owed by earlier overruns come first, they keep the time */
+  for (; _zeros_pending && n_avail; _zeros_pending--, n_avail--)
+    _fifo->push_back( gr_complex( 0, 0 ) );
+
+  to_drop = (n_avail < num_samples ? num_samples - n_avail : 0);
+  to_copy = num_samples - to_drop;
+
+  if ( _overflow == stream_tagger::DROP_OLDEST ) {
+    /* the oldest samples make room, the newest are the ones wanted */
+    for (i = 0; i < to_drop && !_fifo->empty(); i++)
+      _fifo->pop_front();
+
+    /* whatever did not fit even into an empty fifo */
+    sample += 2 * (to_drop - i);
+    to_copy = num_samples - (to_drop - i);
+
+    _tagger.lost_oldest( to_drop );
+  } else if ( to_drop && _overflow == stream_tagger::DROP_NEWEST ) {
+    _tagger.lost_newest( to_drop );
+  } else if ( to_drop ) {
+    _zeros_pending += to_drop;
+    _tagger.zero_filled( to_drop );
+  }
 
   for (i = 0; i < to_copy; i++ )
   {
@@ -184,13 +218,13 @@ int airspyhf_source_c::airspyhf_rx_callback(void *samples, int sample_count)
   _fifo_lock.unlock();
 
   /* We have made some new samples available to the consumer in work() */
-  if (to_copy) {
+  if (num_samples) {
     //std::cerr << "+" << std::flush;
     _samp_avail.notify_one();
   }
 
   /* Indicate overrun, if neccesary */
-  if (to_copy < num_samples)
+  if (to_drop)
     std::cerr << "O" << std::flush;
 
   return 0; // TODO: return -1 on error/stop
@@ -201,6 +235,8 @@ bool airspyhf_source_c::start()
   if ( ! _dev )
     return false;
 
+  _tagger.sync_start();
+
   int ret = airspyhf_start( _dev, _airspyhf_rx_callback, (void *)this );
   if ( ret != AIRSPYHF_SUCCESS ) {
     std::cerr << "Failed to start RX streaming (" << ret << ")" << std::endl;
@@ -253,7 +289,13 @@ int airspyhf_source_c::work( int noutput_items,
     _fifo->pop_front();
   }
 
-  return noutput_items;
+  /* still under the fifo lock, a concurrent overrun must see them consumed */
+  return _tagger.process( this, output_items, noutput_items );
+}
+
+stream_tagger *airspyhf_source_c::get_stream_tagger()
+{
+  return &_tagger;
 }
 
 std::vector<std::string> airspyhf_source_c::get_devices()
@@ -316,6 +358,7 @@ double airspyhf_source_c::set_sample_rate( double rate )
     ret = airspyhf_set_samplerate( _dev, samp_rate_index );
     if ( AIRSPYHF_SUCCESS == ret ) {
       _sample_rate = rate;
+      _tagger.set_sample_rate( rate );
     } else {
       AIRSPYHF_THROW_ON_ERROR( ret, AIRSPYHF_FUNC_STR( "airspyhf_set_samplerate", rate ) )
     }
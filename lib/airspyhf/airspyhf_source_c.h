@@ -32,6 +32,7 @@
 #include <libairspyhf/airspyhf.h>
 
 #include "source_iface.h"
+#include "stream_tagger.h"
 
 class airspyhf_source_c;
 
@@ -98,6 +99,7 @@ public:
   std::string set_antenna( const std::string & antenna, size_t chan = 0 );
   std::string get_antenna( size_t chan = 0 );
 
+  stream_tagger *get_stream_tagger( void );
 
 private:
   static int _airspyhf_rx_callback(airspyhf_transfer_t* transfer);
@@ -108,6 +110,9 @@ private:
   boost::circular_buffer<gr_complex> *_fifo;
   std::mutex _fifo_lock;
   std::condition_variable _samp_avail;
+  stream_tagger::overflow_policy _overflow;
+  size_t _zeros_pending; /* owed to the fifo by earlier overruns */
+  stream_tagger _tagger;
 
   std::vector< std::pair<double, uint32_t> > _sample_rates;
   double _sample_rate;
@@ -27,6 +27,8 @@
 
 #include <gnuradio/io_signature.h>
 
+#include "stream_type.h"
+
 #include <boost/lexical_cast.hpp>
 #include <boost/tokenizer.hpp>
 #include <boost/foreach.hpp>
@@ -118,6 +120,26 @@ struct is_nchan_argument
   }
 };
 
+struct is_otype_argument
+{
+  bool operator ()(const std::string &str)
+  {
+    return str.find("otype=") == 0;
+  }
+};
+
+/* the global otype=fc32|sc16|sc8 argument */
+inline stream_type_t args_to_stream_type( const std::string &args )
+{
+  BOOST_FOREACH( std::string arg, args_to_vector( args ) )
+  {
+    if ( is_otype_argument()( arg ) )
+      return stream_type_from_string( param_to_pair( arg ).second );
+  }
+
+  return STREAM_FC32;
+}
+
 inline gr::io_signature::sptr args_to_io_signature( const std::string &args )
 {
   size_t max_nchan = 0;
@@ -139,18 +161,32 @@ inline gr::io_signature::sptr args_to_io_signature( const std::string &args )
                     is_nchan_argument() ),
                   arg_list.end() );
 
+  arg_list.erase( std::remove_if( // as well as the stream type
+                    arg_list.begin(),
+                    arg_list.end(),
+                    is_otype_argument() ),
+                  arg_list.end() );
+
   // try to parse device specific nchan values, assume 1 channel if none given
 
   BOOST_FOREACH( std::string arg, arg_list )
   {
     dict_t dict = params_to_dict(arg);
+    size_t nchan = 1; // assume one channel if none given via args
     if (dict.count("nchan"))
     {
-      dev_nchan += boost::lexical_cast<size_t>( dict["nchan"] );
+      nchan = boost::lexical_cast<size_t>( dict["nchan"] );
     }
-    else // no channels given via args
+    dev_nchan += nchan;
+
+    if (dict.count("channelize")) // followed by the virtual channels
+    {
+      dev_nchan += nchan * boost::lexical_cast<size_t>( dict["channelize"] );
+    }
+
+    if (dict.count("vfos"))
     {
-      dev_nchan++; // assume one channel
+      dev_nchan += nchan * boost::lexical_cast<size_t>( dict["vfos"] );
     }
   }
 
@@ -159,7 +195,8 @@ inline gr::io_signature::sptr args_to_io_signature( const std::string &args )
     throw std::runtime_error("Wrong device arguments specified. Missing nchan?");
 
   const size_t nchan = std::max<size_t>(dev_nchan, 1); // assume at least one
-  return gr::io_signature::make(nchan, nchan, sizeof(gr_complex));
+  const size_t itemsize = stream_item_size( args_to_stream_type( args ) );
+  return gr::io_signature::make(nchan, nchan, itemsize);
 }
 
 #endif // OSMOSDR_ARG_HELPERS_H
@@ -0,0 +1,245 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#endif
+
+#include <boost/algorithm/string.hpp>
+
+#include "arg_helpers.h"
+#include "backend_modules.h"
+#include "backend_registry.h"
+
+backend_t::backend_t( const std::string &name, int rank )
+  : name(name),
+    rank(rank)
+{
+}
+
+backend_registrar::backend_registrar( const backend_t &backend )
+{
+  backend_registry::instance().add( backend );
+}
+
+backend_registry &backend_registry::instance( void )
+{
+  static backend_registry registry;
+
+  return registry;
+}
+
+backend_registry::backend_registry( void )
+{
+  for ( const backend_module_t *module = backend_modules; module->name; module++ ) {
+    entry_t entry;
+
+    entry.backend.name = module->name;
+    boost::split( entry.backend.keys, module->keys, boost::is_any_of(",") );
+    entry.module = module->file;
+    entry.loaded = false;
+    entry.source = module->source;
+    entry.sink = module->sink;
+
+    _entries.push_back( entry );
+  }
+}
+
+void backend_registry::add( const backend_t &backend )
+{
+  std::lock_guard< std::recursive_mutex > lock( _mutex );
+
+  entry_t *entry = NULL;
+
+  for (size_t i = 0; i < _entries.size(); i++)
+    if ( _entries[i].backend.name == backend.name )
+      entry = &_entries[i];
+
+  if ( entry == NULL ) {
+    _entries.push_back( entry_t() );
+    entry = &_entries.back();
+  }
+
+  entry->backend = backend;
+  entry->loaded = true;
+  entry->source = bool(backend.make_source);
+  entry->sink = bool(backend.make_sink);
+}
+
+void backend_registry::load( size_t index )
+{
+  if ( _entries[index].loaded )
+    return;
+
+  std::string dir = OSMOSDR_PLUGIN_DIR;
+  const char *env = getenv( "GR_OSMOSDR_PLUGIN_PATH" );
+  if ( env && strlen( env ) )
+    dir = env;
+
+  std::string path = dir + "/" + _entries[index].module;
+
+  /* the module is never unloaded, its blocks may outlive any flowgraph */
+#ifdef _WIN32
+  if ( ! LoadLibraryA( path.c_str() ) )
+    throw std::runtime_error( "Failed to load backend module " + path +
+                              " (error " + std::to_string( GetLastError() ) + ")" );
+#else
+  if ( ! dlopen( path.c_str(), RTLD_NOW | RTLD_LOCAL ) )
+    throw std::runtime_error( "Failed to load backend module " + path +
+                              ": " + dlerror() );
+#endif
+
+  if ( ! _entries[index].loaded )
+    throw std::runtime_error( "Backend module " + path +
+                              " did not register " + _entries[index].backend.name );
+}
+
+bool backend_registry::find( const std::string &args, bool sink, backend_t &backend )
+{
+  std::lock_guard< std::recursive_mutex > lock( _mutex );
+
+  dict_t dict = params_to_dict( args );
+
+  for (size_t i = 0; i < _entries.size(); i++) {
+    if ( sink ? ! _entries[i].sink : ! _entries[i].source )
+      continue;
+
+    BOOST_FOREACH( std::string key, _entries[i].backend.keys ) {
+      if ( dict.count( key ) ) {
+        load( i );
+        backend = _entries[i].backend;
+        return true;
+      }
+    }
+  }
+
+  return false;
+}
+
+std::vector< std::string > backend_registry::names( bool sink )
+{
+  std::lock_guard< std::recursive_mutex > lock( _mutex );
+
+  std::vector< std::string > names;
+
+  BOOST_FOREACH( entry_t &entry, _entries )
+    if ( sink ? entry.sink : entry.source )
+      names.push_back( entry.backend.name );
+
+  return names;
+}
+
+std::vector< std::string > backend_registry::keys( bool sink )
+{
+  std::lock_guard< std::recursive_mutex > lock( _mutex );
+
+  std::vector< std::string > keys;
+
+  BOOST_FOREACH( entry_t &entry, _entries )
+    if ( sink ? entry.sink : entry.source )
+      keys.insert( keys.end(), entry.backend.keys.begin(), entry.backend.keys.end() );
+
+  return keys;
+}
+
+static bool compare_rank( const backend_t &a, const backend_t &b )
+{
+  return a.rank < b.rank;
+}
+
+std::vector< backend_t > backend_registry::backends( bool sink )
+{
+  std::lock_guard< std::recursive_mutex > lock( _mutex );
+
+  std::vector< backend_t > backends;
+
+  for (size_t i = 0; i < _entries.size(); i++) {
+    if ( sink ? ! _entries[i].sink : ! _entries[i].source )
+      continue;
+
+    /* a broken module must not hide the devices of the others */
+    try {
+      load( i );
+    } catch ( std::exception &ex ) {
+      std::cerr << ex.what() << std::endl;
+      continue;
+    }
+
+    const backend_t &backend = _entries[i].backend;
+    if ( sink ? bool(backend.get_sink_devices) : bool(backend.get_source_devices) )
+      backends.push_back( backend );
+  }
+
+  std::stable_sort( backends.begin(), backends.end(), compare_rank );
+
+  return backends;
+}
+
+std::vector< std::string > backend_registry::source_names( void )
+{
+  return names( false );
+}
+
+std::vector< std::string > backend_registry::sink_names( void )
+{
+  return names( true );
+}
+
+std::vector< std::string > backend_registry::source_keys( void )
+{
+  return keys( false );
+}
+
+std::vector< std::string > backend_registry::sink_keys( void )
+{
+  return keys( true );
+}
+
+bool backend_registry::find_source( const std::string &args, backend_t &backend )
+{
+  return find( args, false, backend );
+}
+
+bool backend_registry::find_sink( const std::string &args, backend_t &backend )
+{
+  return find( args, true, backend );
+}
+
+std::vector< backend_t > backend_registry::source_backends( void )
+{
+  return backends( false );
+}
+
+std::vector< backend_t > backend_registry::sink_backends( void )
+{
+  return backends( true );
+}
@@ -0,0 +1,124 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef OSMOSDR_BACKEND_REGISTRY_H
+#define OSMOSDR_BACKEND_REGISTRY_H
+
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <osmosdr/api.h>
+#include <gnuradio/basic_block.h>
+
+class source_iface;
+class sink_iface;
+
+typedef std::function< void ( const std::string &args,
+                              gr::basic_block_sptr &block,
+                              source_iface *&iface ) > make_source_func_t;
+
+typedef std::function< void ( const std::string &args,
+                              gr::basic_block_sptr &block,
+                              sink_iface *&iface ) > make_sink_func_t;
+
+typedef std::function< std::vector< std::string > ( bool fake ) > get_devices_func_t;
+
+/*
+ * Description of a single backend. The functions a backend does not
+ * implement (e.g. make_sink of a receive-only device) are left empty.
+ */
+struct OSMOSDR_API backend_t
+{
+  backend_t( const std::string &name = "", int rank = 0 );
+
+  std::string name;
+
+  /* device argument keys selecting this backend, including aliases */
+  std::vector< std::string > keys;
+
+  /* position in device discovery, hardware is listed before software */
+  int rank;
+
+  make_source_func_t make_source;
+  make_sink_func_t make_sink;
+  get_devices_func_t get_source_devices;
+  get_devices_func_t get_sink_devices;
+};
+
+/*
+ * Process wide table of backends. Backends linked into the library register
+ * themselves at load time. Backends built as modules (ENABLE_PLUGINS) are
+ * known by name and keys only, and their module is loaded the first time
+ * one of their keys is requested or a full discovery needs them.
+ */
+class OSMOSDR_API backend_registry
+{
+public:
+  static backend_registry &instance( void );
+
+  void add( const backend_t &backend );
+
+  /* names of the backends providing a source or sink, loaded or not */
+  std::vector< std::string > source_names( void );
+  std::vector< std::string > sink_names( void );
+
+  /* all keys selecting a source or sink backend */
+  std::vector< std::string > source_keys( void );
+  std::vector< std::string > sink_keys( void );
+
+  /* the backend selected by a device argument string, false if none */
+  bool find_source( const std::string &args, backend_t &backend );
+  bool find_sink( const std::string &args, backend_t &backend );
+
+  /* every backend able to enumerate devices, ordered by rank */
+  std::vector< backend_t > source_backends( void );
+  std::vector< backend_t > sink_backends( void );
+
+private:
+  backend_registry( void );
+
+  struct entry_t
+  {
+    backend_t backend;
+    std::string module; /* file name, empty for built-in backends */
+    bool loaded;
+    bool source;
+    bool sink;
+  };
+
+  void load( size_t index );
+  bool find( const std::string &args, bool sink, backend_t &backend );
+  std::vector< std::string > names( bool sink );
+  std::vector< std::string > keys( bool sink );
+  std::vector< backend_t > backends( bool sink );
+
+  std::recursive_mutex _mutex; /* modules register while being loaded */
+  std::vector< entry_t > _entries;
+};
+
+/* registers a backend from a static object in its translation unit */
+struct OSMOSDR_API backend_registrar
+{
+  backend_registrar( const backend_t &backend );
+};
+
+#endif // OSMOSDR_BACKEND_REGISTRY_H
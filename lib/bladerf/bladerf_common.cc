@@ -28,6 +28,7 @@
 #include "config.h"
 #endif
 
+#include <algorithm>
 #include <iomanip>
 #include <iostream>
 #include <map>
@@ -141,7 +142,8 @@ bladerf_common::bladerf_common() :
   _samples_per_buffer(NUM_SAMPLES_PER_BUFFER),
   _num_transfers(NUM_TRANSFERS),
   _stream_timeout(STREAM_TIMEOUT_MS),
-  _format(BLADERF_FORMAT_SC16_Q11)
+  _format(BLADERF_FORMAT_SC16_Q11),
+  _command_timed(false)
 {
 }
 
@@ -599,24 +601,80 @@ osmosdr::freq_range_t bladerf_common::freq_range(bladerf_channel ch)
 #endif
 }
 
-double bladerf_common::set_center_freq(double freq, bladerf_channel ch)
+double bladerf_common::set_center_freq(double freq, bladerf_channel ch,
+                                       uint64_t *delay)
 {
   int status;
   uint64_t freqint = static_cast<uint64_t>(freq + 0.5);
+  bool scheduled = false;
+
+  if (delay) {
+    *delay = 0;
+  }
 
   /* Check frequency range */
   if (freqint < freq_range(ch).start() || freqint > freq_range(ch).stop()) {
     BLADERF_WARNING(boost::str(boost::format("Frequency %d Hz is outside "
                     "range, ignoring") % freqint));
   } else {
-    status = bladerf_set_frequency(_dev.get(), ch, freqint);
-    if (status != 0) {
-      BLADERF_THROW_STATUS(status, boost::str(boost::format("Failed to set center "
-                    "frequency to %d Hz") % freqint));
+#ifndef BLADERF_COMPATIBILITY
+    if (_command_timed) {
+      /* the device counts samples, the command time is host time */
+      bladerf_timestamp now;
+      status = bladerf_get_timestamp(_dev.get(), _is_tx(ch) ? BLADERF_TX : BLADERF_RX,
+                                     &now);
+      if (status != 0) {
+        BLADERF_THROW_STATUS(status, "Failed to get timestamp");
+      }
+
+      double ahead = (_command_time - osmosdr::time_spec_t::get_system_time())
+                       .get_real_secs();
+      bladerf_timestamp ahead_samples = static_cast<bladerf_timestamp>(
+                                          std::max(ahead, 0.0) * get_sample_rate(ch));
+      bladerf_timestamp at = now + ahead_samples;
+
+      status = bladerf_schedule_retune(_dev.get(), ch, at, freqint, NULL);
+      if (status != 0) {
+        BLADERF_THROW_STATUS(status, boost::str(boost::format("Failed to schedule "
+                      "retune to %d Hz") % freqint));
+      }
+
+      scheduled = true;
+      if (delay) {
+        *delay = ahead_samples;
+      }
+    } else
+#endif
+    {
+      status = bladerf_set_frequency(_dev.get(), ch, freqint);
+      if (status != 0) {
+        BLADERF_THROW_STATUS(status, boost::str(boost::format("Failed to set center "
+                      "frequency to %d Hz") % freqint));
+      }
+    }
+
+    for (auto it = _gain_ranges.begin(); it != _gain_ranges.end(); ) {
+      if (it->first.first == ch) {
+        it = _gain_ranges.erase(it);
+      } else {
+        ++it;
+      }
     }
   }
 
-  return get_center_freq(ch);
+  /* not tuned yet if scheduled, report what it is going to be */
+  return scheduled ? static_cast<double>(freqint) : get_center_freq(ch);
+}
+
+void bladerf_common::set_command_time(osmosdr::time_spec_t const &time_spec)
+{
+  _command_time = time_spec;
+  _command_timed = true;
+}
+
+void bladerf_common::clear_command_time()
+{
+  _command_timed = false;
 }
 
 double bladerf_common::get_center_freq(bladerf_channel ch)
@@ -696,6 +754,10 @@ double bladerf_common::get_bandwidth(bladerf_channel ch)
 
 std::vector<std::string> bladerf_common::get_gain_names(bladerf_channel ch)
 {
+  if (_gain_names.count(ch)) {
+    return _gain_names[ch];
+  }
+
   std::vector<std::string> names;
 
 #ifdef BLADERF_COMPATIBILITY
@@ -721,6 +783,8 @@ std::vector<std::string> bladerf_common::get_gain_names(bladerf_channel ch)
   };
 #endif
 
+  _gain_names[ch] = names;
+
   return names;
 }
 
@@ -748,6 +812,11 @@ osmosdr::gain_range_t bladerf_common::get_gain_range(std::string const &name,
 
   int status;
   const bladerf_range *range;
+  std::pair<bladerf_channel, std::string> key(ch, name);
+
+  if (_gain_ranges.count(key)) {
+    return _gain_ranges[key];
+  }
 
   if (name == SYSTEM_GAIN_NAME) {
     status = bladerf_get_gain_range(_dev.get(), ch, &range);
@@ -760,7 +829,9 @@ osmosdr::gain_range_t bladerf_common::get_gain_range(std::string const &name,
                          "range for stage '%s'") % name));
   }
 
-  return osmosdr::gain_range_t(range->min, range->max, range->step);
+  _gain_ranges[key] = osmosdr::gain_range_t(range->min, range->max, range->step);
+
+  return _gain_ranges[key];
 #endif
 }
 
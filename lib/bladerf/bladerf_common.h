@@ -31,6 +31,7 @@
 #include <libbladeRF.h>
 
 #include "osmosdr/ranges.h"
+#include "osmosdr/time_spec.h"
 #include "arg_helpers.h"
 
 #include "bladerf_compat.h"
@@ -185,10 +186,17 @@ protected:
   /* Get range of supported RF frequencies for channel ch */
   osmosdr::freq_range_t freq_range(bladerf_channel ch);
   /* Set center RF frequency of channel ch to freq */
-  double set_center_freq(double freq, bladerf_channel ch);
+  /* delay receives the samples a scheduled retune takes effect after */
+  double set_center_freq(double freq, bladerf_channel ch,
+                         uint64_t *delay = NULL);
   /* Get the center RF frequency of channel ch */
   double get_center_freq(bladerf_channel ch);
 
+  /* Schedule the following retunes at the given host time */
+  void set_command_time(osmosdr::time_spec_t const &time_spec);
+  /* Retune right away again */
+  void clear_command_time();
+
   /* Get range of supported bandwidths for channel ch */
   osmosdr::freq_range_t filter_bandwidths(bladerf_channel ch);
   /* Set the bandwidth on channel ch to bandwidth */
@@ -257,6 +265,14 @@ protected:
   bladerf_channel_map _chanmap; /**< map of antennas to channels */
   bladerf_channel_enable_map _enables;  /**< enabled channels */
 
+  /* gain stages and ranges as reported by libbladeRF. The ranges of some
+   * boards depend on the frequency band, so retuning a channel drops them. */
+  std::map<bladerf_channel, std::vector<std::string>> _gain_names;
+  std::map<std::pair<bladerf_channel, std::string>, osmosdr::gain_range_t> _gain_ranges;
+
+  bool _command_timed;          /**< retunes are scheduled at _command_time */
+  osmosdr::time_spec_t _command_time;
+
   /*****************************************************************************
    * Protected constants
    ****************************************************************************/
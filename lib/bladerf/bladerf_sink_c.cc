@@ -71,10 +71,17 @@ bladerf_sink_c::bladerf_sink_c(const std::string &args) :
   _16icbuf(NULL),
   _32fcbuf(NULL),
   _in_burst(false),
-  _running(false)
+  _running(false),
+  _stream_type(STREAM_FC32),
+  _prefilled(false),
+  _prefill(0)
 {
   dict_t dict = params_to_dict(args);
 
+  if (dict.count("prefill")) {
+    _monitor.set_prefill(dict["prefill"]);
+  }
+
   /* Perform src/sink agnostic initializations */
   init(dict, BLADERF_TX);
 
@@ -165,6 +172,12 @@ bool bladerf_sink_c::start()
 
   _in_burst = false;
 
+  /* Hold back the first samples, so the transfers are submitted in a row */
+  _prefilled = false;
+  _prefill = _monitor.prefill(get_sample_rate(), _samples_per_buffer,
+                              _num_buffers * _samples_per_buffer);
+  _prefill_buf.clear();
+
   status = bladerf_sync_config(_dev.get(), _layout, _format, _num_buffers,
                                _samples_per_buffer, _num_transfers,
                                _stream_timeout);
@@ -208,6 +221,16 @@ bool bladerf_sink_c::stop()
 
   _running = false;
 
+  /* A transmission shorter than the prefill still goes out */
+  if (!_prefill_buf.empty()) {
+    status = bladerf_sync_tx(_dev.get(), &_prefill_buf[0],
+                             _prefill_buf.size() / 2, NULL, _stream_timeout);
+    if (status != 0) {
+      BLADERF_WARNING("bladerf_sync_tx error: " << bladerf_strerror(status));
+    }
+    _prefill_buf.clear();
+  }
+
   for (size_t ch = 0; ch < get_max_channels(); ++ch) {
     bladerf_channel brfch = BLADERF_CHANNEL_TX(ch);
     if (get_channel_enable(brfch)) {
@@ -241,31 +264,46 @@ int bladerf_sink_c::work(int noutput_items,
     return 0;
   }
 
-  // copy the samples from input_items
-  gr_complex const **in = reinterpret_cast<gr_complex const **>(&input_items[0]);
-
-  if (nstreams > 1) {
-    // we need to interleave the streams as we copy
-    gr_complex *intl_out = _32fcbuf;
+  if (STREAM_SC16 == _stream_type) {
+    // scale full scale to Q11 while interleaving, no float conversion
+    int16_t *intl_out = _16icbuf;
 
     for (size_t i = 0; i < (noutput_items/nstreams); ++i) {
       for (size_t n = 0; n < nstreams; ++n) {
-        memcpy(intl_out++, in[n]++, sizeof(gr_complex));
+        int16_t const *in = reinterpret_cast<int16_t const *>(input_items[n]);
+        *intl_out++ = in[2*i] >> 4;
+        *intl_out++ = in[2*i + 1] >> 4;
       }
     }
   } else {
-    // no interleaving to do: simply copy everything
-    memcpy(_32fcbuf, in[0], noutput_items * sizeof(gr_complex));
-  }
+    // copy the samples from input_items
+    gr_complex const **in = reinterpret_cast<gr_complex const **>(&input_items[0]);
+
+    if (nstreams > 1) {
+      // we need to interleave the streams as we copy
+      gr_complex *intl_out = _32fcbuf;
+
+      for (size_t i = 0; i < (noutput_items/nstreams); ++i) {
+        for (size_t n = 0; n < nstreams; ++n) {
+          memcpy(intl_out++, in[n]++, sizeof(gr_complex));
+        }
+      }
+    } else {
+      // no interleaving to do: simply copy everything
+      memcpy(_32fcbuf, in[0], noutput_items * sizeof(gr_complex));
+    }
 
-  // convert floating point to fixed point and scale
-  // input_items is gr_complex (2x float), so num_points is 2*noutput_items
-  volk_32f_s32f_convert_16i(_16icbuf, reinterpret_cast<float const *>(_32fcbuf),
-                            SCALING_FACTOR, 2*noutput_items);
+    // convert floating point to fixed point and scale
+    // input_items is gr_complex (2x float), so num_points is 2*noutput_items
+    volk_32f_s32f_convert_16i(_16icbuf, reinterpret_cast<float const *>(_32fcbuf),
+                              SCALING_FACTOR, 2*noutput_items);
+  }
 
   // transmit the samples from the temp buffer
   if (BLADERF_FORMAT_SC16_Q11_META == _format) {
     status = transmit_with_tags(_16icbuf, noutput_items);
+  } else if (!_prefilled) {
+    status = transmit_prefill(_16icbuf, noutput_items);
   } else {
     status = bladerf_sync_tx(_dev.get(), static_cast<void const *>(_16icbuf),
                              noutput_items, NULL, _stream_timeout);
@@ -287,6 +325,42 @@ int bladerf_sink_c::work(int noutput_items,
   return noutput_items;
 }
 
+bool bladerf_sink_c::set_stream_type(stream_type_t type)
+{
+  if (type != STREAM_FC32 && type != STREAM_SC16) {
+    return false;
+  }
+
+  _stream_type = type;
+  set_input_signature(gr::io_signature::make(get_num_channels(),
+                                             get_num_channels(),
+                                             stream_item_size(type)));
+
+  return true;
+}
+
+int bladerf_sink_c::transmit_prefill(int16_t const *samples,
+                                     int noutput_items)
+{
+  int status;
+
+  _prefill_buf.insert(_prefill_buf.end(), samples, samples + 2*noutput_items);
+
+  if (_prefill_buf.size() / 2 < _prefill) {
+    return 0;
+  }
+
+  BLADERF_DEBUG("TX'ing " << _prefill_buf.size() / 2 << " prefilled samples");
+
+  status = bladerf_sync_tx(_dev.get(), &_prefill_buf[0],
+                           _prefill_buf.size() / 2, NULL, _stream_timeout);
+
+  _prefill_buf.clear();
+  _prefilled = true;
+
+  return status;
+}
+
 int bladerf_sink_c::transmit_with_tags(int16_t const *samples,
                                         int noutput_items)
 {
@@ -588,6 +662,28 @@ std::string bladerf_sink_c::get_clock_source(size_t mboard)
   return bladerf_common::get_clock_source(mboard);
 }
 
+bool bladerf_sink_c::set_command_time(const osmosdr::time_spec_t &time_spec,
+                                      size_t mboard)
+{
+  bladerf_common::set_command_time(time_spec);
+#ifdef BLADERF_COMPATIBILITY
+  return false;
+#else
+  return true;
+#endif
+}
+
+bool bladerf_sink_c::command_time_retunes_only()
+{
+  /* the other settings take effect right away, the caller waits for them */
+  return true;
+}
+
+void bladerf_sink_c::clear_command_time(size_t mboard)
+{
+  bladerf_common::clear_command_time();
+}
+
 void bladerf_sink_c::set_biastee_mode(const std::string &mode)
 {
   int status;
@@ -24,6 +24,7 @@
 #include <gnuradio/sync_block.h>
 #include "sink_iface.h"
 #include "bladerf_common.h"
+#include "tx_monitor.h"
 
 #include "osmosdr/ranges.h"
 
@@ -117,10 +118,17 @@ public:
   void set_clock_source(const std::string &source, size_t mboard = 0);
   std::string get_clock_source(size_t mboard);
 
+  bool set_command_time(const osmosdr::time_spec_t &time_spec, size_t mboard = 0);
+  bool command_time_retunes_only();
+  void clear_command_time(size_t mboard = 0);
+
   void set_biastee_mode(const std::string &mode);
 
+  bool set_stream_type(stream_type_t type);
+
 private:
   int transmit_with_tags(int16_t const *samples, int noutput_items);
+  int transmit_prefill(int16_t const *samples, int noutput_items);
 
   // Sample-handling buffers
   int16_t *_16icbuf;              /**< raw samples to bladeRF */
@@ -128,6 +136,11 @@ private:
 
   bool _in_burst;                 /**< are we currently in a burst? */
   bool _running;                  /**< is the sink running? */
+  stream_type_t _stream_type;     /**< fc32 or sc16 */
+  bool _prefilled;                /**< have the held back samples been sent? */
+  uint64_t _prefill;              /**< samples to hold back when starting */
+  std::vector<int16_t> _prefill_buf; /**< samples held back */
+  tx_monitor _monitor;            /**< prefill setting */
   bladerf_channel_layout _layout; /**< channel layout */
 
   gr::thread::mutex d_mutex;      /**< mutex to protect set/work access */
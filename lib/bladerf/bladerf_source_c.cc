@@ -71,6 +71,7 @@ bladerf_source_c::bladerf_source_c(const std::string &args) :
   _16icbuf(NULL),
   _32fcbuf(NULL),
   _running(false),
+  _stream_type(STREAM_FC32),
   _agcmode(BLADERF_GAIN_DEFAULT)
 {
   int status;
@@ -80,6 +81,13 @@ bladerf_source_c::bladerf_source_c(const std::string &args) :
   /* Perform src/sink agnostic initializations */
   init(dict, BLADERF_RX);
 
+  /* Time to discard after a change, on top of the samples in flight */
+  _tagger.set_settle_time(SETTLE_TIME);
+
+  if (dict.count("settle")) {
+    _tagger.set_settle_time(boost::lexical_cast<double>(dict["settle"]));
+  }
+
   /* Handle setting of sampling mode */
   if (dict.count("sampling")) {
     bladerf_sampling sampling = BLADERF_SAMPLING_UNKNOWN;
@@ -166,6 +174,20 @@ bladerf_source_c::bladerf_source_c(const std::string &args) :
   set_max_noutput_items(_samples_per_buffer);
   set_output_multiple(get_num_channels());
 
+  /* Gather statistics of the raw samples */
+  _monitor.set_num_channels(get_num_channels());
+
+  if (dict.count("stats")) {
+    _monitor.set_interval(dict["stats"]);
+  }
+
+  _monitor.attach(this);
+
+  /* Frequency shift of each channel, applied while copying the samples */
+  for (size_t ch = 0; ch < get_num_channels(); ++ch) {
+    _ncos.push_back(std::unique_ptr<nco>(new nco()));
+  }
+
   /* Set channel layout */
   _layout = (get_num_channels() > 1) ? BLADERF_RX_X2 : BLADERF_RX_X1;
 
@@ -228,6 +250,8 @@ bool bladerf_source_c::start()
     BLADERF_THROW_STATUS(status, "bladerf_sync_config failed");
   }
 
+  _tagger.sync_start();
+
   for (size_t ch = 0; ch < get_max_channels(); ++ch) {
     bladerf_channel brfch = BLADERF_CHANNEL_RX(ch);
     if (get_channel_enable(brfch)) {
@@ -244,6 +268,9 @@ bool bladerf_source_c::start()
   _16icbuf = reinterpret_cast<int16_t *>(volk_malloc(2*_samples_per_buffer*sizeof(int16_t), alignment));
   _32fcbuf = reinterpret_cast<gr_complex *>(volk_malloc(_samples_per_buffer*sizeof(gr_complex), alignment));
 
+  /* the transfers being filled hold the samples not yet received */
+  _tagger.set_latency(_num_transfers * _samples_per_buffer / num_streams(_layout));
+
   _running = true;
 
   return true;
@@ -322,13 +349,46 @@ int bladerf_source_c::work(int noutput_items,
     _failures = 0;
   }
 
+  _tagger.received(noutput_items/nstreams);
+
+  // measure the raw samples of every channel while they are in cache
+  if (_monitor.enabled()) {
+    for (size_t n = 0; n < nstreams; ++n) {
+      _monitor.process(n, _16icbuf + 2*n, noutput_items/nstreams,
+                       int16_t(SCALING_FACTOR), nstreams);
+    }
+  }
+
+  if (STREAM_SC16 == _stream_type) {
+    // scale Q11 to full scale while deinterleaving, no float conversion
+    std::vector<int16_t *> out(nstreams);
+    for (size_t n = 0; n < nstreams; ++n) {
+      out[n] = reinterpret_cast<int16_t *>(output_items[n]);
+    }
+
+    int16_t const *deint_in = _16icbuf;
+
+    for (size_t i = 0; i < (noutput_items/nstreams); ++i) {
+      for (size_t n = 0; n < nstreams; ++n) {
+        *out[n]++ = *deint_in++ * 16;
+        *out[n]++ = *deint_in++ * 16;
+      }
+    }
+
+    return _tagger.process(this, output_items, noutput_items/nstreams,
+                           stream_item_size(_stream_type));
+  }
+
   // convert from int16_t to float
   // output_items is gr_complex (2x float), so num_points is 2*noutput_items
   volk_16i_s32f_convert_32f(reinterpret_cast<float *>(_32fcbuf), _16icbuf,
                             SCALING_FACTOR, 2*noutput_items);
 
-  // copy the samples into output_items
-  gr_complex **out = reinterpret_cast<gr_complex **>(&output_items[0]);
+  // copy the samples into output_items, leaving output_items untouched
+  std::vector<gr_complex *> out(nstreams);
+  for (size_t n = 0; n < nstreams; ++n) {
+    out[n] = reinterpret_cast<gr_complex *>(output_items[n]);
+  }
 
   if (nstreams > 1) {
     // we need to deinterleave the multiplex as we copy
@@ -339,12 +399,54 @@ int bladerf_source_c::work(int noutput_items,
         memcpy(out[n]++, deint_in++, sizeof(gr_complex));
       }
     }
+
+    // shift each channel in place, still in cache
+    for (size_t n = 0; n < nstreams; ++n) {
+      gr_complex *chan_out = reinterpret_cast<gr_complex *>(output_items[n]);
+      _ncos[n]->process(chan_out, chan_out, noutput_items/nstreams);
+    }
   } else {
-    // no deinterleaving to do: simply copy everything
-    memcpy(out[0], _32fcbuf, sizeof(gr_complex) * noutput_items);
+    // no deinterleaving to do: shift while copying everything
+    _ncos[0]->process(_32fcbuf, out[0], noutput_items);
+  }
+
+  // every output got noutput_items/nstreams samples
+  return _tagger.process(this, output_items, noutput_items/nstreams);
+}
+
+stream_tagger *bladerf_source_c::get_stream_tagger()
+{
+  return &_tagger;
+}
+
+signal_monitor *bladerf_source_c::get_signal_monitor()
+{
+  return &_monitor;
+}
+
+bool bladerf_source_c::set_freq_shift(double freq, size_t chan)
+{
+  if (STREAM_FC32 != _stream_type || chan >= _ncos.size()) {
+    return false;
   }
 
-  return noutput_items;
+  _ncos[chan]->set_rate(get_sample_rate());
+  _ncos[chan]->set_shift(freq);
+  return true;
+}
+
+bool bladerf_source_c::set_stream_type(stream_type_t type)
+{
+  if (type != STREAM_FC32 && type != STREAM_SC16) {
+    return false;
+  }
+
+  _stream_type = type;
+  set_output_signature(gr::io_signature::make(get_num_channels(),
+                                              get_num_channels(),
+                                              stream_item_size(type)));
+
+  return true;
 }
 
 osmosdr::meta_range_t bladerf_source_c::get_sample_rates()
@@ -354,7 +456,17 @@ osmosdr::meta_range_t bladerf_source_c::get_sample_rates()
 
 double bladerf_source_c::set_sample_rate(double rate)
 {
-  return bladerf_common::set_sample_rate(rate, chan2channel(BLADERF_RX, 0));
+  _tagger.begin_change();
+  double actual = bladerf_common::set_sample_rate(rate, chan2channel(BLADERF_RX, 0));
+
+  _tagger.set_sample_rate(actual);
+  _monitor.set_rate(actual);
+  for (size_t ch = 0; ch < _ncos.size(); ++ch) {
+    _ncos[ch]->set_rate(actual);
+  }
+  _tagger.end_change(pmt::mp("rx_rate"), pmt::from_double(actual));
+
+  return actual;
 }
 
 double bladerf_source_c::get_sample_rate()
@@ -369,7 +481,15 @@ osmosdr::freq_range_t bladerf_source_c::get_freq_range(size_t chan)
 
 double bladerf_source_c::set_center_freq(double freq, size_t chan)
 {
-  return bladerf_common::set_center_freq(freq, chan2channel(BLADERF_RX, chan));
+  uint64_t delay;
+
+  _tagger.begin_change();
+  double actual = bladerf_common::set_center_freq(freq, chan2channel(BLADERF_RX, chan),
+                                                  &delay);
+  /* a scheduled retune only affects the samples from its time on */
+  _tagger.end_change(pmt::mp("rx_freq"), pmt::from_double(actual), delay);
+
+  return actual;
 }
 
 double bladerf_source_c::get_center_freq(size_t chan)
@@ -420,13 +540,22 @@ bool bladerf_source_c::get_gain_mode(size_t chan)
 
 double bladerf_source_c::set_gain(double gain, size_t chan)
 {
-  return bladerf_common::set_gain(gain, chan2channel(BLADERF_RX, chan));
+  _tagger.begin_change();
+  double actual = bladerf_common::set_gain(gain, chan2channel(BLADERF_RX, chan));
+  _tagger.end_change(pmt::mp("rx_gain"), pmt::from_double(actual));
+
+  return actual;
 }
 
 double bladerf_source_c::set_gain(double gain, const std::string &name,
                                   size_t chan)
 {
-  return bladerf_common::set_gain(gain, name, chan2channel(BLADERF_RX, chan));
+  _tagger.begin_change();
+  double actual = bladerf_common::set_gain(gain, name, chan2channel(BLADERF_RX, chan));
+  _tagger.end_change(pmt::mp("rx_gain"),
+                     pmt::cons(pmt::mp(name), pmt::from_double(actual)));
+
+  return actual;
 }
 
 double bladerf_source_c::get_gain(size_t chan)
@@ -553,6 +682,28 @@ std::string bladerf_source_c::get_clock_source(size_t mboard)
   return bladerf_common::get_clock_source(mboard);
 }
 
+bool bladerf_source_c::set_command_time(const osmosdr::time_spec_t &time_spec,
+                                      size_t mboard)
+{
+  bladerf_common::set_command_time(time_spec);
+#ifdef BLADERF_COMPATIBILITY
+  return false;
+#else
+  return true;
+#endif
+}
+
+bool bladerf_source_c::command_time_retunes_only()
+{
+  /* the other settings take effect right away, the caller waits for them */
+  return true;
+}
+
+void bladerf_source_c::clear_command_time(size_t mboard)
+{
+  bladerf_common::clear_command_time();
+}
+
 void bladerf_source_c::set_biastee_mode(const std::string &mode)
 {
   int status;
@@ -24,6 +24,12 @@
 #include <gnuradio/sync_block.h>
 #include "source_iface.h"
 #include "bladerf_common.h"
+#include "stream_tagger.h"
+#include "signal_monitor.h"
+#include "nco.h"
+
+#include <memory>
+#include <vector>
 
 #include "osmosdr/ranges.h"
 
@@ -120,25 +126,42 @@ public:
   void set_clock_source(const std::string &source, size_t mboard = 0);
   std::string get_clock_source(size_t mboard);
 
+  bool set_command_time(const osmosdr::time_spec_t &time_spec, size_t mboard = 0);
+  bool command_time_retunes_only();
+  void clear_command_time(size_t mboard = 0);
+
   void set_biastee_mode(const std::string &mode);
 
   void set_loopback_mode(const std::string &loopback);
   void set_rx_mux_mode(const std::string &rxmux);
   void set_agc_mode(const std::string &agcmode);
 
+  stream_tagger *get_stream_tagger(void);
+  signal_monitor *get_signal_monitor(void);
+  bool set_freq_shift(double freq, size_t chan = 0);
+  bool set_stream_type(stream_type_t type);
+
 private:
   // Sample-handling buffers
   int16_t *_16icbuf;              /**< raw samples from bladeRF */
   gr_complex *_32fcbuf;           /**< intermediate buffer to gnuradio */
 
   bool _running;                  /**< is the source running? */
+  stream_type_t _stream_type;     /**< fc32 or sc16 */
   bladerf_channel_layout _layout; /**< channel layout */
   bladerf_gain_mode _agcmode;     /**< gain mode when AGC is enabled */
 
   gr::thread::mutex d_mutex;      /**< mutex to protect set/work access */
 
+  stream_tagger _tagger;          /**< drops samples taken while retuning */
+  signal_monitor _monitor;        /**< statistics of the raw samples */
+  std::vector<std::unique_ptr<nco> > _ncos; /**< shift of each channel */
+
   /* Scaling factor used when converting from int16_t to float */
   const float SCALING_FACTOR = 2048.0f;
+
+  /* Time the RFIC needs to settle after a retune */
+  const double SETTLE_TIME = 1e-3;
 };
 
 #endif // INCLUDED_BLADERF_SOURCE_C_H
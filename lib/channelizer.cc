@@ -0,0 +1,195 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <gnuradio/io_signature.h>
+#include <gnuradio/fft/window.h>
+
+#include <volk/volk.h>
+
+#include <algorithm>
+#include <cmath>
+#include <future>
+#include <stdexcept>
+
+#include "channelizer.h"
+
+#define TAPS_PER_BRANCH 16
+#define MIN_BLOCKS_PER_THREAD 64 /* not worth a thread below */
+
+channelizer_sptr make_channelizer( size_t nchan, size_t nthreads )
+{
+  return gnuradio::get_initial_sptr( new channelizer( nchan, nthreads ) );
+}
+
+channelizer::worker_t::worker_t( size_t nchan )
+  : fft( nchan, false ),
+    branches( nchan )
+{
+}
+
+channelizer::channelizer( size_t nchan, size_t nthreads )
+  : gr::sync_decimator( "channelizer",
+                        gr::io_signature::make(1, 1, sizeof(gr_complex)),
+                        gr::io_signature::make(nchan, nchan, sizeof(gr_complex)),
+                        std::max( nchan, size_t(1) ) ),
+    _nchan( nchan ),
+    _rate( 0 ),
+    _bandwidth( 0 )
+{
+  if ( nchan < 2 )
+    throw std::runtime_error( "channelizer: at least 2 channels are needed." );
+
+  set_history( nchan * (TAPS_PER_BRANCH - 1) + 1 );
+
+  nthreads = std::max( nthreads, size_t(1) );
+
+  for (size_t i = 0; i < nthreads; i++)
+    _workers.push_back( std::unique_ptr< worker_t >( new worker_t( nchan ) ) );
+
+  for (size_t i = 1; i < nthreads; i++)
+    _threads.push_back( std::unique_ptr< control_thread >( new control_thread() ) );
+
+  design();
+}
+
+void channelizer::set_rate( double rate )
+{
+  std::lock_guard< std::mutex > lock( _mutex );
+
+  _rate = rate;
+  design();
+}
+
+void channelizer::set_bandwidth( double bandwidth )
+{
+  std::lock_guard< std::mutex > lock( _mutex );
+
+  _bandwidth = bandwidth;
+  design();
+}
+
+double channelizer::bandwidth()
+{
+  std::lock_guard< std::mutex > lock( _mutex );
+
+  if ( _rate > 0 && _bandwidth > 0 )
+    return std::min( _bandwidth, _rate );
+
+  return _rate / _nchan;
+}
+
+double channelizer::offset( size_t k )
+{
+  const long bin = k <= _nchan / 2 ? long(k) : long(k) - long(_nchan);
+  return double(bin) / _nchan;
+}
+
+/*
+ * Windowed sinc prototype of nchan * TAPS_PER_BRANCH taps with unity gain,
+ * dealt out to the branches so that each one is a contiguous dot product.
+ */
+void channelizer::design()
+{
+  const size_t length = _nchan * TAPS_PER_BRANCH;
+  const double center = (length - 1) / 2.0;
+
+  double width = 1.0 / _nchan; /* of the input rate, both sides */
+  if ( _rate > 0 && _bandwidth > 0 )
+    width = std::min( _bandwidth / _rate, 1.0 );
+
+  const std::vector< float > window = gr::fft::window::blackmanharris( length );
+  std::vector< double > proto( length );
+  double sum = 0;
+
+  for (size_t n = 0; n < length; n++) {
+    const double x = width * (n - center);
+    proto[n] = width * (x == 0 ? 1.0 : std::sin( M_PI * x ) / ( M_PI * x )) * window[n];
+    sum += proto[n];
+  }
+
+  _taps.assign( _nchan, std::vector< float >( TAPS_PER_BRANCH ) );
+
+  for (size_t p = 0; p < _nchan; p++)
+    for (size_t i = 0; i < TAPS_PER_BRANCH; i++)
+      _taps[p][i] = float( proto[p + (TAPS_PER_BRANCH - 1 - i) * _nchan] / sum );
+}
+
+void channelizer::run( worker_t &worker, const gr_complex *in,
+                       gr_vector_void_star &output_items, size_t first, size_t count )
+{
+  const size_t length = count + TAPS_PER_BRANCH - 1;
+
+  for (size_t p = 0; p < _nchan; p++)
+    if ( worker.branches[p].size() < length )
+      worker.branches[p].resize( length );
+
+  /* branch p takes the inputs nchan - 1 - p past each block boundary */
+  const gr_complex *block = in + first * _nchan;
+  for (size_t j = 0; j < length; j++, block += _nchan)
+    for (size_t p = 0; p < _nchan; p++)
+      worker.branches[p][j] = block[_nchan - 1 - p];
+
+  gr_complex *fft_in = worker.fft.get_inbuf();
+  const gr_complex *fft_out = worker.fft.get_outbuf();
+
+  for (size_t m = 0; m < count; m++) {
+    for (size_t p = 0; p < _nchan; p++)
+      volk_32fc_32f_dot_prod_32fc( &fft_in[p], &worker.branches[p][m],
+                                   &_taps[p][0], TAPS_PER_BRANCH );
+
+    worker.fft.execute();
+
+    for (size_t k = 0; k < _nchan; k++)
+      static_cast< gr_complex * >( output_items[k] )[first + m] = fft_out[k];
+  }
+}
+
+int channelizer::work( int noutput_items,
+                       gr_vector_const_void_star &input_items,
+                       gr_vector_void_star &output_items )
+{
+  const gr_complex *in = static_cast< const gr_complex * >( input_items[0] );
+  const size_t nblocks = noutput_items;
+
+  std::lock_guard< std::mutex > lock( _mutex );
+
+  const size_t nthreads =
+      std::min( _workers.size(), std::max( nblocks / MIN_BLOCKS_PER_THREAD, size_t(1) ) );
+  const size_t per_thread = (nblocks + nthreads - 1) / nthreads;
+
+  std::vector< std::future< void > > pending;
+
+  for (size_t t = 1; t < nthreads && t * per_thread < nblocks; t++) {
+    worker_t *worker = _workers[t].get();
+    const size_t first = t * per_thread;
+    const size_t count = std::min( per_thread, nblocks - first );
+
+    pending.push_back( _threads[t - 1]->submit( [this, worker, in, &output_items, first, count]() {
+      run( *worker, in, output_items, first, count );
+    } ) );
+  }
+
+  run( *_workers[0], in, output_items, 0, std::min( per_thread, nblocks ) );
+
+  for (std::future< void > &done : pending)
+    done.get();
+
+  return noutput_items;
+}
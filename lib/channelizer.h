@@ -0,0 +1,94 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef INCLUDED_OSMOSDR_CHANNELIZER_H
+#define INCLUDED_OSMOSDR_CHANNELIZER_H
+
+#include <gnuradio/sync_decimator.h>
+#include <gnuradio/fft/fft.h>
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "control_thread.h"
+
+class channelizer;
+
+typedef boost::shared_ptr<channelizer> channelizer_sptr;
+
+channelizer_sptr make_channelizer( size_t nchan, size_t nthreads = 1 );
+
+/*!
+ * \brief Critically sampled polyphase filter bank splitting a wideband
+ * stream into nchan equally spaced channels at 1/nchan of its rate.
+ *
+ * Output k is centered k/nchan of the sample rate above the input center,
+ * the upper half of the outputs wraps around to the negative frequencies.
+ * Each block of nchan inputs runs through the nchan branch filters and an
+ * inverse FFT. Large calls are split into ranges of blocks handed to
+ * nthreads - 1 worker threads, the calling thread takes the first range.
+ */
+class channelizer : public gr::sync_decimator
+{
+private:
+  friend channelizer_sptr make_channelizer( size_t nchan, size_t nthreads );
+
+  channelizer( size_t nchan, size_t nthreads );
+
+public:
+  /* the input rate and the filter bandwidth in Hz, 0 for the channel spacing */
+  void set_rate( double rate );
+  void set_bandwidth( double bandwidth );
+  double bandwidth( void );
+
+  /* center of output k as a fraction of the input rate */
+  double offset( size_t k );
+
+  int work( int noutput_items,
+            gr_vector_const_void_star &input_items,
+            gr_vector_void_star &output_items );
+
+private:
+  /* state of a single thread, the FFT buffers can't be shared */
+  struct worker_t
+  {
+    worker_t( size_t nchan );
+
+    gr::fft::fft_complex fft;
+    std::vector< std::vector< gr_complex > > branches; /* deinterleaved input */
+  };
+
+  void design( void );
+  void run( worker_t &worker, const gr_complex *in,
+            gr_vector_void_star &output_items, size_t first, size_t count );
+
+  std::mutex _mutex;
+
+  size_t _nchan;
+  double _rate;
+  double _bandwidth;
+
+  std::vector< std::vector< float > > _taps; /* by branch, reversed */
+
+  std::vector< std::unique_ptr< worker_t > > _workers;
+  std::vector< std::unique_ptr< control_thread > > _threads;
+};
+
+#endif /* INCLUDED_OSMOSDR_CHANNELIZER_H */
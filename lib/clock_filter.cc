@@ -0,0 +1,97 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include "clock_filter.h"
+
+#define LOCK_BANDWIDTH 1.0 /* Hz, loop bandwidth while locking */
+#define TRACK_BANDWIDTH 0.05 /* Hz, once locked */
+#define LOCK_UPDATES 64 /* updates until the loop is narrowed */
+#define MAX_ERROR 0.05 /* seconds off the estimate to anchor again */
+#define MAX_DRIFT 1e-3 /* largest deviation from the nominal rate */
+
+clock_filter::clock_filter()
+  : _nominal(0),
+    _locked(false),
+    _updates(0),
+    _index(0),
+    _time(0),
+    _period(0)
+{
+}
+
+void clock_filter::reset( double nominal_rate )
+{
+  _nominal = nominal_rate;
+  _locked = false;
+  _updates = 0;
+}
+
+void clock_filter::update( uint64_t index, double arrival )
+{
+  if ( _nominal <= 0 )
+    return;
+
+  if ( ! _locked || index <= _index ) {
+    _locked = true;
+    _index = index;
+    _time = arrival;
+    _period = 1.0 / _nominal;
+    return;
+  }
+
+  const double samples = double( index - _index );
+  const double predicted = _time + samples * _period;
+  const double error = arrival - predicted;
+
+  _index = index;
+
+  if ( std::abs( error ) > MAX_ERROR ) {
+    _time = arrival;
+    return;
+  }
+
+  const double bandwidth = _updates++ < LOCK_UPDATES ? LOCK_BANDWIDTH
+                                                     : TRACK_BANDWIDTH;
+  const double omega = std::min( 2 * M_PI * bandwidth * samples * _period, 1.0 );
+
+  _time = predicted + std::sqrt( 2.0 ) * omega * error;
+  _period += omega * omega * error / samples;
+
+  /* arrival jitter must not pull the rate anywhere unreasonable */
+  _period = std::max( _period, ( 1.0 - MAX_DRIFT ) / _nominal );
+  _period = std::min( _period, ( 1.0 + MAX_DRIFT ) / _nominal );
+}
+
+bool clock_filter::time_at( uint64_t index, double &time ) const
+{
+  if ( ! _locked )
+    return false;
+
+  time = _time + ( double( index ) - double( _index ) ) * _period;
+  return true;
+}
+
+double clock_filter::rate() const
+{
+  return _locked ? 1.0 / _period : _nominal;
+}
@@ -0,0 +1,59 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef OSMOSDR_CLOCK_FILTER_H
+#define OSMOSDR_CLOCK_FILTER_H
+
+#include <stdint.h>
+
+/*
+ * Relates sample indexes to host time. Each update() gives the index
+ * following the last sample of a buffer and the host time the buffer
+ * arrived. A second order delay locked loop follows the noisy arrival
+ * times, so it estimates both the real sample rate of the device and
+ * the host time of any sample. The loop starts wide for a fast lock and
+ * narrows once settled. An arrival far off the estimate (a stall or
+ * lost data) anchors the loop again.
+ */
+class clock_filter
+{
+public:
+  clock_filter();
+
+  /* forget the estimate, e.g. after the sample rate was changed */
+  void reset( double nominal_rate );
+
+  void update( uint64_t index, double arrival );
+
+  /* false until the first update */
+  bool time_at( uint64_t index, double &time ) const;
+  double rate( void ) const;
+
+private:
+  double _nominal;
+  bool _locked;
+  uint64_t _updates;
+
+  uint64_t _index; /* last update */
+  double _time; /* filtered host time of _index */
+  double _period; /* seconds per sample */
+};
+
+#endif // OSMOSDR_CLOCK_FILTER_H
@@ -0,0 +1,121 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+
+#include <gnuradio/io_signature.h>
+
+#include <boost/bind.hpp>
+
+#include "command_port.h"
+
+command_t::command_t()
+  : freq(NAN),
+    gain(NAN),
+    rate(NAN),
+    bandwidth(NAN),
+    chan(-1)
+{
+}
+
+static double to_number( const pmt::pmt_t &key, const pmt::pmt_t &val )
+{
+  if ( ! pmt::is_number( val ) )
+    throw std::runtime_error( "command '" + pmt::symbol_to_string( key ) +
+                              "' expects a number" );
+
+  return pmt::to_double( val );
+}
+
+static void parse_item( const pmt::pmt_t &key, const pmt::pmt_t &val,
+                        command_t &cmd )
+{
+  if ( ! pmt::is_symbol( key ) )
+    throw std::runtime_error( "command keys must be symbols" );
+
+  std::string name = pmt::symbol_to_string( key );
+
+  if ( "freq" == name ) {
+    cmd.freq = to_number( key, val );
+  } else if ( "gain" == name ) {
+    cmd.gain = to_number( key, val );
+  } else if ( "rate" == name ) {
+    cmd.rate = to_number( key, val );
+  } else if ( "bandwidth" == name ) {
+    cmd.bandwidth = to_number( key, val );
+  } else if ( "antenna" == name ) {
+    if ( ! pmt::is_symbol( val ) )
+      throw std::runtime_error( "command 'antenna' expects a string" );
+    cmd.antenna = pmt::symbol_to_string( val );
+  } else if ( "chan" == name ) {
+    if ( ! pmt::is_integer( val ) )
+      throw std::runtime_error( "command 'chan' expects an integer" );
+    cmd.chan = pmt::to_long( val );
+  } else {
+    std::cerr << "Ignoring unknown command '" << name << "'" << std::endl;
+  }
+}
+
+command_t parse_command( pmt::pmt_t msg )
+{
+  command_t cmd;
+
+  /* a dict is a list of pairs to pmt, so tell a lone pair by its key */
+  if ( pmt::is_pair( msg ) && ! pmt::is_pair( pmt::car( msg ) ) ) {
+    parse_item( pmt::car( msg ), pmt::cdr( msg ), cmd );
+  } else if ( pmt::is_dict( msg ) ) {
+    pmt::pmt_t items = pmt::dict_items( msg );
+    for (size_t i = 0; i < pmt::length( items ); i++) {
+      pmt::pmt_t item = pmt::nth( i, items );
+      parse_item( pmt::car( item ), pmt::cdr( item ), cmd );
+    }
+  } else {
+    throw std::runtime_error( "commands must be a dict or a (key . value) pair" );
+  }
+
+  return cmd;
+}
+
+command_port_sptr make_command_port( const command_handler_t &handler )
+{
+  return gnuradio::get_initial_sptr( new command_port( handler ) );
+}
+
+command_port::command_port( const command_handler_t &handler )
+  : gr::block( "command_port",
+               gr::io_signature::make(0, 0, 0),
+               gr::io_signature::make(0, 0, 0) ),
+    _handler( handler )
+{
+  message_port_register_in( pmt::mp("command") );
+  set_msg_handler( pmt::mp("command"),
+                   boost::bind( &command_port::handle, this, _1 ) );
+}
+
+command_port::~command_port()
+{
+}
+
+void command_port::handle( pmt::pmt_t msg )
+{
+  _handler( msg );
+}
@@ -0,0 +1,82 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef INCLUDED_OSMOSDR_COMMAND_PORT_H
+#define INCLUDED_OSMOSDR_COMMAND_PORT_H
+
+#include <gnuradio/block.h>
+
+#include <boost/function.hpp>
+
+#include <string>
+
+/*
+ * A control request received on the "command" message port, in the dict
+ * format of gr-uhd: freq, gain, rate, bandwidth, antenna and chan. Numeric
+ * members left at NAN and an empty antenna are not touched, a negative
+ * chan applies the command to all channels.
+ */
+struct command_t
+{
+  command_t();
+
+  double freq;
+  double gain;
+  double rate;
+  double bandwidth;
+  std::string antenna;
+  long chan;
+};
+
+/*
+ * Decode a command message: either a dict or a single (key . value) pair.
+ * Unknown keys are reported and skipped, a malformed message throws.
+ */
+command_t parse_command( pmt::pmt_t msg );
+
+class command_port;
+
+typedef boost::shared_ptr<command_port> command_port_sptr;
+
+typedef boost::function< void ( pmt::pmt_t ) > command_handler_t;
+
+command_port_sptr make_command_port( const command_handler_t &handler );
+
+/*!
+ * \brief Message only block forwarding everything received on its
+ * "command" port to a handler. source_impl and sink_impl connect their
+ * hierarchical "command" port to it.
+ */
+class command_port : public gr::block
+{
+private:
+  friend command_port_sptr make_command_port( const command_handler_t &handler );
+
+  command_port( const command_handler_t &handler );
+
+public:
+  ~command_port();
+
+private:
+  void handle( pmt::pmt_t msg );
+
+  command_handler_t _handler;
+};
+
+#endif /* INCLUDED_OSMOSDR_COMMAND_PORT_H */
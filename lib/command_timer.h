@@ -0,0 +1,110 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef OSMOSDR_COMMAND_TIMER_H
+#define OSMOSDR_COMMAND_TIMER_H
+
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <osmosdr/time_spec.h>
+
+/*
+ * Emulates timed commands for the devices of a block lacking them: while a
+ * command time is set for a device, its control calls wait until the time
+ * of the device has come. Most of the wait is slept, the last bit is spun
+ * on the clock of the device to land close to the time. Devices timing
+ * their retunes but nothing else only have the other calls wait.
+ */
+class command_timer
+{
+public:
+  typedef std::function< osmosdr::time_spec_t ( void ) > clock_t;
+
+  command_timer( size_t devices = 0 ) :
+    _timed( devices, 0 ),
+    _retunes_timed( devices, 0 ),
+    _time( devices )
+  {}
+
+  command_timer( const command_timer & ) = delete;
+  command_timer &operator=( const command_timer & ) = delete;
+
+  void resize( size_t devices )
+  {
+    std::lock_guard< std::mutex > lock( _mutex );
+    _timed.resize( devices, 0 );
+    _retunes_timed.resize( devices, 0 );
+    _time.resize( devices );
+  }
+
+  void set( size_t dev, const osmosdr::time_spec_t &time, bool retunes_timed = false )
+  {
+    std::lock_guard< std::mutex > lock( _mutex );
+    _timed.at( dev ) = 1;
+    _retunes_timed.at( dev ) = retunes_timed;
+    _time.at( dev ) = time;
+  }
+
+  void clear( size_t dev )
+  {
+    std::lock_guard< std::mutex > lock( _mutex );
+    _timed.at( dev ) = 0;
+  }
+
+  /* returns once now() of the device reached its command time, if any */
+  void wait( size_t dev, const clock_t &now, bool retune = false )
+  {
+    const double spin = 1e-3; /* seconds spun before the time */
+    osmosdr::time_spec_t time;
+
+    {
+      std::lock_guard< std::mutex > lock( _mutex );
+
+      if ( dev >= _timed.size() || ! _timed[ dev ] )
+        return;
+
+      if ( retune && _retunes_timed[ dev ] )
+        return;
+
+      time = _time[ dev ];
+    }
+
+    while ( true ) {
+      const double left = ( time - now() ).get_real_secs();
+      if ( left <= 0 )
+        break;
+
+      if ( left > spin )
+        std::this_thread::sleep_for( std::chrono::duration< double >( left - spin ) );
+    }
+  }
+
+private:
+  std::mutex _mutex;
+  std::vector< char > _timed;
+  std::vector< char > _retunes_timed;
+  std::vector< osmosdr::time_spec_t > _time;
+};
+
+#endif // OSMOSDR_COMMAND_TIMER_H
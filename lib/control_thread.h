@@ -0,0 +1,113 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef OSMOSDR_CONTROL_THREAD_H
+#define OSMOSDR_CONTROL_THREAD_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+/*
+ * A single worker thread applying control requests in submission order,
+ * so callers never block on the control transfers of a device. Requests
+ * still queued when the thread is destroyed are dropped, their futures
+ * report a broken promise.
+ */
+class control_thread
+{
+public:
+  control_thread() : _stop(false)
+  {
+    _thread = std::thread( &control_thread::run, this );
+  }
+
+  ~control_thread()
+  {
+    {
+      std::lock_guard< std::mutex > lock( _mutex );
+      _stop = true;
+    }
+    _cond.notify_one();
+    _thread.join();
+  }
+
+  control_thread( const control_thread & ) = delete;
+  control_thread &operator=( const control_thread & ) = delete;
+
+  /* queue func, its result or exception is delivered through the future */
+  template< typename F >
+  std::future< typename std::result_of< F() >::type > submit( F func )
+  {
+    typedef typename std::result_of< F() >::type result_t;
+
+    std::shared_ptr< std::packaged_task< result_t () > > task =
+        std::make_shared< std::packaged_task< result_t () > >( func );
+
+    std::future< result_t > result = task->get_future();
+    post( [task]() { (*task)(); } );
+
+    return result;
+  }
+
+  /* queue func without waiting for its result */
+  void post( const std::function< void ( void ) > &func )
+  {
+    {
+      std::lock_guard< std::mutex > lock( _mutex );
+      _queue.push_back( func );
+    }
+    _cond.notify_one();
+  }
+
+private:
+  void run()
+  {
+    std::unique_lock< std::mutex > lock( _mutex );
+
+    while ( true ) {
+      _cond.wait( lock, [this]() { return _stop || !_queue.empty(); } );
+
+      if ( _stop )
+        break;
+
+      std::function< void ( void ) > func = _queue.front();
+      _queue.pop_front();
+
+      lock.unlock();
+      func();
+      lock.lock();
+    }
+
+    _queue.clear();
+  }
+
+  std::mutex _mutex;
+  std::condition_variable _cond;
+  std::deque< std::function< void ( void ) > > _queue;
+  bool _stop;
+  std::thread _thread;
+};
+
+#endif // OSMOSDR_CONTROL_THREAD_H
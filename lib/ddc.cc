@@ -0,0 +1,343 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include "ddc.h"
+
+#define NCO_BITS 10 /* phase bits of the sine table */
+#define CIC_MAX_RATE 8 /* keeps the order 4 integrators within 32 bits */
+#define HB_TAPS 31
+#define RS_PHASES 32
+#define RS_TAPS 16 /* per phase */
+#define SKIP_CHUNK 4096
+
+static double sinc( double x )
+{
+  return x == 0 ? 1.0 : std::sin( M_PI * x ) / ( M_PI * x );
+}
+
+static uint64_t gcd( uint64_t a, uint64_t b )
+{
+  while ( b ) {
+    uint64_t t = a % b;
+    a = b;
+    b = t;
+  }
+  return a;
+}
+
+ddc::ddc()
+  : _input_rate(0),
+    _output_rate(0),
+    _shift(0),
+    _phase(0),
+    _phase_inc(0),
+    _cic_rate(1),
+    _cic_count(0),
+    _cic_scale(1),
+    _l(1),
+    _m(1),
+    _frac(0),
+    _wait(0),
+    _rs_pos(0)
+{
+  const size_t size = 1 << NCO_BITS;
+
+  for (size_t i = 0; i < size; i++) {
+    _cos.push_back( int16_t( std::lround( 16384 * std::cos( 2 * M_PI * i / size ) ) ) );
+    _sin.push_back( int16_t( std::lround( 16384 * std::sin( 2 * M_PI * i / size ) ) ) );
+  }
+
+  /* zeros at every even offset from the center but the center itself */
+  const double center = (HB_TAPS - 1) / 2.0;
+  double sum = 0;
+
+  for (size_t n = 0; n < HB_TAPS; n++) {
+    const double window = 0.42 - 0.5 * std::cos( 2 * M_PI * n / (HB_TAPS - 1) )
+                               + 0.08 * std::cos( 4 * M_PI * n / (HB_TAPS - 1) );
+    _hb_taps.push_back( float( 0.5 * sinc( 0.5 * (n - center) ) * window ) );
+    sum += _hb_taps.back();
+  }
+
+  for (size_t n = 0; n < HB_TAPS; n++)
+    _hb_taps[n] /= sum;
+
+  _zeros.resize( 2 * SKIP_CHUNK, 0 );
+
+  reset();
+}
+
+double ddc::set_rates( double input_rate, double output_rate )
+{
+  std::lock_guard< std::mutex > lock( _mutex );
+
+  if ( ! (output_rate >= 1) || output_rate > input_rate )
+    output_rate = input_rate;
+
+  const double total = input_rate / output_rate;
+
+  /* at least one half-band cleaning up after the CIC when decimating */
+  size_t halfbands = 0;
+  if ( total >= 2 ) {
+    halfbands = 1;
+    while ( total / (1 << halfbands) > CIC_MAX_RATE )
+      halfbands++;
+  }
+
+  _cic_rate = std::max( 1u, (unsigned int)( total / (1 << halfbands) + 1e-9 ) );
+  _cic_scale = 1.0f / std::pow( float(_cic_rate), 4 );
+  _hbs.resize( halfbands );
+
+  /* what is left over is a ratio between 1 and 2, exact in Hz */
+  const uint64_t decim = uint64_t(_cic_rate) << halfbands;
+  _l = uint64_t( std::llround( output_rate ) ) * decim;
+  _m = std::max( uint64_t( std::llround( input_rate ) ), _l );
+
+  const uint64_t div = gcd( _l, _m );
+  _l /= div;
+  _m /= div;
+
+  _rs_taps.clear();
+
+  if ( _l != _m ) {
+    const size_t length = RS_TAPS * RS_PHASES;
+    const double center = (length - 1) / 2.0;
+    const double cutoff = 0.45 * double(_l) / double(_m); /* of the input rate */
+    std::vector< double > proto( length );
+    double sum = 0;
+
+    for (size_t n = 0; n < length; n++) {
+      const double window = 0.54 - 0.46 * std::cos( 2 * M_PI * n / (length - 1) );
+      proto[n] = 2 * cutoff * sinc( 2 * cutoff * (n - center) / RS_PHASES ) * window;
+      sum += proto[n];
+    }
+
+    _rs_taps.resize( length );
+    for (size_t p = 0; p < RS_PHASES; p++)
+      for (size_t t = 0; t < RS_TAPS; t++)
+        _rs_taps[p * RS_TAPS + t] = float( proto[t * RS_PHASES + p] * RS_PHASES / sum );
+  }
+
+  _input_rate = input_rate;
+  _output_rate = input_rate * double(_l) / double(_m * decim);
+  _phase_inc = uint32_t( int64_t( std::llround( _shift / _input_rate * 4294967296.0 ) ) );
+
+  reset();
+
+  return _output_rate;
+}
+
+double ddc::input_rate()
+{
+  std::lock_guard< std::mutex > lock( _mutex );
+  return _input_rate;
+}
+
+double ddc::output_rate()
+{
+  std::lock_guard< std::mutex > lock( _mutex );
+  return _output_rate;
+}
+
+void ddc::set_shift( double freq )
+{
+  std::lock_guard< std::mutex > lock( _mutex );
+
+  _shift = freq;
+
+  if ( _input_rate > 0 )
+    _phase_inc = uint32_t( int64_t( std::llround( _shift / _input_rate * 4294967296.0 ) ) );
+}
+
+double ddc::get_shift()
+{
+  std::lock_guard< std::mutex > lock( _mutex );
+  return _shift;
+}
+
+void ddc::reset()
+{
+  _cic_count = 0;
+  std::fill( &_integ[0][0], &_integ[0][0] + 8, 0 );
+  std::fill( &_comb[0][0], &_comb[0][0] + 8, 0 );
+
+  for (half_band &hb : _hbs) {
+    hb.hist.assign( 2 * HB_TAPS, gr_complex(0, 0) );
+    hb.pos = 0;
+    hb.odd = false;
+  }
+
+  _frac = 0;
+  _wait = 0;
+  _rs_hist.assign( 2 * RS_TAPS, gr_complex(0, 0) );
+  _rs_pos = 0;
+}
+
+size_t ddc::process( const uint8_t *in, size_t n, gr_complex *out )
+{
+  std::lock_guard< std::mutex > lock( _mutex );
+  /* 5 * (x - 127.4) keeps the center of the rtl in integers */
+  return run( in, n, -637, 5, 8, 640.0f, out );
+}
+
+size_t ddc::process( const int8_t *in, size_t n, gr_complex *out )
+{
+  std::lock_guard< std::mutex > lock( _mutex );
+  return run( in, n, 0, 1, 8, 128.0f, out );
+}
+
+size_t ddc::process( const int16_t *in, size_t n, gr_complex *out )
+{
+  std::lock_guard< std::mutex > lock( _mutex );
+  return run( in, n, 0, 1, 14, 32768.0f, out );
+}
+
+size_t ddc::skip( size_t n )
+{
+  std::lock_guard< std::mutex > lock( _mutex );
+
+  size_t nout = 0;
+
+  for (size_t done = 0; done < n; done += SKIP_CHUNK)
+    nout += run( &_zeros[0], std::min( n - done, size_t(SKIP_CHUNK) ),
+                 0, 1, 14, 32768.0f, NULL );
+
+  return nout;
+}
+
+/*
+ * The NCO products are shifted right by shift bits instead of 14, keeping
+ * about 17 bits of the narrow 8 bit samples for the CIC.
+ */
+template < typename T >
+size_t ddc::run( const T *in, size_t n, int bias, int mult, int shift,
+                 float full_scale, gr_complex *out )
+{
+  const int32_t gain = 1 << (14 - shift);
+  const float scale = _cic_scale / ( full_scale * gain );
+  size_t nout = 0;
+
+  for (size_t k = 0; k < n; k++) {
+    const int32_t vi = bias + mult * int32_t( in[2 * k] );
+    const int32_t vq = bias + mult * int32_t( in[2 * k + 1] );
+    int32_t mi, mq;
+
+    if ( _phase_inc ) { /* multiplied by exp(-j phase) */
+      const uint32_t idx = _phase >> (32 - NCO_BITS);
+      const int32_t c = _cos[idx], s = _sin[idx];
+      mi = (vi * c + vq * s) >> shift;
+      mq = (vq * c - vi * s) >> shift;
+      _phase += _phase_inc;
+    } else {
+      mi = vi * gain;
+      mq = vq * gain;
+    }
+
+    gr_complex sample;
+
+    if ( _cic_rate > 1 ) {
+      _integ[0][0] += uint32_t(mi);
+      _integ[0][1] += uint32_t(mq);
+      for (int s = 1; s < 4; s++) {
+        _integ[s][0] += _integ[s - 1][0];
+        _integ[s][1] += _integ[s - 1][1];
+      }
+
+      if ( ++_cic_count < _cic_rate )
+        continue;
+
+      _cic_count = 0;
+
+      uint32_t yi = _integ[3][0], yq = _integ[3][1];
+      for (int s = 0; s < 4; s++) {
+        const uint32_t ti = yi - _comb[s][0], tq = yq - _comb[s][1];
+        _comb[s][0] = yi;
+        _comb[s][1] = yq;
+        yi = ti;
+        yq = tq;
+      }
+
+      sample = gr_complex( float( int32_t(yi) ) * scale, float( int32_t(yq) ) * scale );
+    } else {
+      sample = gr_complex( float(mi) * scale, float(mq) * scale );
+    }
+
+    if ( ! emit( sample ) )
+      continue;
+
+    if ( out )
+      out[nout] = sample;
+    nout++;
+  }
+
+  return nout;
+}
+
+bool ddc::emit( gr_complex &sample )
+{
+  for (half_band &hb : _hbs) {
+    hb.pos = (hb.pos + HB_TAPS - 1) % HB_TAPS;
+    hb.hist[hb.pos] = hb.hist[hb.pos + HB_TAPS] = sample;
+
+    hb.odd = ! hb.odd;
+    if ( hb.odd )
+      return false;
+
+    const gr_complex *window = &hb.hist[hb.pos];
+    gr_complex acc(0, 0);
+    for (size_t t = 0; t < HB_TAPS; t++)
+      acc += window[t] * _hb_taps[t];
+
+    sample = acc;
+  }
+
+  return resample( sample );
+}
+
+bool ddc::resample( gr_complex &sample )
+{
+  if ( _l == _m )
+    return true;
+
+  _rs_pos = (_rs_pos + RS_TAPS - 1) % RS_TAPS;
+  _rs_hist[_rs_pos] = _rs_hist[_rs_pos + RS_TAPS] = sample;
+
+  if ( _wait ) {
+    _wait--;
+    return false;
+  }
+
+  /* between the newest input and the one before, by _frac / _l */
+  const float *taps = &_rs_taps[ (_frac * RS_PHASES / _l) * RS_TAPS ];
+  const gr_complex *window = &_rs_hist[_rs_pos];
+  gr_complex acc(0, 0);
+  for (size_t t = 0; t < RS_TAPS; t++)
+    acc += window[t] * taps[t];
+
+  sample = acc;
+
+  _frac += _m;
+  _wait = _frac / _l - 1;
+  _frac %= _l;
+
+  return true;
+}
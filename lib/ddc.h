@@ -0,0 +1,121 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef OSMOSDR_DDC_H
+#define OSMOSDR_DDC_H
+
+#include <mutex>
+#include <vector>
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <osmosdr/api.h>
+#include <gnuradio/gr_complex.h>
+
+#define DDC_MAX_DECIMATION 1024 /* lowest rate offered by the sources */
+
+/*
+ * Digital down converter of a source backend, enabled by the ddc=1 device
+ * argument. It takes the integer samples of the device in the pass copying
+ * them out of the transfer buffers and delivers a narrower stream:
+ *
+ *  - a numerically controlled oscillator shifting a frequency of the input
+ *    band to 0 Hz, on integers,
+ *  - an order 4 CIC decimator, on integers as well,
+ *  - a cascade of half-band decimators by 2,
+ *  - a polyphase resampler by a ratio between 1 and 2, reaching the
+ *    requested rate exactly (to the Hz) when it is not an integer fraction
+ *    of the input rate.
+ *
+ * Every input gives at most one output, the stages emit at fixed input
+ * counts, so the same inputs always give the same number of outputs.
+ */
+class OSMOSDR_API ddc
+{
+public:
+  ddc();
+
+  /* plans the stages, returns the output rate actually reached */
+  double set_rates( double input_rate, double output_rate );
+  double input_rate( void );
+  double output_rate( void );
+
+  /* the offset within the input band to bring to 0 Hz */
+  void set_shift( double freq );
+  double get_shift( void );
+
+  /* offset binary (rtl), signed 8 bit and signed 16 bit I/Q pairs */
+  size_t process( const uint8_t *in, size_t n, gr_complex *out );
+  size_t process( const int8_t *in, size_t n, gr_complex *out );
+  size_t process( const int16_t *in, size_t n, gr_complex *out );
+
+  /* runs zeros in place of n lost inputs, returns the outputs they gave */
+  size_t skip( size_t n );
+
+private:
+  struct half_band
+  {
+    std::vector< gr_complex > hist; /* twice the taps, contiguous windows */
+    size_t pos;
+    bool odd;
+  };
+
+  template < typename T >
+  size_t run( const T *in, size_t n, int bias, int mult, int shift,
+              float full_scale, gr_complex *out );
+
+  void reset( void );
+  bool emit( gr_complex &sample );
+  bool resample( gr_complex &sample );
+
+  std::mutex _mutex;
+
+  double _input_rate;
+  double _output_rate;
+  double _shift;
+
+  uint32_t _phase;
+  uint32_t _phase_inc;
+  std::vector< int16_t > _cos; /* Q14 */
+  std::vector< int16_t > _sin;
+
+  unsigned int _cic_rate;
+  unsigned int _cic_count;
+  float _cic_scale;
+  uint32_t _integ[4][2]; /* wrapping on purpose */
+  uint32_t _comb[4][2];
+
+  std::vector< float > _hb_taps;
+  std::vector< half_band > _hbs;
+
+  /* resampling by _m / _l, bypassed if they are equal */
+  uint64_t _l;
+  uint64_t _m;
+  uint64_t _frac; /* position of the next output beyond the newest input */
+  uint64_t _wait; /* inputs to take before the next output */
+  std::vector< float > _rs_taps; /* polyphase, by phase */
+  std::vector< gr_complex > _rs_hist;
+  size_t _rs_pos;
+
+  std::vector< int16_t > _zeros;
+};
+
+#endif // OSMOSDR_DDC_H
@@ -0,0 +1,127 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef OSMOSDR_DEFERRED_CONFIG_H
+#define OSMOSDR_DEFERRED_CONFIG_H
+
+#include <exception>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <utility>
+
+/*
+ * Records the settings of a device instead of applying them right away.
+ * Only the latest value of each setting is kept, commit() applies them in
+ * the order of their keys, so a backend numbers its settings in the order
+ * its hardware prefers. While recording, getters report the recorded
+ * values through pending(). Every commit of recorded settings bumps the
+ * generation, so that values read before can be told stale.
+ */
+class deferred_config
+{
+public:
+  typedef std::function< void ( double ) > apply_t;
+
+  deferred_config() : _recording(false), _generation(0) {}
+
+  deferred_config( const deferred_config & ) = delete;
+  deferred_config &operator=( const deferred_config & ) = delete;
+
+  void begin()
+  {
+    std::lock_guard< std::mutex > lock( _mutex );
+    _recording = true;
+  }
+
+  /* returns false if not recording, the caller applies value itself */
+  bool defer( int key, double value, const apply_t &apply )
+  {
+    std::lock_guard< std::mutex > lock( _mutex );
+
+    if ( ! _recording )
+      return false;
+
+    _settings[ key ] = std::make_pair( value, apply );
+    return true;
+  }
+
+  bool pending( int key, double &value )
+  {
+    std::lock_guard< std::mutex > lock( _mutex );
+
+    std::map< int, setting_t >::const_iterator it = _settings.find( key );
+    if ( it == _settings.end() )
+      return false;
+
+    value = it->second.first;
+    return true;
+  }
+
+  /* stop recording and apply what was recorded, a no-op if not recording */
+  void commit()
+  {
+    std::map< int, setting_t > settings;
+    {
+      std::lock_guard< std::mutex > lock( _mutex );
+      _recording = false;
+      settings.swap( _settings );
+    }
+
+    if ( settings.empty() )
+      return;
+
+    /* a failing setting does not keep the others from being applied */
+    std::exception_ptr error;
+
+    for (const auto &setting : settings) {
+      try {
+        setting.second.second( setting.second.first );
+      } catch ( ... ) {
+        if ( ! error )
+          error = std::current_exception();
+      }
+    }
+
+    {
+      std::lock_guard< std::mutex > lock( _mutex );
+      _generation++;
+    }
+
+    if ( error )
+      std::rethrow_exception( error );
+  }
+
+  unsigned int generation()
+  {
+    std::lock_guard< std::mutex > lock( _mutex );
+    return _generation;
+  }
+
+private:
+  typedef std::pair< double, apply_t > setting_t;
+
+  std::mutex _mutex;
+  bool _recording;
+  std::map< int, setting_t > _settings;
+  unsigned int _generation;
+};
+
+#endif // OSMOSDR_DEFERRED_CONFIG_H
@@ -23,78 +23,27 @@
 #include <boost/foreach.hpp>
 #include <boost/format.hpp>
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
 #include <mutex>
 #include <sstream>
+#include <thread>
 
 #ifdef HAVE_CONFIG_H
 #include "config.h"
 #endif
 
-#ifdef ENABLE_OSMOSDR
-#include <osmosdr_src_c.h>
-#endif
-
-#ifdef ENABLE_FCD
-#include <fcd_source_c.h>
-#endif
-
-#ifdef ENABLE_FILE
-#include <file_source_c.h>
-#endif
-
-#ifdef ENABLE_RTL
-#include <rtl_source_c.h>
-#endif
-
-#ifdef ENABLE_RTL_TCP
-#include <rtl_tcp_source_c.h>
-#endif
-
-#ifdef ENABLE_UHD
-#include <uhd_source_c.h>
-#endif
-
-#ifdef ENABLE_MIRI
-#include <miri_source_c.h>
-#endif
-
-#ifdef ENABLE_SDRPLAY
-#include <sdrplay_source_c.h>
-#endif
-
-#ifdef ENABLE_HACKRF
-#include <hackrf_source_c.h>
-#endif
-
-#ifdef ENABLE_BLADERF
-#include <bladerf_source_c.h>
-#endif
-
-#ifdef ENABLE_RFSPACE
-#include <rfspace_source_c.h>
-#endif
-
-#ifdef ENABLE_AIRSPY
-#include <airspy_source_c.h>
-#endif
-
-#ifdef ENABLE_AIRSPYHF
-#include <airspyhf_source_c.h>
-#endif
-
-#ifdef ENABLE_SOAPY
-#include <soapy_source_c.h>
-#endif
-
-#ifdef ENABLE_REDPITAYA
-#include <redpitaya_source_c.h>
-#endif
-
-#ifdef ENABLE_FREESRP
-#include <freesrp_source_c.h>
+#ifdef HAVE_LIBUSB_HOTPLUG
+#include <libusb.h>
 #endif
 
 #include "arg_helpers.h"
+#include "backend_registry.h"
 
 using namespace osmosdr;
 
@@ -102,7 +51,9 @@ static const std::string args_delim = " ";
 static const std::string pairs_delim = ",";
 static const std::string pair_delim = "=";
 
-static std::mutex _device_mutex;
+/* defaults for the "cache_ttl" and "timeout" hints, in seconds */
+#define DEFAULT_CACHE_TTL       5.0
+#define DEFAULT_PROBE_TIMEOUT   5.0
 
 device_t::device_t(const std::string &args)
 {
@@ -139,86 +90,262 @@ std::string device_t::to_string(void) const
   return ss.str();
 }
 
+struct probe_t
+{
+  std::string name;
+  get_devices_func_t func;
+};
+
+static std::vector< probe_t > get_probes( void )
+{
+  std::vector< probe_t > probes;
+
+  /* ordered by rank: hardware sources come first, software-only sources
+   * are appended at the very end, hopefully resulting in hardware sources
+   * to be shown first in a graphical interface etc... */
+  BOOST_FOREACH( const backend_t &backend, backend_registry::instance().source_backends() )
+    probes.push_back( { backend.name, backend.get_source_devices } );
+
+  return probes;
+}
+
+/*
+ * State of a single backend probe. It is shared with the probing thread,
+ * which keeps running detached if the caller stops waiting for it. A later
+ * scan picks up the pending probe instead of starting another one.
+ */
+struct probe_state_t
+{
+  probe_state_t() : done(false) {}
+
+  std::mutex mutex;
+  std::condition_variable cond;
+  bool done;
+  std::vector< std::string > devices;
+  std::string error;
+};
+
+typedef std::shared_ptr< probe_state_t > probe_state_sptr;
+
+/* incremented on every hotplug event, a cache entry is valid for one value */
+static std::atomic< unsigned int > _hotplug_generation( 0 );
+
+#ifdef HAVE_LIBUSB_HOTPLUG
+static int LIBUSB_CALL _hotplug_callback( libusb_context *ctx, libusb_device *dev,
+                                          libusb_hotplug_event event, void *user_data )
+{
+  _hotplug_generation++;
+
+  return 0; /* stay registered */
+}
+
+/*
+ * Watches the USB bus for the lifetime of the process so that attaching
+ * or removing a radio invalidates the discovery cache immediately. Without
+ * hotplug support in libusb the cache relies on its TTL alone.
+ */
+class hotplug_monitor
+{
+public:
+  hotplug_monitor()
+    : _ctx(NULL), _running(false)
+  {
+    if ( libusb_init( &_ctx ) < 0 ) {
+      _ctx = NULL;
+      return;
+    }
+
+    if ( ! libusb_has_capability( LIBUSB_CAP_HAS_HOTPLUG ) ||
+         libusb_hotplug_register_callback( _ctx,
+            (libusb_hotplug_event)(LIBUSB_HOTPLUG_EVENT_DEVICE_ARRIVED |
+                                   LIBUSB_HOTPLUG_EVENT_DEVICE_LEFT),
+            LIBUSB_HOTPLUG_NO_FLAGS,
+            LIBUSB_HOTPLUG_MATCH_ANY, LIBUSB_HOTPLUG_MATCH_ANY,
+            LIBUSB_HOTPLUG_MATCH_ANY,
+            _hotplug_callback, NULL, &_handle ) != LIBUSB_SUCCESS ) {
+      libusb_exit( _ctx );
+      _ctx = NULL;
+      return;
+    }
+
+    _running = true;
+    _thread = std::thread( &hotplug_monitor::run, this );
+  }
+
+  ~hotplug_monitor()
+  {
+    if ( ! _ctx )
+      return;
+
+    _running = false;
+    libusb_hotplug_deregister_callback( _ctx, _handle ); /* wakes up the event loop */
+    _thread.join();
+    libusb_exit( _ctx );
+  }
+
+private:
+  void run()
+  {
+    while ( _running ) {
+      struct timeval tv = { 1, 0 };
+      libusb_handle_events_timeout_completed( _ctx, &tv, NULL );
+    }
+  }
+
+  libusb_context *_ctx;
+  libusb_hotplug_callback_handle _handle;
+  std::atomic< bool > _running;
+  std::thread _thread;
+};
+#endif
+
+struct discovery_cache_t
+{
+  discovery_cache_t() : valid(false), generation(0) {}
+
+  bool valid;
+  unsigned int generation;
+  std::chrono::steady_clock::time_point stamp;
+  devices_t devices;
+};
+
+/* everything device::find() keeps from one call to the next */
+struct discovery_t
+{
+  std::mutex mutex;
+
+  /* probes still running, by backend name and fake flag */
+  std::map< std::pair< std::string, bool >, probe_state_sptr > pending;
+
+  /* one entry for each value of the fake flag */
+  std::map< bool, discovery_cache_t > cache;
+
+#ifdef HAVE_LIBUSB_HOTPLUG
+  hotplug_monitor monitor;
+#endif
+};
+
+typedef std::shared_ptr< discovery_t > discovery_sptr;
+
+static discovery_sptr get_discovery( void )
+{
+  static discovery_sptr discovery = std::make_shared< discovery_t >();
+
+  return discovery;
+}
+
+static probe_state_sptr launch_probe( const discovery_sptr &discovery,
+                                      const probe_t &probe, bool fake )
+{
+  std::pair< std::string, bool > key( probe.name, fake );
+
+  if ( discovery->pending.count( key ) ) {
+    probe_state_sptr state = discovery->pending[ key ];
+    std::lock_guard< std::mutex > lock( state->mutex );
+    if ( ! state->done )
+      return state;
+  }
+
+  probe_state_sptr state = std::make_shared< probe_state_t >();
+  get_devices_func_t func = probe.func;
+
+  /* the thread holds on to the discovery state, a probe still running at
+   * exit must not see the cache or the hotplug monitor destroyed */
+  std::thread( [discovery, state, func, fake]() {
+    std::vector< std::string > devices;
+    std::string error;
+
+    try {
+      devices = func( fake );
+    } catch ( std::exception &ex ) {
+      error = ex.what();
+    } catch ( ... ) {
+      error = "unknown error";
+    }
+
+    std::lock_guard< std::mutex > lock( state->mutex );
+    state->devices = devices;
+    state->error = error;
+    state->done = true;
+    state->cond.notify_all();
+  } ).detach();
+
+  discovery->pending[ key ] = state;
+
+  return state;
+}
+
 devices_t device::find(const device_t &hint)
 {
-  std::lock_guard<std::mutex> lock(_device_mutex);
+  discovery_sptr discovery = get_discovery();
+  std::lock_guard<std::mutex> lock(discovery->mutex);
 
   bool fake = true;
 
   if ( hint.count("nofake") )
     fake = false;
 
-  devices_t devices;
+  double cache_ttl = hint.cast< double >( "cache_ttl", DEFAULT_CACHE_TTL );
+  double timeout = hint.cast< double >( "timeout", DEFAULT_PROBE_TIMEOUT );
 
-#ifdef ENABLE_OSMOSDR
-  BOOST_FOREACH( std::string dev, osmosdr_src_c::get_devices() )
-    devices.push_back( device_t(dev) );
-#endif
-#ifdef ENABLE_FCD
-  BOOST_FOREACH( std::string dev, fcd_source_c::get_devices() )
-    devices.push_back( device_t(dev) );
-#endif
-#ifdef ENABLE_RTL
-  BOOST_FOREACH( std::string dev, rtl_source_c::get_devices() )
-    devices.push_back( device_t(dev) );
-#endif
-#ifdef ENABLE_UHD
-  BOOST_FOREACH( std::string dev, uhd_source_c::get_devices() )
-    devices.push_back( device_t(dev) );
-#endif
-#ifdef ENABLE_MIRI
-  BOOST_FOREACH( std::string dev, miri_source_c::get_devices() )
-    devices.push_back( device_t(dev) );
-#endif
-#ifdef ENABLE_SDRPLAY
-  BOOST_FOREACH( std::string dev, sdrplay_source_c::get_devices() )
-    devices.push_back( device_t(dev) );
-#endif
-#ifdef ENABLE_BLADERF
-  BOOST_FOREACH( std::string dev, bladerf_source_c::get_devices() )
-    devices.push_back( device_t(dev) );
-#endif
-#ifdef ENABLE_HACKRF
-  BOOST_FOREACH( std::string dev, hackrf_source_c::get_devices() )
-    devices.push_back( device_t(dev) );
-#endif
-#ifdef ENABLE_RFSPACE
-  BOOST_FOREACH( std::string dev, rfspace_source_c::get_devices( fake ) )
-    devices.push_back( device_t(dev) );
-#endif
-#ifdef ENABLE_AIRSPY
-  BOOST_FOREACH( std::string dev, airspy_source_c::get_devices() )
-    devices.push_back( device_t(dev) );
-#endif
-#ifdef ENABLE_AIRSPYHF
-  BOOST_FOREACH( std::string dev, airspyhf_source_c::get_devices() )
-    devices.push_back( device_t(dev) );
-#endif
-#ifdef ENABLE_FREESRP
-  BOOST_FOREACH( std::string dev, freesrp_source_c::get_devices() )
-    devices.push_back( device_t(dev) );
-#endif
-#ifdef ENABLE_SOAPY
-  BOOST_FOREACH( std::string dev, soapy_source_c::get_devices() )
-    devices.push_back( device_t(dev) );
-#endif
+  if ( hint.count("nocache") )
+    cache_ttl = 0;
 
-  /* software-only sources should be appended at the very end,
-   * hopefully resulting in hardware sources to be shown first
-   * in a graphical interface etc... */
+  std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+  discovery_cache_t &cache = discovery->cache[ fake ];
 
-#ifdef ENABLE_RTL_TCP
-  BOOST_FOREACH( std::string dev, rtl_tcp_source_c::get_devices( fake ) )
-    devices.push_back( device_t(dev) );
-#endif
-#ifdef ENABLE_REDPITAYA
-  BOOST_FOREACH( std::string dev, redpitaya_source_c::get_devices( fake ) )
-    devices.push_back( device_t(dev) );
-#endif
-#ifdef ENABLE_FILE
-  BOOST_FOREACH( std::string dev, file_source_c::get_devices( fake ) )
-    devices.push_back( device_t(dev) );
-#endif
+  if ( cache.valid && cache.generation == _hotplug_generation &&
+       now - cache.stamp < std::chrono::duration< double >( cache_ttl ) )
+    return cache.devices;
+
+  /* the generation is sampled before probing, so an event arriving during
+   * the scan leaves the new entry stale rather than hiding the change */
+  unsigned int generation = _hotplug_generation;
+
+  std::vector< probe_t > probes = get_probes();
+  std::vector< probe_state_sptr > states;
+
+  BOOST_FOREACH( probe_t &probe, probes )
+    states.push_back( launch_probe( discovery, probe, fake ) );
+
+  std::chrono::steady_clock::time_point deadline = now +
+      std::chrono::duration_cast< std::chrono::steady_clock::duration >(
+        std::chrono::duration< double >( timeout ) );
+
+  devices_t devices;
+  bool complete = true;
+
+  for (size_t i = 0; i < probes.size(); i++) {
+    probe_state_sptr state = states[i];
+    std::unique_lock< std::mutex > state_lock( state->mutex );
+
+    if ( ! state->cond.wait_until( state_lock, deadline, [state]() { return state->done; } ) ) {
+      std::cerr << "device discovery: " << probes[i].name
+                << " did not respond within " << timeout << " s, skipping"
+                << std::endl;
+      complete = false;
+      continue;
+    }
+
+    discovery->pending.erase( std::make_pair( probes[i].name, fake ) );
+
+    if ( state->error.length() ) {
+      std::cerr << "device discovery: " << probes[i].name
+                << " failed: " << state->error << std::endl;
+      continue;
+    }
+
+    BOOST_FOREACH( std::string dev, state->devices )
+      devices.push_back( device_t(dev) );
+  }
+
+  /* a partial result is not cached so the next query retries the slow backend */
+  if ( complete ) {
+    cache.valid = true;
+    cache.generation = generation;
+    cache.stamp = now;
+    cache.devices = devices;
+  }
 
   return devices;
 }
@@ -0,0 +1,233 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <gnuradio/io_signature.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "energy_gate.h"
+
+#define GATE_BLOCK 256 /* samples the power is averaged over */
+
+energy_gate_sptr make_energy_gate( double threshold, double hysteresis,
+                                   double pre_roll, double post_roll,
+                                   double min_duration )
+{
+  return gnuradio::get_initial_sptr(
+        new energy_gate( threshold, hysteresis, pre_roll, post_roll, min_duration ) );
+}
+
+energy_gate::energy_gate( double threshold, double hysteresis,
+                          double pre_roll, double post_roll, double min_duration )
+  : gr::block( "energy_gate",
+               gr::io_signature::make(1, 1, sizeof(gr_complex)),
+               gr::io_signature::make(1, 1, sizeof(gr_complex)) ),
+    _open_level( std::pow( 10.0, threshold / 10.0 ) ),
+    _close_level( std::pow( 10.0, (threshold - std::fabs( hysteresis )) / 10.0 ) ),
+    _pre_roll( pre_roll ),
+    _post_roll( post_roll ),
+    _min_duration( min_duration ),
+    _rate( 0 ),
+    _ring_head( 0 ),
+    _ring_fill( 0 ),
+    _power( 0 ),
+    _block_fill( 0 ),
+    _above( 0 ),
+    _hold( 0 ),
+    _open( false ),
+    _burst_len( 0 ),
+    _bursts( 0 ),
+    _timed( false ),
+    _time_secs( 0 ),
+    _time_frac( 0 ),
+    _time_offset( 0 )
+{
+  set_tag_propagation_policy( TPP_DONT );
+  set_rate( 0 );
+}
+
+void energy_gate::set_rate( double rate )
+{
+  std::lock_guard< std::mutex > lock( _mutex );
+
+  _rate = rate;
+  _post = uint64_t( _post_roll * rate );
+
+  /* whole blocks, the detection is made at their end */
+  _min = uint64_t( std::ceil( _min_duration * rate / GATE_BLOCK ) ) * GATE_BLOCK;
+  _min = std::max( _min, uint64_t(GATE_BLOCK) );
+
+  _ring.resize( uint64_t( _pre_roll * rate ) + _min );
+  _ring_head = 0;
+  _ring_fill = 0;
+  _above = 0;
+}
+
+uint64_t energy_gate::bursts()
+{
+  std::lock_guard< std::mutex > lock( _mutex );
+  return _bursts;
+}
+
+void energy_gate::push_ring( const gr_complex *in, size_t nitems )
+{
+  const size_t size = _ring.size();
+
+  if ( nitems >= size ) {
+    memcpy( &_ring[0], in + nitems - size, size * sizeof(gr_complex) );
+    _ring_head = 0;
+    _ring_fill = size;
+    return;
+  }
+
+  size_t n = std::min( nitems, size - _ring_head );
+  memcpy( &_ring[_ring_head], in, n * sizeof(gr_complex) );
+  memcpy( &_ring[0], in + n, (nitems - n) * sizeof(gr_complex) );
+
+  _ring_head = (_ring_head + nitems) % size;
+  _ring_fill = std::min( _ring_fill + nitems, size );
+}
+
+/* end is the input offset following the last sample in the ring */
+void energy_gate::open_burst( uint64_t end, uint64_t out_offset )
+{
+  const uint64_t start = end - _ring_fill;
+
+  _open = true;
+  _hold = _post;
+  _burst_len = _ring_fill;
+  _bursts++;
+
+  add_item_tag( 0, out_offset, pmt::mp("burst_start"), pmt::from_uint64( start ), alias_pmt() );
+
+  if ( _timed && _rate > 0 ) {
+    double frac = _time_frac + double( int64_t( start - _time_offset ) ) / _rate;
+    double secs = std::floor( frac );
+
+    pmt::pmt_t time = pmt::make_tuple( pmt::from_uint64( _time_secs + int64_t( secs ) ),
+                                       pmt::from_double( frac - secs ) );
+    add_item_tag( 0, out_offset, pmt::mp("rx_time"), time, alias_pmt() );
+  }
+}
+
+void energy_gate::close_burst( uint64_t out_offset )
+{
+  add_item_tag( 0, out_offset, pmt::mp("burst_end"), pmt::from_uint64( _burst_len ), alias_pmt() );
+
+  _open = false;
+  _above = 0;
+}
+
+int energy_gate::general_work( int noutput_items,
+                               gr_vector_int &ninput_items,
+                               gr_vector_const_void_star &input_items,
+                               gr_vector_void_star &output_items )
+{
+  const gr_complex *in = static_cast< const gr_complex * >( input_items[0] );
+  gr_complex *out = static_cast< gr_complex * >( output_items[0] );
+
+  const uint64_t available = ninput_items[0];
+  const uint64_t room = noutput_items;
+  const uint64_t in_base = nitems_read(0);
+  const uint64_t out_base = nitems_written(0);
+  uint64_t consumed = 0, produced = 0;
+
+  std::vector< gr::tag_t > tags;
+  get_tags_in_range( tags, 0, in_base, in_base + available );
+  std::sort( tags.begin(), tags.end(), gr::tag_t::offset_compare );
+  size_t t = 0;
+
+  std::lock_guard< std::mutex > lock( _mutex );
+
+  while ( true ) {
+    if ( _open && _ring_fill ) { /* the pre-roll goes first */
+      const size_t size = _ring.size();
+      size_t oldest = (_ring_head + size - _ring_fill) % size;
+      size_t n = std::min( std::min( uint64_t(_ring_fill), room - produced ),
+                           uint64_t(size - oldest) );
+      if ( ! n )
+        break;
+
+      memcpy( out + produced, &_ring[oldest], n * sizeof(gr_complex) );
+      produced += n;
+      _ring_fill -= n;
+      continue;
+    }
+
+    uint64_t n = std::min( available - consumed, uint64_t(GATE_BLOCK - _block_fill) );
+    if ( _open )
+      n = std::min( n, room - produced );
+    if ( ! n )
+      break;
+
+    const gr_complex *chunk = in + consumed;
+
+    for ( ; t < tags.size() && tags[t].offset < in_base + consumed + n; t++) {
+      if ( pmt::eqv( tags[t].key, pmt::mp("rx_time") ) ) {
+        _timed = true;
+        _time_secs = pmt::to_uint64( pmt::tuple_ref( tags[t].value, 0 ) );
+        _time_frac = pmt::to_double( pmt::tuple_ref( tags[t].value, 1 ) );
+        _time_offset = tags[t].offset;
+      }
+
+      if ( _open )
+        add_item_tag( 0, out_base + produced + (tags[t].offset - in_base - consumed),
+                      tags[t].key, tags[t].value, tags[t].srcid );
+    }
+
+    for (size_t i = 0; i < n; i++)
+      _power += std::norm( chunk[i] );
+
+    if ( _open ) {
+      memcpy( out + produced, chunk, n * sizeof(gr_complex) );
+      produced += n;
+      _burst_len += n;
+    } else {
+      push_ring( chunk, n );
+    }
+
+    consumed += n;
+    _block_fill += n;
+
+    if ( _block_fill < GATE_BLOCK )
+      continue;
+
+    const float power = _power / GATE_BLOCK;
+    _power = 0;
+    _block_fill = 0;
+
+    if ( ! _open ) {
+      _above = power >= _open_level ? _above + GATE_BLOCK : 0;
+      if ( _above >= _min )
+        open_burst( in_base + consumed, out_base + produced );
+    } else if ( power >= _close_level ) {
+      _hold = _post;
+    } else if ( _hold > GATE_BLOCK ) {
+      _hold -= GATE_BLOCK;
+    } else {
+      close_burst( out_base + produced - 1 );
+    }
+  }
+
+  consume_each( consumed );
+  return produced;
+}
@@ -0,0 +1,112 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef INCLUDED_OSMOSDR_ENERGY_GATE_H
+#define INCLUDED_OSMOSDR_ENERGY_GATE_H
+
+#include <gnuradio/block.h>
+
+#include <mutex>
+#include <vector>
+
+#include <stdint.h>
+
+class energy_gate;
+
+typedef boost::shared_ptr<energy_gate> energy_gate_sptr;
+
+/*
+ * threshold is the block power in dBFS opening the gate, which closes
+ * hysteresis dB below it. The durations are given in seconds.
+ */
+energy_gate_sptr make_energy_gate( double threshold, double hysteresis,
+                                   double pre_roll, double post_roll,
+                                   double min_duration );
+
+/*!
+ * \brief Passes on only the bursts of a stream, detected by the mean power
+ * of blocks of samples staying above the threshold for min_duration.
+ *
+ * A burst starts pre_roll before the detection and ends post_roll after
+ * the power fell below the closing level. Its first sample is tagged
+ * burst_start with its offset in the input stream and rx_time with its
+ * time if the input is timed, its last one burst_end with its length.
+ * Tags arriving while the gate is open are passed on, the others dropped.
+ */
+class energy_gate : public gr::block
+{
+private:
+  friend energy_gate_sptr make_energy_gate( double threshold, double hysteresis,
+                                            double pre_roll, double post_roll,
+                                            double min_duration );
+
+  energy_gate( double threshold, double hysteresis,
+               double pre_roll, double post_roll, double min_duration );
+
+public:
+  void set_rate( double rate );
+
+  /* number of bursts passed on */
+  uint64_t bursts( void );
+
+  int general_work( int noutput_items,
+                    gr_vector_int &ninput_items,
+                    gr_vector_const_void_star &input_items,
+                    gr_vector_void_star &output_items );
+
+private:
+  void push_ring( const gr_complex *in, size_t nitems );
+  void open_burst( uint64_t end, uint64_t out_offset );
+  void close_burst( uint64_t out_offset );
+
+  std::mutex _mutex;
+
+  float _open_level;
+  float _close_level;
+  double _pre_roll;
+  double _post_roll;
+  double _min_duration;
+  double _rate;
+
+  /* durations in samples, at the current rate */
+  uint64_t _post;
+  uint64_t _min;
+
+  /* the samples preceding the detection, passed on when the gate opens */
+  std::vector< gr_complex > _ring;
+  size_t _ring_head;
+  size_t _ring_fill;
+
+  float _power; /* summed over the current block */
+  size_t _block_fill;
+  uint64_t _above; /* samples the power has been above the threshold */
+  uint64_t _hold; /* left until the gate closes */
+
+  bool _open;
+  uint64_t _burst_len;
+  uint64_t _bursts;
+
+  /* the last rx_time tag, to time the bursts */
+  bool _timed;
+  uint64_t _time_secs;
+  double _time_frac;
+  uint64_t _time_offset;
+};
+
+#endif /* INCLUDED_OSMOSDR_ENERGY_GATE_H */
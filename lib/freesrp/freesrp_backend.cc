@@ -0,0 +1,51 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "backend_registry.h"
+
+#include "freesrp_source_c.h"
+#include "freesrp_sink_c.h"
+
+static backend_t freesrp_backend( void )
+{
+  backend_t backend( "freesrp", 120 );
+
+  backend.keys.push_back( "freesrp" );
+
+  backend.make_source = []( const std::string &args,
+                           gr::basic_block_sptr &block,
+                           source_iface *&iface ) {
+    freesrp_source_c_sptr src = make_freesrp_source_c( args );
+    block = src; iface = src.get();
+  };
+  backend.get_source_devices = []( bool ) { return freesrp_source_c::get_devices(); };
+
+  backend.make_sink = []( const std::string &args,
+                         gr::basic_block_sptr &block,
+                         sink_iface *&iface ) {
+    freesrp_sink_c_sptr sink = make_freesrp_sink_c( args );
+    block = sink; iface = sink.get();
+  };
+  backend.get_sink_devices = []( bool ) { return freesrp_sink_c::get_devices(); };
+
+  return backend;
+}
+
+static backend_registrar registrar( freesrp_backend() );
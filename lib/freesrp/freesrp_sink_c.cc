@@ -113,12 +113,19 @@ double freesrp_sink_c::set_sample_rate( double rate )
     }
     else
     {
-        return static_cast<double>(r.param);
+        _sample_rate = static_cast<double>(r.param);
+        _bandwidth = 0; // the firmware may adapt the filters to the new rate
+        return _sample_rate;
     }
 }
 
 double freesrp_sink_c::get_sample_rate( void )
 {
+    if(_sample_rate != 0)
+    {
+        return _sample_rate;
+    }
+
     response r = _srp->send_cmd({GET_TX_SAMP_FREQ, 0});
     if(r.error != CMD_OK)
     {
@@ -127,7 +134,8 @@ double freesrp_sink_c::get_sample_rate( void )
     }
     else
     {
-        return r.param;
+        _sample_rate = static_cast<double>(r.param);
+        return _sample_rate;
     }
 }
 
@@ -142,12 +150,18 @@ double freesrp_sink_c::set_center_freq( double freq, size_t chan )
     }
     else
     {
-        return static_cast<double>(r.param);
+        _center_freq = static_cast<double>(r.param);
+        return _center_freq;
     }
 }
 
 double freesrp_sink_c::get_center_freq( size_t chan )
 {
+    if(_center_freq != 0)
+    {
+        return _center_freq;
+    }
+
     response r = _srp->send_cmd({GET_TX_LO_FREQ, 0});
     if(r.error != CMD_OK)
     {
@@ -156,7 +170,8 @@ double freesrp_sink_c::get_center_freq( size_t chan )
     }
     else
     {
-        return static_cast<double>(r.param);
+        _center_freq = static_cast<double>(r.param);
+        return _center_freq;
     }
 }
 
@@ -261,12 +276,18 @@ double freesrp_sink_c::set_bandwidth(double bandwidth, size_t chan)
     }
     else
     {
-        return static_cast<double>(r.param);
+        _bandwidth = static_cast<double>(r.param);
+        return _bandwidth;
     }
 }
 
 double freesrp_sink_c::get_bandwidth(size_t chan)
 {
+    if(_bandwidth != 0)
+    {
+        return _bandwidth;
+    }
+
     response r = _srp->send_cmd({GET_TX_RF_BANDWIDTH, 0});
     if(r.error != CMD_OK)
     {
@@ -275,6 +296,7 @@ double freesrp_sink_c::get_bandwidth(size_t chan)
     }
     else
     {
-        return r.param;
+        _bandwidth = static_cast<double>(r.param);
+        return _bandwidth;
     }
 }
@@ -125,6 +125,12 @@ private:
     std::condition_variable _buf_cond{};
     size_t _buf_available_space = FREESRP_RX_TX_QUEUE_SIZE;
     moodycamel::ReaderWriterQueue<::FreeSRP::sample> _buf_queue{FREESRP_RX_TX_QUEUE_SIZE};
+
+    // Last values reported by the device, 0 while unknown. The getters
+    // return these instead of sending a command over USB on every call.
+    double _sample_rate = 0;
+    double _center_freq = 0;
+    double _bandwidth = 0;
 };
 
 #endif /* INCLUDED_FREESRP_SINK_C_H */
@@ -411,9 +411,10 @@ bool hackrf_common::get_bias()
 void hackrf_common::start()
 {
   _started = true;
+  /* the rate first, the automatic filter selection depends on it */
+  set_sample_rate(get_sample_rate());
   set_bandwidth(get_bandwidth());
   set_center_freq(get_center_freq());
-  set_sample_rate(get_sample_rate());
   set_gain(get_gain());
   set_bias(get_bias());
 }
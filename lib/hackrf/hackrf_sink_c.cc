@@ -135,6 +135,7 @@ hackrf_sink_c::hackrf_sink_c (const std::string &args)
         gr::io_signature::make(MIN_OUT, MAX_OUT, sizeof (gr_complex))),
     hackrf_common::hackrf_common(args),
     _buf(NULL),
+    _stream_type(STREAM_FC32),
     _vga_gain(0)
 {
   dict_t dict = params_to_dict(args);
@@ -148,6 +149,13 @@ hackrf_sink_c::hackrf_sink_c (const std::string &args)
     _buf_num = BUF_NUM;
 
   _stopping = false;
+  _started = false;
+  _prefill = 0;
+
+  _monitor.attach( this );
+
+  if (dict.count("prefill"))
+    _monitor.set_prefill( dict["prefill"] );
 
   if ( BUF_NUM != _buf_num ) {
     std::cerr << "Using " << _buf_num << " buffers of size " << BUF_LEN << "."
@@ -205,6 +213,7 @@ int hackrf_sink_c::hackrf_tx_callback(unsigned char *buffer, uint32_t length)
         return -1;
       } else {
         std::cerr << "U" << std::flush;
+        _monitor.underflow( length / 2 );
       }
     } else {
 //      std::cerr << "-" << std::flush;
@@ -221,8 +230,21 @@ bool hackrf_sink_c::start()
     return false;
 
   _stopping = false;
+  _started = false;
   _buf_used = 0;
+  _prefill = _monitor.prefill( get_sample_rate(), BUF_LEN / 2,
+                               uint64_t(_buf_num) * BUF_LEN / 2 );
   hackrf_common::start();
+
+  /* the transfers are started by work() once prefilled */
+  return true;
+}
+
+/* called with _buf_mutex held */
+bool hackrf_sink_c::start_tx()
+{
+  _started = true;
+
   int ret = hackrf_start_tx( _dev.get(), _hackrf_tx_callback, (void *)this );
   if ( ret != HACKRF_SUCCESS ) {
     std::cerr << "Failed to start TX streaming (" << ret << ")" << std::endl;
@@ -241,6 +263,10 @@ bool hackrf_sink_c::stop()
   {
     std::unique_lock<std::mutex> lock(_buf_mutex);
 
+    // A transmission shorter than the prefill still goes out.
+    if ( ! _started )
+      start_tx();
+
     while ( ! cb_has_room(&_cbuf) )
       _buf_cond.wait( lock );
 
@@ -357,15 +383,19 @@ int hackrf_sink_c::work( int noutput_items,
   unsigned int sse_rem = count/8; // 8 complex = 16f==512bit for avx
   unsigned int nosse_rem = count%8; // remainder
 
+  if (_stream_type == STREAM_SC8) { // the native format
+    memcpy(buf, input_items[0], count*2);
+  } else {
 #ifdef USE_AVX
-  convert_avx((float*)in, buf, sse_rem);
-  convert_default((float*)(in+sse_rem*8), buf+(sse_rem*8*2), nosse_rem*2);
+    convert_avx((float*)in, buf, sse_rem);
+    convert_default((float*)(in+sse_rem*8), buf+(sse_rem*8*2), nosse_rem*2);
 #elif USE_SSE2
-  convert_sse2((float*)in, buf, sse_rem);
-  convert_default((float*)(in+sse_rem*8), buf+(sse_rem*8*2), nosse_rem*2);
+    convert_sse2((float*)in, buf, sse_rem);
+    convert_default((float*)(in+sse_rem*8), buf+(sse_rem*8*2), nosse_rem*2);
 #else
-  convert_default((float*)in, buf, count*2);
+    convert_default((float*)in, buf, count*2);
 #endif
+  }
 
   _buf_used += (sse_rem*8+nosse_rem)*2;
   int items_consumed = sse_rem*8+nosse_rem;
@@ -381,6 +411,9 @@ int hackrf_sink_c::work( int noutput_items,
       } else {
 //        std::cerr << "+" << std::flush;
         _buf_used = 0;
+
+        if ( ! _started && uint64_t(_cbuf.count) * BUF_LEN / 2 >= _prefill )
+          start_tx();
       }
     }
   }
@@ -393,6 +426,17 @@ int hackrf_sink_c::work( int noutput_items,
   return 0;
 }
 
+bool hackrf_sink_c::set_stream_type( stream_type_t type )
+{
+  if ( type != STREAM_FC32 && type != STREAM_SC8 )
+    return false;
+
+  _stream_type = type;
+  set_input_signature( gr::io_signature::make(MIN_IN, MAX_IN, stream_item_size( type )) );
+
+  return true;
+}
+
 std::vector<std::string> hackrf_sink_c::get_devices()
 {
   return hackrf_common::get_devices();
@@ -30,6 +30,7 @@
 
 #include "sink_iface.h"
 #include "hackrf_common.h"
+#include "tx_monitor.h"
 
 class hackrf_sink_c;
 
@@ -123,15 +124,24 @@ public:
   double get_bandwidth( size_t chan = 0 );
   osmosdr::freq_range_t get_bandwidth_range( size_t chan = 0 );
 
+  tx_monitor *get_tx_monitor( void ) { return &_monitor; }
+  bool set_stream_type( stream_type_t type );
+
 private:
+  bool start_tx( void );
+
   static int _hackrf_tx_callback(hackrf_transfer* transfer);
   int hackrf_tx_callback(unsigned char *buffer, uint32_t length);
 
   circular_buffer_t _cbuf;
   int8_t *_buf;
+  stream_type_t _stream_type; /* fc32 or sc8 */
   unsigned int _buf_num;
   unsigned int _buf_used;
   bool _stopping;
+  bool _started; /* once prefilled */
+  uint64_t _prefill;
+  tx_monitor _monitor;
   std::mutex _buf_mutex;
   std::condition_variable _buf_cond;
 
@@ -30,6 +30,7 @@
 
 #include <stdexcept>
 #include <iostream>
+#include <cmath>
 
 #include <gnuradio/io_signature.h>
 
@@ -56,6 +57,20 @@ static const int MAX_IN = 0;	// maximum number of input streams
 static const int MIN_OUT = 1;	// minimum number of output streams
 static const int MAX_OUT = 1;	// maximum number of output streams
 
+#define SETTLE_TIME 1e-3 /* synthesizer lock after a change */
+#define DDC_RATE 8e6 /* device rate decimated from by default */
+
+/* deferred settings, in the order they are applied to the device */
+enum {
+  CFG_SAMPLE_RATE,
+  CFG_BANDWIDTH,
+  CFG_FREQ_CORR,
+  CFG_CENTER_FREQ,
+  CFG_GAIN,
+  CFG_IF_GAIN,
+  CFG_BB_GAIN
+};
+
 /*
  * The private constructor
  */
@@ -64,7 +79,12 @@ hackrf_source_c::hackrf_source_c (const std::string &args)
         gr::io_signature::make(MIN_IN, MAX_IN, sizeof (gr_complex)),
         gr::io_signature::make(MIN_OUT, MAX_OUT, sizeof (gr_complex))),
     hackrf_common::hackrf_common(args),
+    _stream_type(STREAM_FC32),
     _buf(NULL),
+    _ddc_enabled(false),
+    _ddc_rate(DDC_RATE),
+    _ddc_tune(0),
+    _freq_shift(0),
     _lna_gain(0),
     _vga_gain(0)
 {
@@ -75,6 +95,19 @@ hackrf_source_c::hackrf_source_c (const std::string &args)
   if (dict.count("buffers"))
     _buf_num = std::stoi(dict["buffers"]);
 
+  _overflow = stream_tagger::DROP_OLDEST;
+
+  if (dict.count("overflow"))
+    _overflow = stream_tagger::parse_overflow_policy( dict["overflow"] );
+
+  _zeros_pending = 0;
+
+  if (dict.count("ddc"))
+    _ddc_enabled = dict["ddc"] == "1";
+
+  if (dict.count("ddc_rate"))
+    _ddc_rate = std::stod( dict["ddc_rate"] );
+
 //  if (dict.count("buflen"))
 //    _buf_len = std::stoi(dict["buflen"]);
 
@@ -84,18 +117,32 @@ hackrf_source_c::hackrf_source_c (const std::string &args)
   if (0 == _buf_len || _buf_len % 512 != 0) /* len must be multiple of 512 */
     _buf_len = BUF_LEN;
 
-  _samp_avail = _buf_len / BYTES_PER_SAMPLE;
+  /* the transfer being filled holds the samples not yet received */
+  _tagger.set_latency( _buf_len / BYTES_PER_SAMPLE );
+  _tagger.set_settle_time( SETTLE_TIME );
+
+  if (dict.count("settle"))
+    _tagger.set_settle_time( std::stod( dict["settle"] ) );
 
   // create a lookup table for gr_complex values
   for (unsigned int i = 0; i <= 0xff; i++) {
     _lut.push_back( float(int8_t(i)) * (1.0f/128.0f) );
   }
 
+  /* the smaller magnitude of the two extreme codes */
+  _monitor.set_clip_level( 127.0f / 128.0f );
+
+  if (dict.count("stats"))
+    _monitor.set_interval( dict["stats"] );
+
+  _monitor.attach( this );
+
   if ( BUF_NUM != _buf_num || BUF_LEN != _buf_len ) {
     std::cerr << "Using " << _buf_num << " buffers of size " << _buf_len << "."
               << std::endl;
   }
 
+  /* hackrf_common holds these back until the start, then applies them */
   set_center_freq( (get_freq_range().start() + get_freq_range().stop()) / 2.0 );
   set_sample_rate( get_sample_rates().start() );
   set_bandwidth( 0 );
@@ -114,8 +161,19 @@ hackrf_source_c::hackrf_source_c (const std::string &args)
   _buf = (unsigned char **) malloc(_buf_num * sizeof(unsigned char *));
 
   if (_buf) {
+    /* the decimated samples of a transfer never outnumber its inputs */
+    size_t size = _buf_len;
+    if (_ddc_enabled)
+      size = _buf_len / BYTES_PER_SAMPLE * sizeof(gr_complex);
+
     for(unsigned int i = 0; i < _buf_num; ++i)
-      _buf[i] = (unsigned char *) malloc(_buf_len);
+      _buf[i] = (unsigned char *) malloc(size);
+
+    _buf_zeros.resize( _buf_num, 0 );
+    _buf_samples.resize( _buf_num, 0 );
+
+    if (_ddc_enabled)
+      _ddc_out.resize( _buf_len / BYTES_PER_SAMPLE );
   }
 }
 
@@ -142,15 +200,44 @@ int hackrf_source_c::_hackrf_rx_callback(hackrf_transfer *transfer)
 
 int hackrf_source_c::hackrf_rx_callback(unsigned char *buf, uint32_t len)
 {
+  const osmosdr::time_spec_t arrival = osmosdr::time_spec_t::get_system_time();
+  unsigned int nsamples = len / BYTES_PER_SAMPLE;
+
+  if (_ddc_enabled) { /* counted and stored as decimated samples */
+    nsamples = _ddc.process( (const int8_t *)buf, nsamples, &_ddc_out[0] );
+    buf = (unsigned char *)&_ddc_out[0];
+    len = nsamples * sizeof(gr_complex);
+  }
+
+  _tagger.received( nsamples, arrival );
+
   {
     std::lock_guard<std::mutex> lock(_buf_mutex);
 
+    if (_buf_used == _buf_num && _overflow != stream_tagger::DROP_OLDEST) {
+      std::cerr << "O" << std::flush;
+
+      if (_overflow == stream_tagger::ZERO_FILL) {
+        _zeros_pending += nsamples;
+        _tagger.zero_filled( nsamples );
+      } else {
+        _tagger.lost_newest( nsamples );
+      }
+
+      return 0;
+    }
+
     int buf_tail = (_buf_head + _buf_used) % _buf_num;
+    const unsigned int lost = _buf_samples[buf_tail];
     memcpy(_buf[buf_tail], buf, len);
+    _buf_samples[buf_tail] = nsamples;
+    _buf_zeros[buf_tail] = _zeros_pending;
+    _zeros_pending = 0;
 
     if (_buf_used == _buf_num) {
       std::cerr << "O" << std::flush;
       _buf_head = (_buf_head + 1) % _buf_num;
+      _tagger.lost_oldest( lost );
     } else {
       _buf_used++;
     }
@@ -166,7 +253,10 @@ bool hackrf_source_c::start()
   if ( ! _dev.get() )
     return false;
 
+  _config.commit();
+
   hackrf_common::start();
+  _tagger.sync_start();
   int ret = hackrf_start_rx( _dev.get(), _hackrf_rx_callback, (void *)this );
   if ( ret != HACKRF_SUCCESS ) {
     std::cerr << "Failed to start RX streaming (" << ret << ")" << std::endl;
@@ -193,7 +283,8 @@ int hackrf_source_c::work( int noutput_items,
                         gr_vector_const_void_star &input_items,
                         gr_vector_void_star &output_items )
 {
-  gr_complex *out = (gr_complex *)output_items[0];
+  const size_t itemsize = stream_item_size( _stream_type );
+  char *out = (char *)output_items[0];
 
   bool running = false;
 
@@ -210,38 +301,91 @@ int hackrf_source_c::work( int noutput_items,
   if ( ! running )
     return WORK_DONE;
 
-  const uint8_t *buf = _buf[_buf_head] + _buf_offset * BYTES_PER_SAMPLE;
 #define TO_COMPLEX(p) gr_complex( _lut[(p)[0]], _lut[(p)[1]] )
 
-  if (noutput_items <= _samp_avail) {
-    for (int i = 0; i < noutput_items; ++i)
-      *out++ = TO_COMPLEX( buf + i*BYTES_PER_SAMPLE );
+  int left = noutput_items;
 
-    _buf_offset += noutput_items;
-    _samp_avail -= noutput_items;
-  } else {
-    for (int i = 0; i < _samp_avail; ++i)
-      *out++ = TO_COMPLEX( buf + i*BYTES_PER_SAMPLE );
+  while (left && _buf_used) {
+    if (_buf_zeros[_buf_head]) { /* in place of the samples lost before it */
+      const int nzeros = std::min(uint64_t(left), _buf_zeros[_buf_head]);
 
-    {
-      std::lock_guard<std::mutex> lock(_buf_mutex);
+      std::fill(out, out + nzeros * itemsize, 0);
+      out += nzeros * itemsize;
+      left -= nzeros;
+      _buf_zeros[_buf_head] -= nzeros;
+      continue;
+    }
 
-      _buf_head = (_buf_head + 1) % _buf_num;
-      _buf_used--;
+    const unsigned int samp_avail = _buf_samples[_buf_head] > _buf_offset ?
+                                    _buf_samples[_buf_head] - _buf_offset : 0;
+    const int nout = std::min(left, int(samp_avail));
+    const uint8_t *buf = _buf[_buf_head] + _buf_offset * BYTES_PER_SAMPLE;
+
+    if (_ddc_enabled) {
+      memcpy(out, (const gr_complex *)_buf[_buf_head] + _buf_offset,
+             nout * sizeof(gr_complex));
+    } else if (_stream_type == STREAM_SC8) { /* the native format */
+      memcpy(out, buf, nout * BYTES_PER_SAMPLE);
+    } else {
+      gr_complex *fc32 = (gr_complex *)out;
+      for (int i = 0; i < nout; ++i)
+        fc32[i] = TO_COMPLEX( buf + i*BYTES_PER_SAMPLE );
     }
+    out += nout * itemsize;
 
-    buf = _buf[_buf_head];
+    left -= nout;
 
-    int remaining = noutput_items - _samp_avail;
+    if (nout == int(samp_avail)) {
+      {
+        std::lock_guard<std::mutex> lock(_buf_mutex);
 
-    for (int i = 0; i < remaining; ++i)
-      *out++ = TO_COMPLEX( buf + i*BYTES_PER_SAMPLE );
+        _buf_head = (_buf_head + 1) % _buf_num;
+        _buf_used--;
+      }
+      _buf_offset = 0;
+    } else {
+      _buf_offset += nout;
+    }
+  }
+
+  int nitems = _tagger.process( this, output_items, noutput_items - left, itemsize );
 
-    _buf_offset = remaining;
-    _samp_avail = (_buf_len / BYTES_PER_SAMPLE) - remaining;
+  /* still in cache from the conversion above, measured before correction */
+  if (_monitor.enabled()) {
+    if (_stream_type == STREAM_FC32)
+      _monitor.process( 0, (const gr_complex *)output_items[0], nitems );
+    else
+      _monitor.process( 0, (const int8_t *)output_items[0], nitems );
   }
 
-  return noutput_items;
+  if (_stream_type == STREAM_FC32)
+    _corrector.process( (gr_complex *)output_items[0], nitems );
+
+  /* shifted after the correction, which takes out the dc of the tuner */
+  if (_stream_type == STREAM_FC32 && !_ddc_enabled)
+    _nco.process( (gr_complex *)output_items[0], (gr_complex *)output_items[0], nitems );
+
+  return nitems;
+}
+
+stream_tagger *hackrf_source_c::get_stream_tagger()
+{
+  return &_tagger;
+}
+
+void hackrf_source_c::begin_config()
+{
+  _config.begin();
+}
+
+void hackrf_source_c::commit_config()
+{
+  _config.commit();
+}
+
+unsigned int hackrf_source_c::get_config_generation()
+{
+  return _config.generation();
 }
 
 std::vector<std::string> hackrf_source_c::get_devices()
@@ -256,16 +400,55 @@ size_t hackrf_source_c::get_num_channels()
 
 osmosdr::meta_range_t hackrf_source_c::get_sample_rates()
 {
-  return hackrf_common::get_sample_rates();
+  if ( ! _ddc_enabled )
+    return hackrf_common::get_sample_rates();
+
+  /* anything up to the ddc rate, the device rates above it pass through */
+  osmosdr::meta_range_t range;
+
+  range.push_back(osmosdr::range_t( _ddc_rate / DDC_MAX_DECIMATION, _ddc_rate ));
+
+  for (const osmosdr::range_t &r : hackrf_common::get_sample_rates())
+    if (r.start() > _ddc_rate)
+      range.push_back(r);
+
+  return range;
 }
 
 double hackrf_source_c::set_sample_rate( double rate )
 {
-  return hackrf_common::set_sample_rate(rate);
+  if ( _config.defer( CFG_SAMPLE_RATE, rate,
+                      [this]( double v ) { set_sample_rate( v ); } ) )
+    return rate;
+
+  _tagger.begin_change();
+  double actual;
+
+  if ( _ddc_enabled ) {
+    double in = hackrf_common::set_sample_rate( std::max( rate, _ddc_rate ) );
+    actual = _ddc.set_rates( in, rate );
+    _tagger.set_latency( _buf_len / BYTES_PER_SAMPLE * actual / in );
+  } else {
+    actual = hackrf_common::set_sample_rate(rate);
+  }
+
+  _tagger.set_sample_rate( actual );
+  _monitor.set_rate( actual );
+  _nco.set_rate( actual );
+  _tagger.end_change( pmt::mp("rx_rate"), pmt::from_double( actual ) );
+
+  return actual;
 }
 
 double hackrf_source_c::get_sample_rate()
 {
+  double rate;
+  if ( _config.pending( CFG_SAMPLE_RATE, rate ) )
+    return rate;
+
+  if ( _ddc_enabled )
+    return _ddc.output_rate();
+
   return hackrf_common::get_sample_rate();
 }
 
@@ -276,21 +459,50 @@ osmosdr::freq_range_t hackrf_source_c::get_freq_range( size_t chan )
 
 double hackrf_source_c::set_center_freq( double freq, size_t chan )
 {
-  return hackrf_common::set_center_freq(freq, chan);
+  if ( _config.defer( CFG_CENTER_FREQ, freq,
+                      [this, chan]( double v ) { set_center_freq( v, chan ); } ) )
+    return freq;
+
+  _tagger.begin_change();
+  double actual = hackrf_common::set_center_freq(freq, chan);
+  if ( _ddc_enabled ) { /* the nco takes the fraction of a Hz the tuner can't */
+    double corr_freq = freq * (1.0 + hackrf_common::get_freq_corr() * 0.000001);
+    _ddc_tune = corr_freq - std::floor( corr_freq );
+    _ddc.set_shift( _ddc_tune + _freq_shift );
+  }
+  _tagger.end_change( pmt::mp("rx_freq"), pmt::from_double( actual ) );
+
+  return actual;
 }
 
 double hackrf_source_c::get_center_freq( size_t chan )
 {
+  double freq;
+  if ( _config.pending( CFG_CENTER_FREQ, freq ) )
+    return freq;
+
   return hackrf_common::get_center_freq(chan);
 }
 
 double hackrf_source_c::set_freq_corr( double ppm, size_t chan )
 {
-  return hackrf_common::set_freq_corr(ppm, chan);
+  if ( _config.defer( CFG_FREQ_CORR, ppm,
+                      [this, chan]( double v ) { set_freq_corr( v, chan ); } ) )
+    return ppm;
+
+  double actual = hackrf_common::set_freq_corr(ppm, chan);
+  if ( _ddc_enabled ) /* the fraction of a Hz moves with the correction */
+    set_center_freq( get_center_freq( chan ), chan );
+
+  return actual;
 }
 
 double hackrf_source_c::get_freq_corr( size_t chan )
 {
+  double ppm;
+  if ( _config.pending( CFG_FREQ_CORR, ppm ) )
+    return ppm;
+
   return hackrf_common::get_freq_corr(chan);
 }
 
@@ -333,7 +545,15 @@ bool hackrf_source_c::get_gain_mode( size_t chan )
 
 double hackrf_source_c::set_gain( double gain, size_t chan )
 {
-  return hackrf_common::set_gain(gain, chan);
+  if ( _config.defer( CFG_GAIN, gain,
+                      [this, chan]( double v ) { set_gain( v, chan ); } ) )
+    return gain;
+
+  _tagger.begin_change();
+  double actual = hackrf_common::set_gain(gain, chan);
+  _tagger.end_change( pmt::mp("rx_gain"), pmt::from_double( actual ) );
+
+  return actual;
 }
 
 double hackrf_source_c::set_gain( double gain, const std::string & name, size_t chan)
@@ -355,6 +575,10 @@ double hackrf_source_c::set_gain( double gain, const std::string & name, size_t
 
 double hackrf_source_c::get_gain( size_t chan )
 {
+  double gain;
+  if ( _config.pending( CFG_GAIN, gain ) )
+    return gain;
+
   return hackrf_common::get_gain(chan);
 }
 
@@ -364,11 +588,19 @@ double hackrf_source_c::get_gain( const std::string & name, size_t chan )
     return get_gain( chan );
   }
 
+  double gain;
+
   if ( "IF" == name ) {
+    if ( _config.pending( CFG_IF_GAIN, gain ) )
+      return gain;
+
     return _lna_gain;
   }
 
   if ( "BB" == name ) {
+    if ( _config.pending( CFG_BB_GAIN, gain ) )
+      return gain;
+
     return _vga_gain;
   }
 
@@ -377,15 +609,22 @@ double hackrf_source_c::get_gain( const std::string & name, size_t chan )
 
 double hackrf_source_c::set_if_gain(double gain, size_t chan)
 {
+  if ( _config.defer( CFG_IF_GAIN, gain,
+                      [this, chan]( double v ) { set_if_gain( v, chan ); } ) )
+    return gain;
+
   int ret;
   osmosdr::gain_range_t rf_gains = get_gain_range( "IF", chan );
 
   if (_dev.get()) {
     double clip_gain = rf_gains.clip( gain, true );
 
+    _tagger.begin_change();
     ret = hackrf_set_lna_gain( _dev.get(), uint32_t(clip_gain) );
     if ( HACKRF_SUCCESS == ret ) {
       _lna_gain = clip_gain;
+      _tagger.end_change( pmt::mp("rx_gain"),
+                          pmt::cons( pmt::mp("IF"), pmt::from_double( _lna_gain ) ) );
     } else {
       HACKRF_THROW_ON_ERROR( ret, HACKRF_FUNC_STR( "hackrf_set_lna_gain", clip_gain ) )
     }
@@ -396,15 +635,22 @@ double hackrf_source_c::set_if_gain(double gain, size_t chan)
 
 double hackrf_source_c::set_bb_gain( double gain, size_t chan )
 {
+  if ( _config.defer( CFG_BB_GAIN, gain,
+                      [this, chan]( double v ) { set_bb_gain( v, chan ); } ) )
+    return gain;
+
   int ret;
   osmosdr::gain_range_t if_gains = get_gain_range( "BB", chan );
 
   if (_dev.get()) {
     double clip_gain = if_gains.clip( gain, true );
 
+    _tagger.begin_change();
     ret = hackrf_set_vga_gain( _dev.get(), uint32_t(clip_gain) );
     if ( HACKRF_SUCCESS == ret ) {
       _vga_gain = clip_gain;
+      _tagger.end_change( pmt::mp("rx_gain"),
+                          pmt::cons( pmt::mp("BB"), pmt::from_double( _vga_gain ) ) );
     } else {
       HACKRF_THROW_ON_ERROR( ret, HACKRF_FUNC_STR( "hackrf_set_vga_gain", clip_gain ) )
     }
@@ -430,11 +676,19 @@ std::string hackrf_source_c::get_antenna( size_t chan )
 
 double hackrf_source_c::set_bandwidth( double bandwidth, size_t chan )
 {
+  if ( _config.defer( CFG_BANDWIDTH, bandwidth,
+                      [this, chan]( double v ) { set_bandwidth( v, chan ); } ) )
+    return bandwidth;
+
   return hackrf_common::set_bandwidth(bandwidth, chan);
 }
 
 double hackrf_source_c::get_bandwidth( size_t chan )
 {
+  double bandwidth;
+  if ( _config.pending( CFG_BANDWIDTH, bandwidth ) )
+    return bandwidth;
+
   return hackrf_common::get_bandwidth(chan);
 }
 
@@ -442,3 +696,64 @@ osmosdr::freq_range_t hackrf_source_c::get_bandwidth_range( size_t chan )
 {
   return hackrf_common::get_bandwidth_range(chan);
 }
+
+void hackrf_source_c::set_dc_offset_mode( int mode, size_t chan )
+{
+  _corrector.set_dc_offset_mode( mode );
+}
+
+void hackrf_source_c::set_dc_offset( const std::complex<double> &offset, size_t chan )
+{
+  _corrector.set_dc_offset( offset );
+}
+
+void hackrf_source_c::set_iq_balance_mode( int mode, size_t chan )
+{
+  _corrector.set_iq_balance_mode( mode );
+}
+
+void hackrf_source_c::set_iq_balance( const std::complex<double> &balance, size_t chan )
+{
+  _corrector.set_iq_balance( balance );
+}
+
+iq_corrector *hackrf_source_c::get_iq_corrector()
+{
+  return &_corrector;
+}
+
+signal_monitor *hackrf_source_c::get_signal_monitor()
+{
+  return &_monitor;
+}
+
+bool hackrf_source_c::set_freq_shift( double freq, size_t chan )
+{
+  if ( _stream_type != STREAM_FC32 )
+    return false;
+
+  _freq_shift = freq;
+
+  if ( _ddc_enabled ) {
+    _ddc.set_shift( _ddc_tune + _freq_shift );
+  } else {
+    _nco.set_rate( get_sample_rate() );
+    _nco.set_shift( _freq_shift );
+  }
+
+  return true;
+}
+
+bool hackrf_source_c::set_stream_type( stream_type_t type )
+{
+  if ( type != STREAM_FC32 && type != STREAM_SC8 )
+    return false;
+
+  if ( type != STREAM_FC32 && _ddc_enabled ) /* decimated as floats */
+    return false;
+
+  _stream_type = type;
+  set_output_signature( gr::io_signature::make(MIN_OUT, MAX_OUT, stream_item_size( type )) );
+
+  return true;
+}
@@ -30,6 +30,12 @@
 
 #include "source_iface.h"
 #include "hackrf_common.h"
+#include "stream_tagger.h"
+#include "deferred_config.h"
+#include "iq_corrector.h"
+#include "signal_monitor.h"
+#include "ddc.h"
+#include "nco.h"
 
 class hackrf_source_c;
 
@@ -119,11 +125,28 @@ public:
   double get_bandwidth( size_t chan = 0 );
   osmosdr::freq_range_t get_bandwidth_range( size_t chan = 0 );
 
+  void set_dc_offset_mode( int mode, size_t chan = 0 );
+  void set_dc_offset( const std::complex<double> &offset, size_t chan = 0 );
+
+  void set_iq_balance_mode( int mode, size_t chan = 0 );
+  void set_iq_balance( const std::complex<double> &balance, size_t chan = 0 );
+
+  stream_tagger *get_stream_tagger( void );
+  iq_corrector *get_iq_corrector( void );
+  signal_monitor *get_signal_monitor( void );
+  bool set_freq_shift( double freq, size_t chan = 0 );
+  bool set_stream_type( stream_type_t type );
+
+  void begin_config( void );
+  void commit_config( void );
+  unsigned int get_config_generation( void );
+
 private:
   static int _hackrf_rx_callback(hackrf_transfer* transfer);
   int hackrf_rx_callback(unsigned char *buf, uint32_t len);
 
   std::vector<float> _lut;
+  stream_type_t _stream_type; /* fc32 or sc8 */
 
   unsigned char **_buf;
   unsigned int _buf_num;
@@ -133,11 +156,28 @@ private:
   std::mutex _buf_mutex;
   std::condition_variable _buf_cond;
 
+  stream_tagger::overflow_policy _overflow;
+  std::vector<uint64_t> _buf_zeros; /* to put out before each buffer */
+  uint64_t _zeros_pending; /* for the next buffer received */
+
+  std::vector<unsigned int> _buf_samples; /* held by each buffer */
   unsigned int _buf_offset;
-  int _samp_avail;
+
+  bool _ddc_enabled; /* the buffers hold decimated gr_complex samples */
+  double _ddc_rate;
+  ddc _ddc;
+  double _ddc_tune; /* the part of the ddc shift completing the tuning */
+  double _freq_shift;
+  nco _nco; /* the shift without the ddc */
+  std::vector<gr_complex> _ddc_out;
 
   double _lna_gain;
   double _vga_gain;
+
+  stream_tagger _tagger;
+  deferred_config _config;
+  iq_corrector _corrector;
+  signal_monitor _monitor;
 };
 
 #endif /* INCLUDED_HACKRF_SOURCE_C_H */
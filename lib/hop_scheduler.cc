@@ -0,0 +1,97 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+
+#include <gnuradio/thread/thread.h>
+
+#include "hop_scheduler.h"
+
+#define HOP_THREAD_PRIORITY 50
+
+hop_scheduler::hop_scheduler( source_iface *dev, size_t chan,
+                              const osmosdr::hop_schedule_t &hops,
+                              const hop_callback_t &on_hop )
+  : _dev(dev),
+    _chan(chan),
+    _hops(hops),
+    _on_hop(on_hop),
+    _tagger(dev->get_stream_tagger()),
+    _stop(false)
+{
+  if ( _tagger == NULL )
+    throw std::runtime_error( "Frequency hopping is not supported by this device." );
+
+  if ( _hops.empty() )
+    throw std::runtime_error( "Empty hopping schedule." );
+
+  for (size_t i = 0; i < _hops.size(); i++)
+    if ( _hops[i].dwell == 0 )
+      throw std::runtime_error( "Hop #" + std::to_string( i ) + " has no dwell." );
+
+  /* before the thread starts, so stopping it can not be missed */
+  _tagger->start_dwells();
+
+  _thread = std::thread( &hop_scheduler::run, this );
+}
+
+hop_scheduler::~hop_scheduler()
+{
+  _stop = true;
+  _tagger->stop_dwells();
+  _thread.join();
+}
+
+void hop_scheduler::run()
+{
+  /* needs the privileges for realtime scheduling, best effort otherwise */
+  gr::thread::set_thread_priority( gr::thread::get_current_thread_id(),
+                                   HOP_THREAD_PRIORITY );
+
+  size_t index = 0;
+
+  while ( ! _stop ) {
+    const osmosdr::hop_t &hop = _hops[ index ];
+
+    try {
+      double gain = NAN;
+      if ( !std::isnan( hop.gain ) )
+        gain = _dev->set_gain( hop.gain, _chan );
+
+      uint64_t done = _tagger->dwells_done();
+
+      _tagger->set_next_dwell( hop.dwell );
+      double freq = _dev->set_center_freq( hop.center_freq, _chan );
+
+      _on_hop( freq, gain );
+
+      if ( ! _tagger->wait_dwells( done + 1 ) )
+        break;
+    } catch ( std::exception &ex ) {
+      std::cerr << "Frequency hopping stopped: " << ex.what() << std::endl;
+      _tagger->stop_dwells();
+      break;
+    }
+
+    index = (index + 1) % _hops.size();
+  }
+}
@@ -0,0 +1,66 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef OSMOSDR_HOP_SCHEDULER_H
+#define OSMOSDR_HOP_SCHEDULER_H
+
+#include <atomic>
+#include <functional>
+#include <thread>
+
+#include <osmosdr/settings.h>
+
+#include "source_iface.h"
+#include "stream_tagger.h"
+
+/*
+ * Hops a source device through a schedule from a thread of its own. The
+ * next retune is issued as soon as the stream tagger of the device has
+ * passed on the dwell of the current hop, everything received in between
+ * is discarded by the tagger.
+ */
+class hop_scheduler
+{
+public:
+  /* called from the hopping thread with the values the device reported */
+  typedef std::function< void ( double freq, double gain ) > hop_callback_t;
+
+  hop_scheduler( source_iface *dev, size_t chan,
+                 const osmosdr::hop_schedule_t &hops,
+                 const hop_callback_t &on_hop );
+  ~hop_scheduler();
+
+  hop_scheduler( const hop_scheduler & ) = delete;
+  hop_scheduler &operator=( const hop_scheduler & ) = delete;
+
+private:
+  void run();
+
+  source_iface *_dev;
+  size_t _chan;
+  osmosdr::hop_schedule_t _hops;
+  hop_callback_t _on_hop;
+  stream_tagger *_tagger;
+
+  std::atomic< bool > _stop;
+  std::thread _thread;
+};
+
+#endif // OSMOSDR_HOP_SCHEDULER_H
@@ -0,0 +1,185 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#ifdef USE_SSE2
+#include <emmintrin.h>
+#endif
+
+#include <osmosdr/source.h>
+
+#include "iq_corrector.h"
+
+#define TIME_CONSTANT (1 << 18) /* samples, for the automatic modes */
+#define CHUNK_SIZE 1024 /* samples summed in single precision */
+
+iq_corrector::iq_corrector()
+  : _dc_mode(osmosdr::source::DCOffsetOff),
+    _iq_mode(osmosdr::source::IQBalanceOff),
+    _dc(0, 0),
+    _gain(1),
+    _phase(0),
+    _ii(0),
+    _qq(0),
+    _iq(0)
+{
+}
+
+void iq_corrector::set_dc_offset_mode( int mode )
+{
+  std::lock_guard< std::mutex > lock( _mutex );
+
+  if ( osmosdr::source::DCOffsetOff == mode )
+    _dc = gr_complex( 0, 0 );
+
+  _dc_mode = mode;
+}
+
+void iq_corrector::set_dc_offset( const std::complex<double> &offset )
+{
+  std::lock_guard< std::mutex > lock( _mutex );
+  _dc = gr_complex( offset.real(), offset.imag() );
+}
+
+void iq_corrector::set_iq_balance_mode( int mode )
+{
+  std::lock_guard< std::mutex > lock( _mutex );
+
+  if ( osmosdr::source::IQBalanceOff == mode ) {
+    _gain = 1;
+    _phase = 0;
+  }
+
+  if ( mode != _iq_mode )
+    _ii = _qq = _iq = 0;
+
+  _iq_mode = mode;
+}
+
+void iq_corrector::set_iq_balance( const std::complex<double> &balance )
+{
+  std::lock_guard< std::mutex > lock( _mutex );
+  _gain = 1 + balance.real();
+  _phase = balance.imag();
+}
+
+void iq_corrector::process( gr_complex *samples, size_t nitems )
+{
+  std::unique_lock< std::mutex > lock( _mutex );
+
+  if ( !nitems || ( osmosdr::source::DCOffsetOff == _dc_mode &&
+                    osmosdr::source::IQBalanceOff == _iq_mode ) )
+    return;
+
+  const gr_complex dc = _dc;
+  const float gain = _gain;
+  const float phase = _phase;
+
+  lock.unlock();
+
+  float *p = reinterpret_cast< float * >( samples );
+
+  double sum_i = 0, sum_q = 0, ii = 0, qq = 0, iq = 0;
+
+  for (size_t start = 0; start < nitems; start += CHUNK_SIZE) {
+    const size_t end = std::min( nitems, start + CHUNK_SIZE );
+    size_t k = start;
+
+    float s_i = 0, s_q = 0, s_ii = 0, s_qq = 0, s_iq = 0;
+
+#ifdef USE_SSE2
+    const __m128 vdc = _mm_setr_ps( dc.real(), dc.imag(), dc.real(), dc.imag() );
+    const __m128 vgain = _mm_setr_ps( gain, 1, gain, 1 );
+    const __m128 vphase = _mm_setr_ps( 0, phase, 0, phase );
+
+    __m128 vsum = _mm_setzero_ps();
+    __m128 vsq = _mm_setzero_ps();
+    __m128 vcross = _mm_setzero_ps();
+
+    for (; k + 2 <= end; k += 2) {
+      __m128 x = _mm_sub_ps( _mm_loadu_ps( p + 2 * k ), vdc );
+      __m128 i = _mm_shuffle_ps( x, x, _MM_SHUFFLE(2, 2, 0, 0) );
+
+      vsum = _mm_add_ps( vsum, x );
+      vsq = _mm_add_ps( vsq, _mm_mul_ps( x, x ) );
+      vcross = _mm_add_ps( vcross, _mm_mul_ps( x, i ) );
+
+      _mm_storeu_ps( p + 2 * k, _mm_add_ps( _mm_mul_ps( x, vgain ),
+                                            _mm_mul_ps( i, vphase ) ) );
+    }
+
+    float a[4], b[4], c[4];
+    _mm_storeu_ps( a, vsum );
+    _mm_storeu_ps( b, vsq );
+    _mm_storeu_ps( c, vcross );
+
+    s_i = a[0] + a[2];
+    s_q = a[1] + a[3];
+    s_ii = b[0] + b[2];
+    s_qq = b[1] + b[3];
+    s_iq = c[1] + c[3];
+#endif
+
+    for (; k < end; k++) {
+      const float i = p[2 * k] - dc.real();
+      const float q = p[2 * k + 1] - dc.imag();
+
+      s_i += i;
+      s_q += q;
+      s_ii += i * i;
+      s_qq += q * q;
+      s_iq += i * q;
+
+      p[2 * k] = i * gain;
+      p[2 * k + 1] = q + i * phase;
+    }
+
+    sum_i += s_i;
+    sum_q += s_q;
+    ii += s_ii;
+    qq += s_qq;
+    iq += s_iq;
+  }
+
+  const double alpha = 1.0 - std::exp( -double(nitems) / TIME_CONSTANT );
+
+  lock.lock();
+
+  if ( osmosdr::source::DCOffsetAutomatic == _dc_mode )
+    _dc += gr_complex( alpha * sum_i / nitems, alpha * sum_q / nitems );
+
+  if ( osmosdr::source::IQBalanceAutomatic == _iq_mode ) {
+    _ii += alpha * ( ii / nitems - _ii );
+    _qq += alpha * ( qq / nitems - _qq );
+    _iq += alpha * ( iq / nitems - _iq );
+
+    if ( _ii > 0 ) {
+      /* decorrelate Q from I, then match the power of I to what is left */
+      const double q_power = _qq - _iq * _iq / _ii;
+
+      if ( q_power > 0 ) {
+        _phase = -_iq / _ii;
+        _gain = std::sqrt( q_power / _ii );
+      }
+    }
+  }
+}
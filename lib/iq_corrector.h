@@ -0,0 +1,69 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef OSMOSDR_IQ_CORRECTOR_H
+#define OSMOSDR_IQ_CORRECTOR_H
+
+#include <complex>
+#include <mutex>
+
+#include <osmosdr/api.h>
+#include <gnuradio/gr_complex.h>
+
+/*
+ * DC offset removal and IQ imbalance correction applied in place by a
+ * backend right after converting its samples, in a single pass over the
+ * data. The modes follow the osmosdr::source API: Off, Manual (hold the
+ * current correction or use the one set) and Automatic (track it).
+ *
+ * The IQ correction scales I by (1 + magnitude) and adds phase * I to Q,
+ * the automatic mode derives both from the second order moments of the
+ * DC free signal.
+ */
+class OSMOSDR_API iq_corrector
+{
+public:
+  iq_corrector();
+
+  void set_dc_offset_mode( int mode );
+  void set_dc_offset( const std::complex<double> &offset );
+
+  void set_iq_balance_mode( int mode );
+  void set_iq_balance( const std::complex<double> &balance );
+
+  void process( gr_complex *samples, size_t nitems );
+
+private:
+  std::mutex _mutex;
+
+  int _dc_mode;
+  int _iq_mode;
+
+  gr_complex _dc;
+  float _gain;
+  float _phase;
+
+  /* smoothed moments of the DC free signal */
+  double _ii;
+  double _qq;
+  double _iq;
+};
+
+#endif // OSMOSDR_IQ_CORRECTOR_H
@@ -0,0 +1,80 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <cmath>
+#include <cstring>
+
+#include <volk/volk.h>
+
+#include "nco.h"
+
+nco::nco()
+  : _rate(0),
+    _shift(0),
+    _active(false),
+    _phase(1, 0),
+    _phase_inc(1, 0)
+{
+}
+
+void nco::set_rate( double rate )
+{
+  std::lock_guard< std::mutex > lock( _mutex );
+
+  _rate = rate;
+  update();
+}
+
+void nco::set_shift( double freq )
+{
+  std::lock_guard< std::mutex > lock( _mutex );
+
+  _shift = freq;
+  update();
+}
+
+double nco::get_shift()
+{
+  std::lock_guard< std::mutex > lock( _mutex );
+  return _shift;
+}
+
+void nco::update()
+{
+  _active = _shift != 0 && _rate > 0;
+
+  if ( _active ) {
+    const double angle = -2.0 * M_PI * _shift / _rate;
+    _phase_inc = gr_complex( std::cos( angle ), std::sin( angle ) );
+  }
+}
+
+void nco::process( const gr_complex *in, gr_complex *out, size_t nitems )
+{
+  std::lock_guard< std::mutex > lock( _mutex );
+
+  if ( ! _active ) {
+    if ( in != out )
+      memcpy( out, in, nitems * sizeof(gr_complex) );
+    return;
+  }
+
+  volk_32fc_s32fc_x2_rotator_32fc( out, in, _phase_inc, &_phase, nitems );
+}
@@ -0,0 +1,61 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef OSMOSDR_NCO_H
+#define OSMOSDR_NCO_H
+
+#include <mutex>
+
+#include <stddef.h>
+
+#include <osmosdr/api.h>
+#include <gnuradio/gr_complex.h>
+
+/*
+ * Phase continuous frequency shift of the samples of a source backend,
+ * applied in the pass over the converted samples. Changing the shift or
+ * the rate keeps the phase, so retuning leaves no discontinuity.
+ */
+class OSMOSDR_API nco
+{
+public:
+  nco();
+
+  void set_rate( double rate );
+
+  /* the offset within the band to bring to 0 Hz */
+  void set_shift( double freq );
+  double get_shift( void );
+
+  /* in may be out, copied unchanged while there is no shift */
+  void process( const gr_complex *in, gr_complex *out, size_t nitems );
+
+private:
+  void update( void );
+
+  std::mutex _mutex;
+
+  double _rate;
+  double _shift;
+  bool _active;
+  gr_complex _phase;
+  gr_complex _phase_inc;
+};
+
+#endif // OSMOSDR_NCO_H
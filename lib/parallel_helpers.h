@@ -0,0 +1,88 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef OSMOSDR_PARALLEL_HELPERS_H
+#define OSMOSDR_PARALLEL_HELPERS_H
+
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <gnuradio/thread/thread.h>
+
+typedef std::function< void ( void ) > task_t;
+
+/*
+ * Run each task on its own thread and return when all of them are done.
+ * Failures do not stop the remaining tasks, they are collected and thrown
+ * as a single runtime_error naming every failed task by its label (or by
+ * its index if no labels were given). A single task runs on the calling
+ * thread and its exception is propagated unchanged.
+ */
+inline void run_in_parallel( const std::vector< task_t > &tasks,
+                             const std::vector< std::string > &labels =
+                                   std::vector< std::string >() )
+{
+  if ( tasks.size() == 1 ) {
+    tasks[0](); /* nothing to gain from spawning a thread, errors pass through */
+    return;
+  }
+
+  std::vector< std::string > errors( tasks.size() );
+  std::vector< char > failed( tasks.size(), 0 ); /* not vector<bool>, written concurrently */
+
+  gr::thread::thread_group threads;
+
+  for (size_t i = 0; i < tasks.size(); i++) {
+    threads.create_thread( [&tasks, &errors, &failed, i]() {
+      try {
+        tasks[i]();
+      } catch ( std::exception &ex ) {
+        errors[i] = ex.what();
+        failed[i] = 1;
+      } catch ( ... ) {
+        errors[i] = "unknown error";
+        failed[i] = 1;
+      }
+    } );
+  }
+
+  threads.join_all();
+
+  std::string msg;
+  for (size_t i = 0; i < tasks.size(); i++) {
+    if ( ! failed[i] )
+      continue;
+
+    if ( msg.length() )
+      msg += "; ";
+
+    if ( i < labels.size() )
+      msg += "'" + labels[i] + "': " + errors[i];
+    else
+      msg += "#" + std::to_string( i ) + ": " + errors[i];
+  }
+
+  if ( msg.length() )
+    throw std::runtime_error( msg );
+}
+
+#endif // OSMOSDR_PARALLEL_HELPERS_H
@@ -0,0 +1,191 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+#include <gnuradio/io_signature.h>
+#include <gnuradio/fft/window.h>
+
+#include "psd_estimator.h"
+
+#define KAISER_BETA 6.76
+
+static std::vector< float > make_window( const std::string &name, size_t ntaps )
+{
+  gr::fft::window::win_type type;
+
+  if ( name == "rect" )
+    type = gr::fft::window::WIN_RECTANGULAR;
+  else if ( name == "hann" )
+    type = gr::fft::window::WIN_HANN;
+  else if ( name == "hamming" )
+    type = gr::fft::window::WIN_HAMMING;
+  else if ( name == "blackman" )
+    type = gr::fft::window::WIN_BLACKMAN;
+  else if ( name == "blackmanharris" )
+    type = gr::fft::window::WIN_BLACKMAN_HARRIS;
+  else
+    throw std::runtime_error( "Unknown psd window '" + name + "'." );
+
+  return gr::fft::window::build( type, ntaps, KAISER_BETA );
+}
+
+psd_estimator_sptr make_psd_estimator( size_t chan, size_t fft_size,
+                                       size_t averages,
+                                       const std::string &window,
+                                       double frame_rate )
+{
+  return gnuradio::get_initial_sptr(
+        new psd_estimator( chan, fft_size, averages, window, frame_rate ) );
+}
+
+psd_estimator::psd_estimator( size_t chan, size_t fft_size, size_t averages,
+                              const std::string &window, double frame_rate )
+  : gr::sync_block( "psd_estimator",
+                    gr::io_signature::make(1, 1, sizeof(gr_complex)),
+                    gr::io_signature::make(0, 0, 0) ),
+    _chan(chan),
+    _fft_size(fft_size),
+    _averages(std::max( averages, size_t(1) )),
+    _frame_rate(frame_rate),
+    _rate(0),
+    _window(make_window( window, fft_size )),
+    _frame(_fft_size * _averages),
+    _fill(0),
+    _pending(_fft_size * _averages),
+    _busy(false),
+    _dropped(0),
+    _frames(0),
+    _fft(fft_size, true),
+    _acc(fft_size, 0),
+    _bins(fft_size, 0)
+{
+  if ( fft_size < 2 )
+    throw std::runtime_error( "The psd size must be at least 2." );
+
+  if ( ! (frame_rate > 0) )
+    throw std::runtime_error( "The psd rate must be positive." );
+
+  /* a full scale tone in the middle of a bin reads 0 dB */
+  float sum = 0;
+  for (size_t i = 0; i < _window.size(); i++)
+    sum += _window[i];
+  _scale = sum * sum * _averages;
+
+  message_port_register_out( pmt::mp("psd") );
+}
+
+psd_estimator::~psd_estimator()
+{
+}
+
+void psd_estimator::set_rate( double rate )
+{
+  _rate = rate;
+}
+
+uint64_t psd_estimator::snapshot_length() const
+{
+  return _frame.size();
+}
+
+uint64_t psd_estimator::snapshot_interval() const
+{
+  return std::max( uint64_t( _rate / _frame_rate ), snapshot_length() );
+}
+
+uint64_t psd_estimator::dropped() const
+{
+  return _dropped;
+}
+
+int psd_estimator::work( int noutput_items,
+                         gr_vector_const_void_star &input_items,
+                         gr_vector_void_star &output_items )
+{
+  const gr_complex *in = static_cast< const gr_complex * >( input_items[0] );
+  size_t nitems = noutput_items;
+
+  while ( nitems ) {
+    size_t n = std::min( nitems, _frame.size() - _fill );
+
+    memcpy( &_frame[_fill], in, n * sizeof(gr_complex) );
+    _fill += n;
+    in += n;
+    nitems -= n;
+
+    if ( _fill < _frame.size() )
+      break;
+
+    _fill = 0;
+
+    if ( _busy ) {
+      _dropped++;
+      continue;
+    }
+
+    _busy = true;
+    _pending.swap( _frame );
+    _worker.post( [this]() { estimate(); } );
+  }
+
+  return noutput_items;
+}
+
+void psd_estimator::estimate()
+{
+  std::fill( _acc.begin(), _acc.end(), 0 );
+
+  for (size_t a = 0; a < _averages; a++) {
+    const gr_complex *in = &_pending[a * _fft_size];
+    gr_complex *frame = _fft.get_inbuf();
+
+    for (size_t i = 0; i < _fft_size; i++)
+      frame[i] = in[i] * _window[i];
+
+    _fft.execute();
+
+    const gr_complex *out = _fft.get_outbuf();
+    for (size_t i = 0; i < _fft_size; i++)
+      _acc[i] += std::norm( out[i] );
+  }
+
+  /* negative frequencies first */
+  for (size_t i = 0; i < _fft_size; i++) {
+    float power = _acc[ (i + (_fft_size + 1) / 2) % _fft_size ] / _scale;
+    _bins[i] = 10.0f * std::log10( std::max( power, 1e-20f ) );
+  }
+
+  const double rate = _rate;
+
+  pmt::pmt_t meta = pmt::make_dict();
+  meta = pmt::dict_add( meta, pmt::mp("chan"), pmt::from_uint64( _chan ) );
+  meta = pmt::dict_add( meta, pmt::mp("sample_rate"), pmt::from_double( rate ) );
+  meta = pmt::dict_add( meta, pmt::mp("bin_width"), pmt::from_double( rate / _fft_size ) );
+  meta = pmt::dict_add( meta, pmt::mp("frame"), pmt::from_uint64( _frames++ ) );
+  meta = pmt::dict_add( meta, pmt::mp("dropped"), pmt::from_uint64( _dropped ) );
+
+  message_port_pub( pmt::mp("psd"), pmt::cons( meta, pmt::init_f32vector( _bins.size(), _bins ) ) );
+
+  _busy = false;
+}
@@ -0,0 +1,109 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef INCLUDED_OSMOSDR_PSD_ESTIMATOR_H
+#define INCLUDED_OSMOSDR_PSD_ESTIMATOR_H
+
+#include <gnuradio/sync_block.h>
+#include <gnuradio/fft/fft.h>
+
+#include "control_thread.h"
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+class psd_estimator;
+
+typedef boost::shared_ptr<psd_estimator> psd_estimator_sptr;
+
+/*
+ * window is one of rect, hann, hamming, blackman or blackmanharris,
+ * frame_rate the number of spectra to publish per second.
+ */
+psd_estimator_sptr make_psd_estimator( size_t chan, size_t fft_size,
+                                       size_t averages,
+                                       const std::string &window,
+                                       double frame_rate );
+
+/*!
+ * \brief Publishes the averaged power spectrum of a channel on the "psd"
+ * message port, as a pdu of dB values from the lowest frequency up.
+ *
+ * It is fed through a snapshot_tap with snapshot_length() samples out of
+ * every snapshot_interval(), the FFTs are done on a worker thread. A frame
+ * arriving while the previous one is still being worked on is dropped.
+ */
+class psd_estimator : public gr::sync_block
+{
+private:
+  friend psd_estimator_sptr make_psd_estimator( size_t chan, size_t fft_size,
+                                                size_t averages,
+                                                const std::string &window,
+                                                double frame_rate );
+
+  psd_estimator( size_t chan, size_t fft_size, size_t averages,
+                 const std::string &window, double frame_rate );
+
+public:
+  ~psd_estimator();
+
+  void set_rate( double rate );
+
+  uint64_t snapshot_length( void ) const;
+  uint64_t snapshot_interval( void ) const;
+
+  /* frames dropped because the worker was busy */
+  uint64_t dropped( void ) const;
+
+  int work( int noutput_items,
+            gr_vector_const_void_star &input_items,
+            gr_vector_void_star &output_items );
+
+private:
+  void estimate( void );
+
+  size_t _chan;
+  size_t _fft_size;
+  size_t _averages;
+  double _frame_rate;
+  std::atomic< double > _rate;
+
+  std::vector< float > _window;
+  float _scale;
+
+  std::vector< gr_complex > _frame; /* being filled by work() */
+  size_t _fill;
+  std::vector< gr_complex > _pending; /* being worked on */
+  std::atomic< bool > _busy;
+  std::atomic< uint64_t > _dropped;
+  uint64_t _frames;
+
+  /* used by the worker only */
+  gr::fft::fft_complex _fft;
+  std::vector< float > _acc;
+  std::vector< float > _bins;
+
+  /* declared last to be stopped first */
+  control_thread _worker;
+};
+
+#endif /* INCLUDED_OSMOSDR_PSD_ESTIMATOR_H */
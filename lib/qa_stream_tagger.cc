@@ -0,0 +1,227 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * Runs a stream_tagger the way a source backend does, a script of changes
+ * is played at given sample counts from the work() of a source whose
+ * samples count up from 0, so the output tells which ones were passed on.
+ */
+
+#include <algorithm>
+#include <functional>
+#include <iostream>
+
+#include <gnuradio/io_signature.h>
+#include <gnuradio/sync_block.h>
+#include <gnuradio/top_block.h>
+#include <gnuradio/blocks/vector_sink.h>
+
+#include "deferred_config.h"
+#include "stream_tagger.h"
+
+static int failures = 0;
+
+#define CHECK( cond ) \
+  do { \
+    if ( !(cond) ) { \
+      std::cerr << __FILE__ << ":" << __LINE__ << ": failed: " #cond << std::endl; \
+      failures++; \
+    } \
+  } while (0)
+
+class tagger_source : public gr::sync_block
+{
+public:
+  /* called before every chunk with the number of samples received so far */
+  typedef std::function< void ( stream_tagger &tagger, uint64_t received ) > script_t;
+
+  tagger_source( uint64_t total, int chunk, const script_t &script )
+    : gr::sync_block( "tagger_source",
+                      gr::io_signature::make( 0, 0, 0 ),
+                      gr::io_signature::make( 1, 1, sizeof(gr_complex) ) ),
+      _total(total),
+      _chunk(chunk),
+      _script(script),
+      _received(0)
+  {
+  }
+
+  int work( int noutput_items,
+            gr_vector_const_void_star &input_items,
+            gr_vector_void_star &output_items )
+  {
+    if ( _received >= _total )
+      return WORK_DONE;
+
+    int n = std::min( noutput_items, _chunk );
+    n = int( std::min< uint64_t >( n, _total - _received ) );
+
+    _script( tagger, _received );
+
+    gr_complex *out = (gr_complex *)output_items[0];
+    for (int i = 0; i < n; i++)
+      out[i] = gr_complex( float( _received + i ), 0 );
+
+    _received += n;
+    tagger.received( n );
+
+    return tagger.process( this, output_items, n );
+  }
+
+  stream_tagger tagger;
+
+private:
+  uint64_t _total;
+  int _chunk;
+  script_t _script;
+  uint64_t _received;
+};
+
+typedef boost::shared_ptr< tagger_source > tagger_source_sptr;
+
+/* the samples passed on, with their tags */
+static std::vector< gr_complex > run( const tagger_source_sptr &src,
+                                      std::vector< gr::tag_t > &tags )
+{
+  gr::top_block_sptr tb = gr::make_top_block( "qa_stream_tagger" );
+  gr::blocks::vector_sink_c::sptr sink = gr::blocks::vector_sink_c::make();
+
+  tb->connect( src, 0, sink, 0 );
+  tb->run();
+
+  tags = sink->tags();
+  return sink->data();
+}
+
+static bool has_tag( const std::vector< gr::tag_t > &tags, uint64_t offset,
+                     const std::string &key )
+{
+  for (const gr::tag_t &tag : tags)
+    if ( tag.offset == offset && pmt::eq( tag.key, pmt::mp( key ) ) )
+      return true;
+
+  return false;
+}
+
+/* a change in the middle of a dwell, e.g. a gain, does not end it */
+static void test_gain_during_dwell()
+{
+  tagger_source_sptr src = gnuradio::get_initial_sptr(
+        new tagger_source( 400, 50, []( stream_tagger &tagger, uint64_t received ) {
+    if ( received == 0 ) {
+      tagger.start_dwells();
+      tagger.set_next_dwell( 100 );
+      tagger.begin_change();
+      tagger.end_change( pmt::mp("rx_freq"), pmt::from_double( 100e6 ) );
+    } else if ( received == 50 ) {
+      tagger.begin_change();
+      tagger.end_change( pmt::mp("rx_gain"), pmt::from_double( 20 ) );
+    }
+  } ) );
+
+  std::vector< gr::tag_t > tags;
+  std::vector< gr_complex > data = run( src, tags );
+
+  CHECK( data.size() == 100 );
+  CHECK( data.size() && data.front().real() == 0 && data.back().real() == 99 );
+  CHECK( src->tagger.dwells_done() == 1 );
+  CHECK( has_tag( tags, 0, "rx_freq" ) );
+  CHECK( has_tag( tags, 50, "rx_gain" ) );
+}
+
+/* a hop schedule set up before the start, the device records the first
+ * hop and replays it in the order of its settings once started */
+static void test_hop_before_start()
+{
+  enum { RATE, FREQ, GAIN };
+  deferred_config config;
+
+  tagger_source_sptr src = gnuradio::get_initial_sptr(
+        new tagger_source( 400, 50, [&config]( stream_tagger &tagger, uint64_t received ) {
+    if ( received != 0 )
+      return;
+
+    config.begin();
+
+    config.defer( RATE, 1e6, [&tagger]( double rate ) {
+      tagger.begin_change();
+      tagger.end_change( pmt::mp("rx_rate"), pmt::from_double( rate ) );
+    } );
+
+    /* the first hop, as issued by the hop scheduler */
+    tagger.start_dwells();
+    config.defer( GAIN, 20, [&tagger]( double gain ) {
+      tagger.begin_change();
+      tagger.end_change( pmt::mp("rx_gain"), pmt::from_double( gain ) );
+    } );
+    tagger.set_next_dwell( 100 );
+    config.defer( FREQ, 100e6, [&tagger]( double freq ) {
+      tagger.begin_change();
+      tagger.end_change( pmt::mp("rx_freq"), pmt::from_double( freq ) );
+    } );
+
+    config.commit(); /* start() */
+  } ) );
+
+  std::vector< gr::tag_t > tags;
+  std::vector< gr_complex > data = run( src, tags );
+
+  CHECK( data.size() == 100 );
+  CHECK( src->tagger.dwells_done() == 1 );
+  CHECK( has_tag( tags, 0, "rx_rate" ) );
+  CHECK( has_tag( tags, 0, "rx_freq" ) );
+  CHECK( has_tag( tags, 0, "rx_gain" ) );
+}
+
+/* a retune scheduled ahead is tagged at its sample, after the changes made
+ * right away in the meantime */
+static void test_scheduled_retune()
+{
+  tagger_source_sptr src = gnuradio::get_initial_sptr(
+        new tagger_source( 200, 50, []( stream_tagger &tagger, uint64_t received ) {
+    if ( received != 0 )
+      return;
+
+    tagger.begin_change();
+    tagger.end_change( pmt::mp("rx_freq"), pmt::from_double( 100e6 ), 100 );
+    tagger.begin_change();
+    tagger.end_change( pmt::mp("rx_gain"), pmt::from_double( 20 ) );
+  } ) );
+
+  std::vector< gr::tag_t > tags;
+  std::vector< gr_complex > data = run( src, tags );
+
+  CHECK( data.size() == 200 );
+  CHECK( has_tag( tags, 0, "rx_gain" ) );
+  CHECK( ! has_tag( tags, 0, "rx_freq" ) );
+  CHECK( has_tag( tags, 100, "rx_freq" ) );
+}
+
+int main()
+{
+  test_gain_during_dwell();
+  test_hop_before_start();
+  test_scheduled_retune();
+
+  if ( failures )
+    std::cerr << failures << " check(s) failed" << std::endl;
+
+  return failures ? 1 : 0;
+}
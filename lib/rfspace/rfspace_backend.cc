@@ -0,0 +1,46 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "backend_registry.h"
+
+#include "rfspace_source_c.h"
+
+static backend_t rfspace_backend( void )
+{
+  backend_t backend( "rfspace", 90 );
+
+  backend.keys.push_back( "rfspace" );
+  backend.keys.push_back( "sdr-iq" );
+  backend.keys.push_back( "sdr-ip" );
+  backend.keys.push_back( "netsdr" );
+  backend.keys.push_back( "cloudiq" );
+
+  backend.make_source = []( const std::string &args,
+                           gr::basic_block_sptr &block,
+                           source_iface *&iface ) {
+    rfspace_source_c_sptr src = make_rfspace_source_c( args );
+    block = src; iface = src.get();
+  };
+  backend.get_source_devices = []( bool fake ) { return rfspace_source_c::get_devices( fake ); };
+
+  return backend;
+}
+
+static backend_registrar registrar( rfspace_backend() );
@@ -47,8 +47,20 @@ using namespace boost::assign;
 #define BUF_LEN  (16 * 32 * 512) /* must be multiple of 512 */
 #define BUF_NUM   15
 #define BUF_SKIP  1 // buffers to skip due to initial garbage
+#define DDC_RATE  2400000 // device rate decimated from by default
+
+/* deferred settings, in the order they are applied to the device */
+enum {
+  CFG_SAMPLE_RATE,
+  CFG_FREQ_CORR,
+  CFG_CENTER_FREQ,
+  CFG_GAIN_MODE,
+  CFG_GAIN,
+  CFG_IF_GAIN
+};
 
 #define BYTES_PER_SAMPLE  2 // rtl device delivers 8 bit unsigned IQ data
+#define SETTLE_TIME 5e-3 // tuner PLL lock and AGC recovery after a change
 
 /*
  * Create a new instance of rtl_source_c and return
@@ -81,9 +93,14 @@ rtl_source_c::rtl_source_c (const std::string &args)
   : gr::sync_block ("rtl_source_c",
         gr::io_signature::make(MIN_IN, MAX_IN, sizeof (gr_complex)),
         gr::io_signature::make(MIN_OUT, MAX_OUT, sizeof (gr_complex))),
+    _stream_type(STREAM_FC32),
     _dev(NULL),
     _buf(NULL),
     _running(false),
+    _ddc_enabled(false),
+    _ddc_rate(DDC_RATE),
+    _ddc_tune(0),
+    _freq_shift(0),
     _no_tuner(false),
     _auto_gain(false),
     _if_gain(0),
@@ -153,11 +170,29 @@ rtl_source_c::rtl_source_c (const std::string &args)
   if (dict.count("bias"))
     bias_tee = boost::lexical_cast<bool>( dict["bias"] );
 
+  _tagger.set_settle_time( SETTLE_TIME );
+
+  if (dict.count("settle"))
+    _tagger.set_settle_time( boost::lexical_cast< double >( dict["settle"] ) );
+
   _buf_num = _buf_len = _buf_head = _buf_used = _buf_offset = 0;
 
   if (dict.count("buffers"))
     _buf_num = boost::lexical_cast< unsigned int >( dict["buffers"] );
 
+  _overflow = stream_tagger::DROP_OLDEST;
+
+  if (dict.count("overflow"))
+    _overflow = stream_tagger::parse_overflow_policy( dict["overflow"] );
+
+  _zeros_pending = 0;
+
+  if (dict.count("ddc"))
+    _ddc_enabled = boost::lexical_cast< bool >( dict["ddc"] );
+
+  if (dict.count("ddc_rate"))
+    _ddc_rate = boost::lexical_cast< double >( dict["ddc_rate"] );
+
   if (dict.count("buflen"))
     _buf_len = boost::lexical_cast< unsigned int >( dict["buflen"] );
 
@@ -172,12 +207,21 @@ rtl_source_c::rtl_source_c (const std::string &args)
               << std::endl;
   }
 
-  _samp_avail = _buf_len / BYTES_PER_SAMPLE;
+  /* the transfer being filled holds the samples not yet received */
+  _tagger.set_latency( _buf_len / BYTES_PER_SAMPLE );
 
   // create a lookup table for gr_complex values
   for (unsigned int i = 0; i < 0x100; i++)
     _lut.push_back((i - 127.4f) / 128.0f);
 
+  /* the smaller magnitude of the two extreme codes */
+  _monitor.set_clip_level( 127.4f / 128.0f );
+
+  if (dict.count("stats"))
+    _monitor.set_interval( dict["stats"] );
+
+  _monitor.attach( this );
+
   _dev = NULL;
   ret = rtlsdr_open( &_dev, dev_index );
   if (ret < 0)
@@ -195,10 +239,6 @@ rtl_source_c::rtl_source_c (const std::string &args)
         str(boost::format("Failed to set xtal frequencies. Error %d.") % ret ));
   }
 
-  ret = rtlsdr_set_sample_rate( _dev, 1024000 );
-  if (ret < 0)
-    throw std::runtime_error("Failed to set default samplerate.");
-
   ret = rtlsdr_set_tuner_gain_mode(_dev, int(!_auto_gain));
   if (ret < 0)
     throw std::runtime_error("Failed to set tuner gain mode.");
@@ -228,13 +268,29 @@ rtl_source_c::rtl_source_c (const std::string &args)
   if (ret < 0)
     throw std::runtime_error("Failed to reset usb buffers.");
 
+  /* the defaults are applied together with the user settings on start */
+  _config.begin();
+
+  set_sample_rate( 1024000 );
+
   set_if_gain( 24 ); /* preset to a reasonable default (non-GRC use case) */
 
   _buf = (unsigned char **)malloc(_buf_num * sizeof(unsigned char *));
 
   if (_buf) {
+    /* the decimated samples of a transfer never outnumber its inputs */
+    size_t size = _buf_len;
+    if (_ddc_enabled)
+      size = _buf_len / BYTES_PER_SAMPLE * sizeof(gr_complex);
+
     for(unsigned int i = 0; i < _buf_num; ++i)
-      _buf[i] = (unsigned char *)malloc(_buf_len);
+      _buf[i] = (unsigned char *)malloc(size);
+
+    _buf_zeros.resize( _buf_num, 0 );
+    _buf_samples.resize( _buf_num, 0 );
+
+    if (_ddc_enabled)
+      _ddc_out.resize( _buf_len / BYTES_PER_SAMPLE );
   }
 }
 
@@ -267,6 +323,10 @@ rtl_source_c::~rtl_source_c ()
 
 bool rtl_source_c::start()
 {
+  _config.commit();
+
+  _tagger.sync_start();
+
   _running = true;
   _thread = gr::thread::thread(_rtlsdr_wait, this);
 
@@ -291,20 +351,55 @@ void rtl_source_c::_rtlsdr_callback(unsigned char *buf, uint32_t len, void *ctx)
 
 void rtl_source_c::rtlsdr_callback(unsigned char *buf, uint32_t len)
 {
+  const osmosdr::time_spec_t arrival = osmosdr::time_spec_t::get_system_time();
+  unsigned int nsamples = len / BYTES_PER_SAMPLE;
+
   if (_skipped < BUF_SKIP) {
+    if (_ddc_enabled)
+      nsamples = _ddc.skip( nsamples );
+
+    /* still counted, the sample index has to follow the device clock */
+    _tagger.received( nsamples, arrival );
+    _tagger.skipped( nsamples );
     _skipped++;
     return;
   }
 
+  if (_ddc_enabled) { /* counted and stored as decimated samples from here on */
+    nsamples = _ddc.process( buf, nsamples, &_ddc_out[0] );
+    buf = (unsigned char *)&_ddc_out[0];
+    len = nsamples * sizeof(gr_complex);
+  }
+
+  _tagger.received( nsamples, arrival );
+
   {
     std::lock_guard<std::mutex> lock( _buf_mutex );
 
+    if (_buf_used == _buf_num && _overflow != stream_tagger::DROP_OLDEST) {
+      std::cerr << "O" << std::flush;
+
+      if (_overflow == stream_tagger::ZERO_FILL) {
+        _zeros_pending += nsamples;
+        _tagger.zero_filled( nsamples );
+      } else {
+        _tagger.lost_newest( nsamples );
+      }
+
+      return;
+    }
+
     int buf_tail = (_buf_head + _buf_used) % _buf_num;
+    const unsigned int lost = _buf_samples[buf_tail];
     memcpy(_buf[buf_tail], buf, len);
+    _buf_samples[buf_tail] = nsamples;
+    _buf_zeros[buf_tail] = _zeros_pending;
+    _zeros_pending = 0;
 
     if (_buf_used == _buf_num) {
       std::cerr << "O" << std::flush;
       _buf_head = (_buf_head + 1) % _buf_num;
+      _tagger.lost_oldest( lost );
     } else {
       _buf_used++;
     }
@@ -334,7 +429,8 @@ int rtl_source_c::work( int noutput_items,
                         gr_vector_const_void_star &input_items,
                         gr_vector_void_star &output_items )
 {
-  gr_complex *out = (gr_complex *)output_items[0];
+  const size_t itemsize = stream_item_size( _stream_type );
+  char *out = (char *)output_items[0];
 
   {
     std::unique_lock<std::mutex> lock( _buf_mutex );
@@ -347,30 +443,90 @@ int rtl_source_c::work( int noutput_items,
     return WORK_DONE;
 
   while (noutput_items && _buf_used) {
-    const int nout = std::min(noutput_items, _samp_avail);
-    const unsigned char *buf = _buf[_buf_head] + _buf_offset * 2;
+    if (_buf_zeros[_buf_head]) { /* in place of the samples lost before it */
+      const int nzeros = std::min(uint64_t(noutput_items), _buf_zeros[_buf_head]);
+
+      std::fill(out, out + nzeros * itemsize, 0);
+      out += nzeros * itemsize;
+      noutput_items -= nzeros;
+      _buf_zeros[_buf_head] -= nzeros;
+      continue;
+    }
 
-    for (int i = 0; i < nout; ++i)
-      *out++ = gr_complex(_lut[buf[i * 2]], _lut[buf[i * 2 + 1]]);
+    const unsigned int samp_avail = _buf_samples[_buf_head] > _buf_offset ?
+                                    _buf_samples[_buf_head] - _buf_offset : 0;
+    const int nout = std::min(noutput_items, int(samp_avail));
+
+    if (_ddc_enabled) {
+      const gr_complex *buf = (const gr_complex *)_buf[_buf_head] + _buf_offset;
+      memcpy(out, buf, nout * sizeof(gr_complex));
+    } else if (_stream_type == STREAM_SC8) { /* re-centred, the offset binary msb flipped */
+      const unsigned char *buf = _buf[_buf_head] + _buf_offset * 2;
+      int8_t *sc8 = (int8_t *)out;
+      for (int i = 0; i < nout * 2; ++i)
+        sc8[i] = int8_t(buf[i] ^ 0x80);
+    } else {
+      const unsigned char *buf = _buf[_buf_head] + _buf_offset * 2;
+      gr_complex *fc32 = (gr_complex *)out;
+      for (int i = 0; i < nout; ++i)
+        fc32[i] = gr_complex(_lut[buf[i * 2]], _lut[buf[i * 2 + 1]]);
+    }
+    out += nout * itemsize;
 
     noutput_items -= nout;
-    _samp_avail -= nout;
 
-    if (!_samp_avail) {
+    if (nout == int(samp_avail)) {
       {
         std::lock_guard<std::mutex> lock( _buf_mutex );
 
         _buf_head = (_buf_head + 1) % _buf_num;
         _buf_used--;
       }
-      _samp_avail = _buf_len / BYTES_PER_SAMPLE;
       _buf_offset = 0;
     } else {
       _buf_offset += nout;
     }
   }
 
-  return (out - ((gr_complex *)output_items[0]));
+  int nitems = _tagger.process( this, output_items,
+                                (out - (char *)output_items[0]) / itemsize, itemsize );
+
+  /* still in cache from the conversion above, measured before correction */
+  if (_monitor.enabled()) {
+    if (_stream_type == STREAM_FC32)
+      _monitor.process( 0, (const gr_complex *)output_items[0], nitems );
+    else
+      _monitor.process( 0, (const int8_t *)output_items[0], nitems );
+  }
+
+  if (_stream_type == STREAM_FC32)
+    _corrector.process( (gr_complex *)output_items[0], nitems );
+
+  /* shifted after the correction, which takes out the dc of the tuner */
+  if (_stream_type == STREAM_FC32 && !_ddc_enabled)
+    _nco.process( (gr_complex *)output_items[0], (gr_complex *)output_items[0], nitems );
+
+  return nitems;
+}
+
+stream_tagger *rtl_source_c::get_stream_tagger()
+{
+  return &_tagger;
+}
+
+void rtl_source_c::begin_config()
+{
+  _config.begin();
+}
+
+void rtl_source_c::commit_config()
+{
+  _config.commit();
+}
+
+unsigned int rtl_source_c::get_config_generation()
+{
+  return _config.generation();
 }
 
 std::vector<std::string> rtl_source_c::get_devices()
@@ -416,29 +572,55 @@ size_t rtl_source_c::get_num_channels()
 
 osmosdr::meta_range_t rtl_source_c::get_sample_rates()
 {
-  osmosdr::meta_range_t range;
-
-  range += osmosdr::range_t( 250000 ); // known to work
-  range += osmosdr::range_t( 1000000 ); // known to work
-  range += osmosdr::range_t( 1024000 ); // known to work
-  range += osmosdr::range_t( 1800000 ); // known to work
-  range += osmosdr::range_t( 1920000 ); // known to work
-  range += osmosdr::range_t( 2000000 ); // known to work
-  range += osmosdr::range_t( 2048000 ); // known to work
-  range += osmosdr::range_t( 2400000 ); // known to work
-  range += osmosdr::range_t( 2560000 ); // known to work
-//  range += osmosdr::range_t( 2600000 ); // may work
-//  range += osmosdr::range_t( 2800000 ); // may work
-//  range += osmosdr::range_t( 3000000 ); // may work
-//  range += osmosdr::range_t( 3200000 ); // max rate
+  osmosdr::meta_range_t range, known;
+
+  known += osmosdr::range_t( 250000 ); // known to work
+  known += osmosdr::range_t( 1000000 ); // known to work
+  known += osmosdr::range_t( 1024000 ); // known to work
+  known += osmosdr::range_t( 1800000 ); // known to work
+  known += osmosdr::range_t( 1920000 ); // known to work
+  known += osmosdr::range_t( 2000000 ); // known to work
+  known += osmosdr::range_t( 2048000 ); // known to work
+  known += osmosdr::range_t( 2400000 ); // known to work
+  known += osmosdr::range_t( 2560000 ); // known to work
+//  known += osmosdr::range_t( 2600000 ); // may work
+//  known += osmosdr::range_t( 2800000 ); // may work
+//  known += osmosdr::range_t( 3000000 ); // may work
+//  known += osmosdr::range_t( 3200000 ); // max rate
+
+  if (!_ddc_enabled)
+    return known;
+
+  /* anything up to the ddc rate, the device rates above it pass through */
+  range += osmosdr::range_t( _ddc_rate / DDC_MAX_DECIMATION, _ddc_rate );
+
+  for (const osmosdr::range_t &r : known)
+    if (r.start() > _ddc_rate)
+      range += r;
 
   return range;
 }
 
 double rtl_source_c::set_sample_rate(double rate)
 {
+  if ( _config.defer( CFG_SAMPLE_RATE, rate,
+                      [this]( double v ) { set_sample_rate( v ); } ) )
+    return rate;
+
   if (_dev) {
-    rtlsdr_set_sample_rate( _dev, (uint32_t)rate );
+    _tagger.begin_change();
+    if (_ddc_enabled) {
+      rtlsdr_set_sample_rate( _dev, (uint32_t)std::max( rate, _ddc_rate ) );
+      double in = rtlsdr_get_sample_rate( _dev );
+      double out = _ddc.set_rates( in, rate );
+      _tagger.set_latency( _buf_len / BYTES_PER_SAMPLE * out / in );
+    } else {
+      rtlsdr_set_sample_rate( _dev, (uint32_t)rate );
+    }
+    _tagger.set_sample_rate( get_sample_rate() );
+    _monitor.set_rate( get_sample_rate() );
+    _nco.set_rate( get_sample_rate() );
+    _tagger.end_change( pmt::mp("rx_rate"), pmt::from_double( get_sample_rate() ) );
   }
 
   return get_sample_rate();
@@ -446,6 +628,13 @@ double rtl_source_c::set_sample_rate(double rate)
 
 double rtl_source_c::get_sample_rate()
 {
+  double rate;
+  if ( _config.pending( CFG_SAMPLE_RATE, rate ) )
+    return rate;
+
+  if (_dev && _ddc_enabled)
+    return _ddc.output_rate();
+
   if (_dev)
     return (double)rtlsdr_get_sample_rate( _dev );
 
@@ -488,14 +677,32 @@ osmosdr::freq_range_t rtl_source_c::get_freq_range( size_t chan )
 
 double rtl_source_c::set_center_freq( double freq, size_t chan )
 {
-  if (_dev)
+  if ( _config.defer( CFG_CENTER_FREQ, freq,
+                      [this, chan]( double v ) { set_center_freq( v, chan ); } ) )
+    return freq;
+
+  if (_dev) {
+    _tagger.begin_change();
     rtlsdr_set_center_freq( _dev, (uint32_t)freq );
+    if (_ddc_enabled) { /* the nco takes the fraction of a Hz the tuner can't */
+      _ddc_tune = freq - (double)rtlsdr_get_center_freq( _dev );
+      _ddc.set_shift( _ddc_tune + _freq_shift );
+    }
+    _tagger.end_change( pmt::mp("rx_freq"), pmt::from_double( get_center_freq( chan ) ) );
+  }
 
   return get_center_freq( chan );
 }
 
 double rtl_source_c::get_center_freq( size_t chan )
 {
+  double freq;
+  if ( _config.pending( CFG_CENTER_FREQ, freq ) )
+    return freq;
+
+  if (_dev && _ddc_enabled)
+    return (double)rtlsdr_get_center_freq( _dev ) + _ddc_tune;
+
   if (_dev)
     return (double)rtlsdr_get_center_freq( _dev );
 
@@ -504,6 +711,10 @@ double rtl_source_c::get_center_freq( size_t chan )
 
 double rtl_source_c::set_freq_corr( double ppm, size_t chan )
 {
+  if ( _config.defer( CFG_FREQ_CORR, ppm,
+                      [this, chan]( double v ) { set_freq_corr( v, chan ); } ) )
+    return ppm;
+
   if ( _dev )
     rtlsdr_set_freq_correction( _dev, (int)ppm );
 
@@ -512,6 +723,10 @@ double rtl_source_c::set_freq_corr( double ppm, size_t chan )
 
 double rtl_source_c::get_freq_corr( size_t chan )
 {
+  double ppm;
+  if ( _config.pending( CFG_FREQ_CORR, ppm ) )
+    return ppm;
+
   if ( _dev )
     return (double)rtlsdr_get_freq_correction( _dev );
 
@@ -535,20 +750,19 @@ std::vector<std::string> rtl_source_c::get_gain_names( size_t chan )
 
 osmosdr::gain_range_t rtl_source_c::get_gain_range( size_t chan )
 {
-  osmosdr::gain_range_t range;
-
-  if (_dev) {
+  /* set_gain() asks for the range on every call, so query the tuner once */
+  if (_dev && _gain_range.empty()) {
     int count = rtlsdr_get_tuner_gains(_dev, NULL);
     if (count > 0) {
       int* gains = new int[ count ];
       count = rtlsdr_get_tuner_gains(_dev, gains);
       for (int i = 0; i < count; i++)
-        range += osmosdr::range_t( gains[i] / 10.0 );
+        _gain_range += osmosdr::range_t( gains[i] / 10.0 );
       delete[] gains;
     }
   }
 
-  return range;
+  return _gain_range;
 }
 
 osmosdr::gain_range_t rtl_source_c::get_gain_range( const std::string & name, size_t chan )
@@ -568,6 +782,10 @@ osmosdr::gain_range_t rtl_source_c::get_gain_range( const std::string & name, si
 
 bool rtl_source_c::set_gain_mode( bool automatic, size_t chan )
 {
+  if ( _config.defer( CFG_GAIN_MODE, automatic,
+                      [this, chan]( double v ) { set_gain_mode( v != 0, chan ); } ) )
+    return automatic;
+
   if (_dev) {
     if (!rtlsdr_set_tuner_gain_mode(_dev, int(!automatic))) {
       _auto_gain = automatic;
@@ -581,15 +799,25 @@ bool rtl_source_c::set_gain_mode( bool automatic, size_t chan )
 
 bool rtl_source_c::get_gain_mode( size_t chan )
 {
+  double automatic;
+  if ( _config.pending( CFG_GAIN_MODE, automatic ) )
+    return automatic != 0;
+
   return _auto_gain;
 }
 
 double rtl_source_c::set_gain( double gain, size_t chan )
 {
+  if ( _config.defer( CFG_GAIN, gain,
+                      [this, chan]( double v ) { set_gain( v, chan ); } ) )
+    return gain;
+
   osmosdr::gain_range_t rf_gains = rtl_source_c::get_gain_range( chan );
 
   if (_dev) {
+    _tagger.begin_change();
     rtlsdr_set_tuner_gain( _dev, int(rf_gains.clip(gain) * 10.0) );
+    _tagger.end_change( pmt::mp("rx_gain"), pmt::from_double( get_gain( chan ) ) );
   }
 
   return get_gain( chan );
@@ -606,6 +834,10 @@ double rtl_source_c::set_gain( double gain, const std::string & name, size_t cha
 
 double rtl_source_c::get_gain( size_t chan )
 {
+  double gain;
+  if ( _config.pending( CFG_GAIN, gain ) )
+    return gain;
+
   if ( _dev )
     return ((double)rtlsdr_get_tuner_gain( _dev )) / 10.0;
 
@@ -615,6 +847,10 @@ double rtl_source_c::get_gain( size_t chan )
 double rtl_source_c::get_gain( const std::string & name, size_t chan )
 {
   if ( "IF" == name ) {
+    double gain;
+    if ( _config.pending( CFG_IF_GAIN, gain ) )
+      return gain;
+
     return _if_gain;
   }
 
@@ -623,6 +859,10 @@ double rtl_source_c::get_gain( const std::string & name, size_t chan )
 
 double rtl_source_c::set_if_gain(double gain, size_t chan)
 {
+  if ( _config.defer( CFG_IF_GAIN, gain,
+                      [this, chan]( double v ) { set_if_gain( v, chan ); } ) )
+    return gain;
+
   if ( _dev ) {
     if ( rtlsdr_get_tuner_type(_dev) != RTLSDR_TUNER_E4000 ) {
       _if_gain = 0;
@@ -677,9 +917,11 @@ double rtl_source_c::set_if_gain(double gain, size_t chan)
   std::cerr << " = " << sum << std::endl;
 #endif
   if (_dev) {
+    _tagger.begin_change();
     for (unsigned int stage = 1; stage <= gains.size(); stage++) {
       rtlsdr_set_tuner_if_gain( _dev, stage, int(gains[ stage ] * 10.0));
     }
+    _tagger.end_change( pmt::mp("rx_gain"), pmt::cons( pmt::mp("IF"), pmt::from_double( gain ) ) );
   }
 
   _if_gain = gain;
@@ -704,3 +946,64 @@ std::string rtl_source_c::get_antenna( size_t chan )
 {
   return "RX";
 }
+
+void rtl_source_c::set_dc_offset_mode( int mode, size_t chan )
+{
+  _corrector.set_dc_offset_mode( mode );
+}
+
+void rtl_source_c::set_dc_offset( const std::complex<double> &offset, size_t chan )
+{
+  _corrector.set_dc_offset( offset );
+}
+
+void rtl_source_c::set_iq_balance_mode( int mode, size_t chan )
+{
+  _corrector.set_iq_balance_mode( mode );
+}
+
+void rtl_source_c::set_iq_balance( const std::complex<double> &balance, size_t chan )
+{
+  _corrector.set_iq_balance( balance );
+}
+
+iq_corrector *rtl_source_c::get_iq_corrector()
+{
+  return &_corrector;
+}
+
+signal_monitor *rtl_source_c::get_signal_monitor()
+{
+  return &_monitor;
+}
+
+bool rtl_source_c::set_freq_shift( double freq, size_t chan )
+{
+  if ( _stream_type != STREAM_FC32 )
+    return false;
+
+  _freq_shift = freq;
+
+  if ( _ddc_enabled ) {
+    _ddc.set_shift( _ddc_tune + _freq_shift );
+  } else {
+    _nco.set_rate( get_sample_rate() );
+    _nco.set_shift( _freq_shift );
+  }
+
+  return true;
+}
+
+bool rtl_source_c::set_stream_type( stream_type_t type )
+{
+  if ( type != STREAM_FC32 && type != STREAM_SC8 )
+    return false;
+
+  if ( type != STREAM_FC32 && _ddc_enabled ) /* decimated as floats */
+    return false;
+
+  _stream_type = type;
+  set_output_signature( gr::io_signature::make(MIN_OUT, MAX_OUT, stream_item_size( type )) );
+
+  return true;
+}
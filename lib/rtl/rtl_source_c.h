@@ -30,6 +30,12 @@
 #include <condition_variable>
 
 #include "source_iface.h"
+#include "stream_tagger.h"
+#include "deferred_config.h"
+#include "iq_corrector.h"
+#include "signal_monitor.h"
+#include "ddc.h"
+#include "nco.h"
 
 class rtl_source_c;
 typedef struct rtlsdr_dev rtlsdr_dev_t;
@@ -113,6 +119,22 @@ public:
   std::string set_antenna( const std::string & antenna, size_t chan = 0 );
   std::string get_antenna( size_t chan = 0 );
 
+  void set_dc_offset_mode( int mode, size_t chan = 0 );
+  void set_dc_offset( const std::complex<double> &offset, size_t chan = 0 );
+
+  void set_iq_balance_mode( int mode, size_t chan = 0 );
+  void set_iq_balance( const std::complex<double> &balance, size_t chan = 0 );
+
+  stream_tagger *get_stream_tagger( void );
+  iq_corrector *get_iq_corrector( void );
+  signal_monitor *get_signal_monitor( void );
+  bool set_freq_shift( double freq, size_t chan = 0 );
+  bool set_stream_type( stream_type_t type );
+
+  void begin_config( void );
+  void commit_config( void );
+  unsigned int get_config_generation( void );
+
 protected:
   bool start();
   bool stop();
@@ -124,8 +146,13 @@ private:
   void rtlsdr_wait();
 
   std::vector<float> _lut;
+  stream_type_t _stream_type; /* fc32 or sc8 */
 
   rtlsdr_dev_t *_dev;
+  stream_tagger _tagger;
+  deferred_config _config;
+  iq_corrector _corrector;
+  signal_monitor _monitor;
   gr::thread::thread _thread;
   unsigned char **_buf;
   unsigned int _buf_num;
@@ -136,13 +163,27 @@ private:
   std::condition_variable _buf_cond;
   bool _running;
 
+  stream_tagger::overflow_policy _overflow;
+  std::vector<uint64_t> _buf_zeros; /* to put out before each buffer */
+  uint64_t _zeros_pending; /* for the next buffer received */
+
+  std::vector<unsigned int> _buf_samples; /* held by each buffer */
   unsigned int _buf_offset;
-  int _samp_avail;
+
+  bool _ddc_enabled; /* the buffers hold decimated gr_complex samples */
+  double _ddc_rate;
+  ddc _ddc;
+  double _ddc_tune; /* the part of the ddc shift completing the tuning */
+  double _freq_shift;
+  nco _nco; /* the shift without the ddc */
+  std::vector<gr_complex> _ddc_out;
 
   bool _no_tuner;
   bool _auto_gain;
   double _if_gain;
   unsigned int _skipped;
+
+  osmosdr::gain_range_t _gain_range; /* tuner gain steps, fixed per device */
 };
 
 #endif /* INCLUDED_RTLSDR_SOURCE_C_H */
@@ -334,6 +334,14 @@ rtl_tcp_source_c::~rtl_tcp_source_c()
 }
 
 
+bool rtl_tcp_source_c::start()
+{
+  /* the server streams since connecting, samples before the epoch are dropped */
+  _tagger.sync_start();
+
+  return true;
+}
+
 int rtl_tcp_source_c::work(int noutput_items,
 			   gr_vector_const_void_star &input_items,
 			   gr_vector_void_star &output_items)
@@ -353,10 +361,17 @@ int rtl_tcp_source_c::work(int noutput_items,
     index += receivedbytes;
   }
 
+  /* the network adds its own jitter, the filter takes care of it */
+  _tagger.received(noutput_items, osmosdr::time_spec_t::get_system_time());
+
   for (int i = 0; i < noutput_items; i++)
     out[i] = gr_complex(d_LUT[d_temp_buff[i * 2]], d_LUT[d_temp_buff[i * 2 + 1]]);
 
-  return noutput_items;
+  int nitems = _tagger.process(this, output_items, noutput_items);
+
+  _corrector.process(out, nitems);
+
+  return nitems;
 }
 
 std::string rtl_tcp_source_c::name()
@@ -407,9 +422,13 @@ osmosdr::meta_range_t rtl_tcp_source_c::get_sample_rates( void )
 double rtl_tcp_source_c::set_sample_rate( double rate )
 {
   struct command cmd = { 0x02, htonl(rate) };
+
+  _tagger.begin_change();
   send(d_socket, (const char*)&cmd, sizeof(cmd), 0);
 
   _rate = rate;
+  _tagger.set_sample_rate(rate);
+  _tagger.end_change(pmt::mp("rx_rate"), pmt::from_double(rate));
 
   return get_sample_rate();
 }
@@ -456,9 +475,12 @@ osmosdr::freq_range_t rtl_tcp_source_c::get_freq_range( size_t chan )
 double rtl_tcp_source_c::set_center_freq( double freq, size_t chan )
 {
   struct command cmd = { 0x01, htonl(freq) };
+
+  _tagger.begin_change();
   send(d_socket, (const char*)&cmd, sizeof(cmd), 0);
 
   _freq = freq;
+  _tagger.end_change(pmt::mp("rx_freq"), pmt::from_double(freq));
 
   return get_center_freq(chan);
 }
@@ -697,3 +719,33 @@ std::string rtl_tcp_source_c::get_antenna( size_t chan )
 {
   return "RX";
 }
+
+void rtl_tcp_source_c::set_dc_offset_mode( int mode, size_t chan )
+{
+  _corrector.set_dc_offset_mode( mode );
+}
+
+void rtl_tcp_source_c::set_dc_offset( const std::complex<double> &offset, size_t chan )
+{
+  _corrector.set_dc_offset( offset );
+}
+
+void rtl_tcp_source_c::set_iq_balance_mode( int mode, size_t chan )
+{
+  _corrector.set_iq_balance_mode( mode );
+}
+
+void rtl_tcp_source_c::set_iq_balance( const std::complex<double> &balance, size_t chan )
+{
+  _corrector.set_iq_balance( balance );
+}
+
+iq_corrector *rtl_tcp_source_c::get_iq_corrector()
+{
+  return &_corrector;
+}
+
+stream_tagger *rtl_tcp_source_c::get_stream_tagger()
+{
+  return &_tagger;
+}
@@ -23,6 +23,8 @@
 #include <gnuradio/sync_block.h>
 
 #include "source_iface.h"
+#include "iq_corrector.h"
+#include "stream_tagger.h"
 
 class rtl_tcp_source_c;
 
@@ -54,6 +56,8 @@ private:
 public:
   ~rtl_tcp_source_c();
 
+  bool start();
+
   int work(int noutput_items,
 	   gr_vector_const_void_star &input_items,
 	   gr_vector_void_star &output_items);
@@ -90,6 +94,15 @@ public:
   std::string set_antenna( const std::string & antenna, size_t chan = 0 );
   std::string get_antenna( size_t chan = 0 );
 
+  void set_dc_offset_mode( int mode, size_t chan = 0 );
+  void set_dc_offset( const std::complex<double> &offset, size_t chan = 0 );
+
+  void set_iq_balance_mode( int mode, size_t chan = 0 );
+  void set_iq_balance( const std::complex<double> &balance, size_t chan = 0 );
+
+  iq_corrector *get_iq_corrector( void );
+  stream_tagger *get_stream_tagger( void );
+
 private:
   int d_socket;		  // handle to socket
   double _freq, _rate, _gain, _corr;
@@ -102,6 +115,8 @@ private:
   unsigned int d_tuner_if_gain_count;
   unsigned char *d_temp_buff; // hold buffer between calls
   float *d_LUT;
+  iq_corrector _corrector;
+  stream_tagger _tagger;
 };
 
 #endif // RTL_TCP_SOURCE_C_H
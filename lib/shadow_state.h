@@ -0,0 +1,153 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef OSMOSDR_SHADOW_STATE_H
+#define OSMOSDR_SHADOW_STATE_H
+
+#include <map>
+#include <mutex>
+
+/*
+ * Last value reported by a device for one of its settings. Getters are
+ * served from here, setters store the value the device returned, and any
+ * change that may have altered the setting on the device invalidates it.
+ *
+ * A fetch racing with set() or invalidate() does not overwrite the newer
+ * state, its result is returned to the caller but not cached.
+ */
+template< typename T >
+class shadow_value
+{
+public:
+  shadow_value() : _valid(false), _generation(0) {}
+
+  shadow_value( const shadow_value &other ) : _generation(0)
+  {
+    std::lock_guard< std::mutex > lock( other._mutex );
+    _value = other._value;
+    _valid = other._valid;
+  }
+
+  shadow_value &operator=( const shadow_value &other ) = delete;
+
+  /* the cached value, or the result of fetch() which is then cached */
+  template< typename F >
+  T get( F fetch )
+  {
+    unsigned int generation;
+    {
+      std::lock_guard< std::mutex > lock( _mutex );
+      if ( _valid )
+        return _value;
+      generation = _generation;
+    }
+
+    T value = fetch();
+
+    std::lock_guard< std::mutex > lock( _mutex );
+    if ( generation == _generation ) {
+      _value = value;
+      _valid = true;
+    }
+
+    return value;
+  }
+
+  T set( const T &value )
+  {
+    std::lock_guard< std::mutex > lock( _mutex );
+    _value = value;
+    _valid = true;
+    _generation++;
+    return value;
+  }
+
+  void invalidate()
+  {
+    std::lock_guard< std::mutex > lock( _mutex );
+    _valid = false;
+    _generation++;
+  }
+
+private:
+  mutable std::mutex _mutex;
+  T _value;
+  bool _valid;
+  unsigned int _generation;
+};
+
+/* the same for settings addressed by name, e.g. individual gain stages */
+template< typename K, typename T >
+class shadow_map
+{
+public:
+  shadow_map() : _generation(0) {}
+
+  shadow_map( const shadow_map &other ) : _generation(0)
+  {
+    std::lock_guard< std::mutex > lock( other._mutex );
+    _values = other._values;
+  }
+
+  shadow_map &operator=( const shadow_map &other ) = delete;
+
+  template< typename F >
+  T get( const K &key, F fetch )
+  {
+    unsigned int generation;
+    {
+      std::lock_guard< std::mutex > lock( _mutex );
+      typename std::map< K, T >::const_iterator it = _values.find( key );
+      if ( it != _values.end() )
+        return it->second;
+      generation = _generation;
+    }
+
+    T value = fetch();
+
+    std::lock_guard< std::mutex > lock( _mutex );
+    if ( generation == _generation )
+      _values[ key ] = value;
+
+    return value;
+  }
+
+  T set( const K &key, const T &value )
+  {
+    std::lock_guard< std::mutex > lock( _mutex );
+    _values[ key ] = value;
+    _generation++;
+    return value;
+  }
+
+  void invalidate()
+  {
+    std::lock_guard< std::mutex > lock( _mutex );
+    _values.clear();
+    _generation++;
+  }
+
+private:
+  mutable std::mutex _mutex;
+  std::map< K, T > _values;
+  unsigned int _generation;
+};
+
+#endif // OSMOSDR_SHADOW_STATE_H
@@ -0,0 +1,205 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "signal_monitor.h"
+
+#define DEFAULT_CLIP_LEVEL 1.0f
+
+static double to_dbfs( double power )
+{
+  return 10.0 * std::log10( power );
+}
+
+signal_monitor::signal_monitor()
+  : _block(NULL),
+    _interval(0),
+    _rate(0),
+    _clip_level(DEFAULT_CLIP_LEVEL),
+    _first_chan(0),
+    _sums(1, sums_t()),
+    _stats(1)
+{
+}
+
+void signal_monitor::attach( gr::basic_block *block )
+{
+  _block = block;
+  _block->message_port_register_out( pmt::mp("signal_stats") );
+}
+
+void signal_monitor::set_num_channels( size_t nchan )
+{
+  std::lock_guard< std::mutex > lock( _mutex );
+
+  _sums.assign( nchan, sums_t() );
+  _stats.assign( nchan, osmosdr::signal_stats_t() );
+}
+
+void signal_monitor::set_interval( const std::string &value )
+{
+  double interval = -1;
+
+  try {
+    interval = std::stod( value );
+  } catch ( std::exception & ) {
+  }
+
+  if ( ! (interval >= 0) )
+    throw std::runtime_error( "Invalid stats interval '" + value +
+                              "', expected a number of seconds." );
+
+  _interval = interval;
+}
+
+void signal_monitor::set_rate( double rate )
+{
+  std::lock_guard< std::mutex > lock( _mutex );
+  _rate = rate;
+}
+
+void signal_monitor::set_clip_level( float level )
+{
+  _clip_level = level;
+}
+
+void signal_monitor::set_first_channel( size_t chan )
+{
+  _first_chan = chan;
+}
+
+void signal_monitor::process( size_t chan, const gr_complex *in, size_t nitems )
+{
+  float i = 0, q = 0, power = 0, peak = 0;
+  uint64_t clipped = 0;
+
+  for (size_t n = 0; n < nitems; n++) {
+    const float re = in[n].real(), im = in[n].imag();
+    const float p = re * re + im * im;
+
+    i += re;
+    q += im;
+    power += p;
+    peak = std::max( peak, p );
+    clipped += std::fabs( re ) >= _clip_level || std::fabs( im ) >= _clip_level;
+  }
+
+  add( chan, i, q, power, peak, nitems, clipped );
+}
+
+void signal_monitor::process( size_t chan, const int8_t *in, size_t nitems )
+{
+  int32_t i = 0, q = 0, peak = 0;
+  int64_t power = 0;
+  uint64_t clipped = 0;
+
+  for (size_t n = 0; n < nitems; n++) {
+    const int32_t re = in[n * 2], im = in[n * 2 + 1];
+    const int32_t p = re * re + im * im;
+
+    i += re;
+    q += im;
+    power += p;
+    peak = std::max( peak, p );
+    clipped += re == -128 || re == 127 || im == -128 || im == 127;
+  }
+
+  const float scale = 1.0f / 128.0f;
+  add( chan, i * scale, q * scale, power * scale * scale, peak * scale * scale,
+       nitems, clipped );
+}
+
+void signal_monitor::process( size_t chan, const int16_t *in, size_t nitems,
+                              int16_t full_scale, size_t stride )
+{
+  int64_t i = 0, q = 0, power = 0, peak = 0;
+  uint64_t clipped = 0;
+
+  for (size_t n = 0; n < nitems; n++) {
+    const int64_t re = in[n * stride * 2], im = in[n * stride * 2 + 1];
+    const int64_t p = re * re + im * im;
+
+    i += re;
+    q += im;
+    power += p;
+    peak = std::max( peak, p );
+    clipped += re <= -full_scale || re >= full_scale - 1 ||
+               im <= -full_scale || im >= full_scale - 1;
+  }
+
+  const float scale = 1.0f / full_scale;
+  add( chan, i * scale, q * scale, power * scale * scale, peak * scale * scale,
+       nitems, clipped );
+}
+
+osmosdr::signal_stats_t signal_monitor::stats( size_t chan )
+{
+  std::lock_guard< std::mutex > lock( _mutex );
+
+  if ( chan >= _stats.size() )
+    return osmosdr::signal_stats_t();
+
+  return _stats[chan];
+}
+
+void signal_monitor::add( size_t chan, float i, float q, float power, float peak,
+                          size_t nitems, uint64_t clipped )
+{
+  std::unique_lock< std::mutex > lock( _mutex );
+
+  sums_t &sums = _sums[chan];
+  sums.samples += nitems;
+  sums.clipped += clipped;
+  sums.i += i;
+  sums.q += q;
+  sums.power += power;
+  sums.peak = std::max( sums.peak, peak );
+
+  if ( ! sums.samples || _rate <= 0 || sums.samples < _interval * _rate )
+    return;
+
+  osmosdr::signal_stats_t &stats = _stats[chan];
+  stats.samples = sums.samples;
+  stats.clipped = sums.clipped;
+  stats.mean = std::complex< double >( sums.i / sums.samples, sums.q / sums.samples );
+  stats.power = to_dbfs( sums.power / sums.samples );
+  stats.peak = to_dbfs( sums.peak );
+
+  sums = sums_t();
+
+  const osmosdr::signal_stats_t last = stats;
+  lock.unlock();
+
+  if ( ! _block )
+    return;
+
+  pmt::pmt_t msg = pmt::make_dict();
+  msg = pmt::dict_add( msg, pmt::mp("chan"), pmt::from_uint64( _first_chan + chan ) );
+  msg = pmt::dict_add( msg, pmt::mp("samples"), pmt::from_uint64( last.samples ) );
+  msg = pmt::dict_add( msg, pmt::mp("clipped"), pmt::from_uint64( last.clipped ) );
+  msg = pmt::dict_add( msg, pmt::mp("mean"), pmt::from_complex( last.mean ) );
+  msg = pmt::dict_add( msg, pmt::mp("power"), pmt::from_double( last.power ) );
+  msg = pmt::dict_add( msg, pmt::mp("peak"), pmt::from_double( last.peak ) );
+
+  _block->message_port_pub( pmt::mp("signal_stats"), msg );
+}
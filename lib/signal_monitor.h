@@ -0,0 +1,102 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef OSMOSDR_SIGNAL_MONITOR_H
+#define OSMOSDR_SIGNAL_MONITOR_H
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+#include <osmosdr/api.h>
+#include <gnuradio/basic_block.h>
+#include <gnuradio/gr_complex.h>
+
+#include <osmosdr/settings.h>
+
+/*
+ * Signal statistics of a source backend, gathered from the samples while
+ * they are still in the cache after the conversion.
+ *
+ * Enabled by the stats=<seconds> device argument, the sums of each channel
+ * are turned into a signal_stats_t every interval, which is kept for
+ * stats() and published as a dict on the signal_stats message port of the
+ * block the monitor is attached to.
+ */
+class OSMOSDR_API signal_monitor
+{
+public:
+  signal_monitor();
+
+  /* registers the signal_stats port, from the backend constructor */
+  void attach( gr::basic_block *block );
+
+  void set_num_channels( size_t nchan );
+  void set_interval( const std::string &value );
+  bool enabled( void ) const { return _interval > 0; }
+
+  void set_rate( double rate );
+
+  /* I or Q at or above this magnitude counts as clipped, for fc32 */
+  void set_clip_level( float level );
+
+  /* the number of the first channel in the published messages */
+  void set_first_channel( size_t chan );
+
+  void process( size_t chan, const gr_complex *in, size_t nitems );
+
+  /* interleaved sc8 samples */
+  void process( size_t chan, const int8_t *in, size_t nitems );
+
+  /* interleaved sc16 samples from -full_scale to full_scale - 1, every
+   * stride'th one belongs to the channel */
+  void process( size_t chan, const int16_t *in, size_t nitems,
+                int16_t full_scale, size_t stride = 1 );
+
+  /* of the last complete interval */
+  osmosdr::signal_stats_t stats( size_t chan );
+
+private:
+  struct sums_t
+  {
+    uint64_t samples;
+    uint64_t clipped;
+    double i;
+    double q;
+    double power;
+    float peak;
+  };
+
+  void add( size_t chan, float i, float q, float power, float peak,
+            size_t nitems, uint64_t clipped );
+
+  gr::basic_block *_block;
+  double _interval;
+  double _rate;
+  float _clip_level;
+  size_t _first_chan;
+
+  std::mutex _mutex;
+  std::vector< sums_t > _sums;
+  std::vector< osmosdr::signal_stats_t > _stats;
+};
+
+#endif // OSMOSDR_SIGNAL_MONITOR_H
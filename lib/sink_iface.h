@@ -25,6 +25,10 @@
 #include <osmosdr/time_spec.h>
 #include <gnuradio/basic_block.h>
 
+#include "stream_type.h"
+
+class tx_monitor;
+
 /*!
  * TODO: document
  *
@@ -363,6 +367,48 @@ public:
    * \param time_spec the new time
    */
   virtual void set_time_unknown_pps(const ::osmosdr::time_spec_t &time_spec) { }
+
+  /*!
+   * Set the device time at which the following control calls take effect.
+   * \param time_spec the time the commands take effect at
+   * \param mboard the motherboard index 0 to M-1
+   * \return false if the device has no timed commands, the caller has to
+   * wait for the time itself then
+   */
+  virtual bool set_command_time(const ::osmosdr::time_spec_t &time_spec,
+                                size_t mboard = 0) { return false; }
+
+  /*!
+   * Tell whether set_command_time() only times the retunes of the device,
+   * the caller has to wait for the time before the other control calls.
+   */
+  virtual bool command_time_retunes_only( void ) { return false; }
+
+  /*!
+   * Apply the following control calls as soon as possible again.
+   * \param mboard the motherboard index 0 to M-1
+   */
+  virtual void clear_command_time(size_t mboard = 0) { }
+
+  /*!
+   * Get the monitor counting the underflows of the device.
+   * \return the monitor or NULL if the backend does not report underflows
+   */
+  virtual tx_monitor *get_tx_monitor( void ) { return NULL; }
+
+  /*!
+   * Switch the inputs of the block to the given sample type, called
+   * before the block is connected.
+   * \param type the stream type
+   * \return false if the backend only takes fc32, it is converted then
+   */
+  virtual bool set_stream_type( stream_type_t type ) { return type == STREAM_FC32; }
+
+  /*!
+   * Get a counter bumped whenever settings recorded by the device were
+   * applied later on. Values read before a change may be stale.
+   */
+  virtual unsigned int get_config_generation( void ) { return 0; }
 };
 
 #endif // OSMOSDR_SINK_IFACE_H
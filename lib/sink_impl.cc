@@ -30,30 +30,18 @@
 #include <gnuradio/io_signature.h>
 #include <gnuradio/constants.h>
 
-#ifdef ENABLE_UHD
-#include "uhd_sink_c.h"
-#endif
-#ifdef ENABLE_HACKRF
-#include "hackrf_sink_c.h"
-#endif
-#ifdef ENABLE_BLADERF
-#include "bladerf_sink_c.h"
-#endif
-#ifdef ENABLE_SOAPY
-#include "soapy_sink_c.h"
-#endif
-#ifdef ENABLE_REDPITAYA
-#include "redpitaya_sink_c.h"
-#endif
-#ifdef ENABLE_FREESRP
-#include <freesrp_sink_c.h>
-#endif
-#ifdef ENABLE_FILE
-#include "file_sink_c.h"
-#endif
+#include <boost/bind.hpp>
+
+#include <algorithm>
+#include <iostream>
+#include <cmath>
 
 #include "arg_helpers.h"
+#include "backend_registry.h"
+#include "parallel_helpers.h"
 #include "sink_impl.h"
+#include "stream_converter.h"
+#include "tx_monitor.h"
 
 /*
  * Create a new instance of sink_impl and return
@@ -65,6 +53,20 @@ osmosdr::sink::make( const std::string &args )
   return gnuradio::get_initial_sptr( new sink_impl(args) );
 }
 
+/*
+ * Instantiate the backend selected by a single device argument string.
+ * block and iface are left untouched if no backend matches.
+ */
+static void make_sink_dev( const std::string &arg,
+                           gr::basic_block_sptr &block,
+                           sink_iface *&iface )
+{
+  backend_t backend;
+
+  if ( backend_registry::instance().find_sink( arg, backend ) )
+    backend.make_sink( arg, block, iface );
+}
+
 /*
  * The private constructor
  */
@@ -79,29 +81,7 @@ sink_impl::sink_impl( const std::string &args )
 
   std::vector< std::string > arg_list = args_to_vector(args);
 
-  std::vector< std::string > dev_types;
-
-#ifdef ENABLE_UHD
-  dev_types.push_back("uhd");
-#endif
-#ifdef ENABLE_HACKRF
-  dev_types.push_back("hackrf");
-#endif
-#ifdef ENABLE_BLADERF
-  dev_types.push_back("bladerf");
-#endif
-#ifdef ENABLE_SOAPY
-  dev_types.push_back("soapy");
-#endif
-#ifdef ENABLE_REDPITAYA
-  dev_types.push_back("redpitaya");
-#endif
-#ifdef ENABLE_FREESRP
-  dev_types.push_back("freesrp");
-#endif
-#ifdef ENABLE_FILE
-  dev_types.push_back("file");
-#endif
+  std::vector< std::string > dev_types = backend_registry::instance().sink_names();
 
   std::cerr << "gr-osmosdr "
             << GR_OSMOSDR_VERSION << " (" << GR_OSMOSDR_LIBVER << ") "
@@ -111,6 +91,8 @@ sink_impl::sink_impl( const std::string &args )
     std::cerr << dev_type << " ";
   std::cerr << std::endl;
 
+  dev_types = backend_registry::instance().sink_keys();
+
   BOOST_FOREACH(std::string arg, arg_list) {
     dict_t dict = params_to_dict(arg);
     BOOST_FOREACH(std::string dev_type, dev_types) {
@@ -123,34 +105,9 @@ sink_impl::sink_impl( const std::string &args )
 
   if ( ! device_specified ) {
     std::vector< std::string > dev_list;
-#ifdef ENABLE_UHD
-    BOOST_FOREACH( std::string dev, uhd_sink_c::get_devices() )
-      dev_list.push_back( dev );
-#endif
-#ifdef ENABLE_BLADERF
-    BOOST_FOREACH( std::string dev, bladerf_sink_c::get_devices() )
-      dev_list.push_back( dev );
-#endif
-#ifdef ENABLE_HACKRF
-    BOOST_FOREACH( std::string dev, hackrf_sink_c::get_devices() )
-      dev_list.push_back( dev );
-#endif
-#ifdef ENABLE_SOAPY
-    BOOST_FOREACH( std::string dev, soapy_sink_c::get_devices() )
-      dev_list.push_back( dev );
-#endif
-#ifdef ENABLE_REDPITAYA
-    BOOST_FOREACH( std::string dev, redpitaya_sink_c::get_devices() )
-      dev_list.push_back( dev );
-#endif
-#ifdef ENABLE_FREESRP
-    BOOST_FOREACH( std::string dev, freesrp_sink_c::get_devices() )
-      dev_list.push_back( dev );
-#endif
-#ifdef ENABLE_FILE
-    BOOST_FOREACH( std::string dev, file_sink_c::get_devices() )
-      dev_list.push_back( dev );
-#endif
+    BOOST_FOREACH( const backend_t &backend, backend_registry::instance().sink_backends() )
+      BOOST_FOREACH( std::string dev, backend.get_sink_devices( false ) )
+        dev_list.push_back( dev );
 
 //    std::cerr << std::endl;
 //    BOOST_FOREACH( std::string dev, dev_list )
@@ -162,65 +119,45 @@ sink_impl::sink_impl( const std::string &args )
       throw std::runtime_error("No supported devices found (check the connection and/or udev rules).");
   }
 
-  BOOST_FOREACH(std::string arg, arg_list) {
+  /* open and configure the devices concurrently, but keep the results in
+   * argument order so the channel numbering does not depend on scheduling */
+  std::vector< gr::basic_block_sptr > blocks( arg_list.size() );
+  std::vector< sink_iface * > ifaces( arg_list.size(), NULL );
+  std::vector< task_t > tasks;
 
-    dict_t dict = params_to_dict(arg);
+  for (size_t d = 0; d < arg_list.size(); d++)
+    tasks.push_back( [&arg_list, &blocks, &ifaces, d]() {
+      make_sink_dev( arg_list[d], blocks[d], ifaces[d] );
+    } );
 
-//    std::cerr << std::endl;
-//    BOOST_FOREACH( dict_t::value_type &entry, dict )
-//      std::cerr << "'" << entry.first << "' = '" << entry.second << "'" << std::endl;
+  run_in_parallel( tasks, arg_list );
 
-    sink_iface *iface = NULL;
-    gr::basic_block_sptr block;
+  message_port_register_hier_out( pmt::mp("tx_underflow") );
 
-#ifdef ENABLE_UHD
-    if ( dict.count("uhd") ) {
-      uhd_sink_c_sptr sink = make_uhd_sink_c( arg );
-      block = sink; iface = sink.get();
-    }
-#endif
-#ifdef ENABLE_HACKRF
-    if ( dict.count("hackrf") ) {
-      hackrf_sink_c_sptr sink = make_hackrf_sink_c( arg );
-      block = sink; iface = sink.get();
-    }
-#endif
-#ifdef ENABLE_BLADERF
-    if ( dict.count("bladerf") ) {
-      bladerf_sink_c_sptr sink = make_bladerf_sink_c( arg );
-      block = sink; iface = sink.get();
-    }
-#endif
-#ifdef ENABLE_SOAPY
-    if ( dict.count("soapy") ) {
-      soapy_sink_c_sptr sink = make_soapy_sink_c( arg );
-      block = sink; iface = sink.get();
-    }
-#endif
-#ifdef ENABLE_REDPITAYA
-    if ( dict.count("redpitaya") ) {
-      redpitaya_sink_c_sptr sink = make_redpitaya_sink_c( arg );
-      block = sink; iface = sink.get();
-    }
-#endif
-#ifdef ENABLE_FREESRP
-    if ( dict.count("freesrp") ) {
-      freesrp_sink_c_sptr sink = make_freesrp_sink_c( arg );
-      block = sink; iface = sink.get();
-    }
-#endif
-#ifdef ENABLE_FILE
-    if ( dict.count("file") ) {
-      file_sink_c_sptr sink = make_file_sink_c( arg );
-      block = sink; iface = sink.get();
-    }
-#endif
+  const stream_type_t stream_type = args_to_stream_type( args );
+
+  for (size_t d = 0; d < arg_list.size(); d++) {
+    sink_iface *iface = ifaces[d];
+    gr::basic_block_sptr block = blocks[d];
 
     if ( iface != NULL && long(block.get()) != 0 ) {
       _devs.push_back( iface );
 
+      if ( iface->get_tx_monitor() )
+        msg_connect( block, "tx_underflow", self(), "tx_underflow" );
+
+      const bool native = iface->set_stream_type( stream_type );
+
       for (size_t i = 0; i < iface->get_num_channels(); i++) {
-        connect(self(), channel++, block, i);
+        _chans.push_back( channel_t( iface, _devs.size() - 1, i ) );
+
+        if ( native ) {
+          connect(self(), channel++, block, i);
+        } else {
+          stream_converter_sptr conv = make_stream_converter( stream_type, STREAM_FC32 );
+          connect(self(), channel++, conv, 0);
+          connect(conv, 0, block, i);
+        }
       }
     } else if ( (iface != NULL) || (long(block.get()) != 0) )
       throw std::runtime_error("Either iface or block are NULL.");
@@ -229,24 +166,150 @@ sink_impl::sink_impl( const std::string &args )
 
   if (!_devs.size())
     throw std::runtime_error("No devices specified via device arguments.");
+
+  _command_timer.resize( _devs.size() );
+  _config_generations.resize( _devs.size(), 0 );
+
+  message_port_register_hier_in( pmt::mp("command") );
+  msg_connect( self(), "command",
+               make_command_port( boost::bind( &sink_impl::handle_command, this, _1 ) ),
+               "command" );
+}
+
+sink_impl::channel_t::channel_t( sink_iface *dev, size_t dev_index, size_t dev_chan )
+  : dev(dev),
+    dev_index(dev_index),
+    dev_chan(dev_chan),
+    center_freq(0),
+    freq_corr(0),
+    gain_mode(false),
+    gain(0),
+    if_gain(0),
+    bb_gain(0),
+    bandwidth(0)
+{
+}
+
+bool sink_impl::channel_t::automatic_gain()
+{
+  return act_gain_mode.get( [this]() { return dev->get_gain_mode( dev_chan ); } );
+}
+
+void sink_impl::channel_t::invalidate_gains()
+{
+  act_gain.invalidate();
+  act_named_gain.invalidate();
+}
+
+void sink_impl::channel_t::invalidate_band()
+{
+  /* some devices have different gain stages or ranges per band */
+  gain_range.invalidate();
+  named_gain_range.invalidate();
+  invalidate_gains();
+}
+
+void sink_impl::channel_t::invalidate()
+{
+  act_center_freq.invalidate();
+  act_freq_corr.invalidate();
+  act_gain_mode.invalidate();
+  act_antenna.invalidate();
+  act_bandwidth.invalidate();
+  freq_range.invalidate();
+  bandwidth_range.invalidate();
+  gain_names.invalidate();
+  antennas.invalidate();
+  invalidate_band();
 }
 
 size_t sink_impl::get_num_channels()
 {
-  size_t channels = 0;
+  return _chans.size();
+}
 
-  BOOST_FOREACH( sink_iface *dev, _devs )
-    channels += dev->get_num_channels();
+/* set in the tasks apply_settings() runs for the devices in parallel, they
+ * act under the lock their caller holds */
+static thread_local bool _caller_holds_lock = false;
+
+struct caller_holds_lock_t
+{
+  caller_holds_lock_t() : prev(_caller_holds_lock) { _caller_holds_lock = true; }
+  ~caller_holds_lock_t() { _caller_holds_lock = prev; }
+
+  bool prev;
+};
 
-  return channels;
+std::unique_lock< std::recursive_mutex > sink_impl::lock_state()
+{
+  if ( _caller_holds_lock )
+    return std::unique_lock< std::recursive_mutex >();
+
+  std::unique_lock< std::recursive_mutex > lock( _mutex );
+  check_config_generations();
+
+  return lock;
+}
+
+/* the devices may apply what they recorded later on, the values cached
+ * until then may be stale */
+void sink_impl::check_config_generations()
+{
+  bool changed = false;
+
+  for (size_t i = 0; i < _devs.size() && i < _config_generations.size(); i++) {
+    const unsigned int generation = _devs[i]->get_config_generation();
+    if ( generation != _config_generations[i] ) {
+      _config_generations[i] = generation;
+      changed = true;
+    }
+  }
+
+  if ( ! changed )
+    return;
+
+  refresh_state();
+
+  /* what follows the rate has to catch up with the committed one */
+  const double rate = get_sample_rate();
+  if ( rate != _sample_rate ) {
+    _sample_rate = rate;
+    rate_changed();
+  }
+}
+
+void sink_impl::rate_changed()
+{
+  _act_sample_rate.set( _sample_rate );
+
+  /* automatic filter selection follows the sample rate */
+  for (size_t i = 0; i < _chans.size(); i++) {
+    _chans[i].act_bandwidth.invalidate();
+    _chans[i].bandwidth_range.invalidate();
+  }
+}
+
+void sink_impl::refresh_state()
+{
+  auto lock = lock_state();
+
+  _sample_rates.invalidate();
+  _act_sample_rate.invalidate();
+
+  for (size_t i = 0; i < _chans.size(); i++)
+    _chans[i].invalidate();
 }
 
 #define NO_DEVICES_MSG  "FATAL: No device(s) available to work with."
 
 osmosdr::meta_range_t sink_impl::get_sample_rates()
 {
+  auto lock = lock_state();
+
   if ( ! _devs.empty() )
-    return _devs[0]->get_sample_rates(); // assume same devices used in the group
+    return _sample_rates.get( [this]() { // assume same devices used in the group
+      return _devs[0]->get_sample_rates();
+    } );
 #if 0
   else
     throw std::runtime_error(NO_DEVICES_MSG);
@@ -256,17 +319,31 @@ osmosdr::meta_range_t sink_impl::get_sample_rates()
 
 double sink_impl::set_sample_rate(double rate)
 {
-  double sample_rate = 0;
+  for (size_t i = 0; i < _devs.size(); i++)
+    wait_command_time( i );
+
+  auto lock = lock_state();
 
   if (_sample_rate != rate) {
 #if 0
     if (_devs.empty())
       throw std::runtime_error(NO_DEVICES_MSG);
 #endif
-    BOOST_FOREACH( sink_iface *dev, _devs )
-      sample_rate = dev->set_sample_rate(rate);
+    /* every device blocks on its own control transfers, so do them at once */
+    std::vector< double > rates( _devs.size(), 0 );
+    std::vector< task_t > tasks;
+
+    for (size_t i = 0; i < _devs.size(); i++) {
+      double *actual = &rates[i];
+      tasks.push_back( [this, i, rate, actual]() {
+        *actual = _devs[i]->set_sample_rate( rate );
+      } );
+    }
+
+    run_in_parallel( tasks );
 
-    _sample_rate = sample_rate;
+    _sample_rate = rates.empty() ? 0 : rates.back();
+    rate_changed();
   }
 
   return _sample_rate;
@@ -274,10 +351,14 @@ double sink_impl::set_sample_rate(double rate)
 
 double sink_impl::get_sample_rate()
 {
+  auto lock = lock_state();
+
   double sample_rate = 0;
 
   if (!_devs.empty())
-    sample_rate = _devs[0]->get_sample_rate(); // assume same devices used in the group
+    sample_rate = _act_sample_rate.get( [this]() { // assume same devices used in the group
+      return _devs[0]->get_sample_rate();
+    } );
 #if 0
   else
     throw std::runtime_error(NO_DEVICES_MSG);
@@ -287,297 +368,493 @@ double sink_impl::get_sample_rate()
 
 osmosdr::freq_range_t sink_impl::get_freq_range( size_t chan )
 {
-  size_t channel = 0;
-  BOOST_FOREACH( sink_iface *dev, _devs )
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ )
-        return dev->get_freq_range( dev_chan );
+  auto lock = lock_state();
 
-  return osmosdr::freq_range_t();
+  if ( chan >= _chans.size() )
+    return osmosdr::freq_range_t();
+
+  channel_t &ch = _chans[ chan ];
+  return ch.freq_range.get( [&ch]() { return ch.dev->get_freq_range( ch.dev_chan ); } );
 }
 
 double sink_impl::set_center_freq( double freq, size_t chan )
 {
-  size_t channel = 0;
-  BOOST_FOREACH( sink_iface *dev, _devs )
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ ) {
-        if ( _center_freq[ chan ] != freq ) {
-          _center_freq[ chan ] = freq;
-          return dev->set_center_freq( freq, dev_chan );
-        } else { return _center_freq[ chan ]; }
-      }
+  wait_channel_time( chan, true );
+  auto lock = lock_state();
 
-  return 0;
+  if ( chan >= _chans.size() )
+    return 0;
+
+  channel_t &ch = _chans[ chan ];
+  if ( ch.center_freq != freq ) {
+    ch.center_freq = freq;
+    ch.invalidate_band();
+    return ch.act_center_freq.set( ch.dev->set_center_freq( freq, ch.dev_chan ) );
+  } else { return ch.center_freq; }
 }
 
 double sink_impl::get_center_freq( size_t chan )
 {
-  size_t channel = 0;
-  BOOST_FOREACH( sink_iface *dev, _devs )
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ )
-        return dev->get_center_freq( dev_chan );
+  auto lock = lock_state();
 
-  return 0;
+  if ( chan >= _chans.size() )
+    return 0;
+
+  channel_t &ch = _chans[ chan ];
+  return ch.act_center_freq.get( [&ch]() { return ch.dev->get_center_freq( ch.dev_chan ); } );
 }
 
 double sink_impl::set_freq_corr( double ppm, size_t chan )
 {
-  size_t channel = 0;
-  BOOST_FOREACH( sink_iface *dev, _devs )
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ ) {
-        if ( _freq_corr[ chan ] != ppm ) {
-          _freq_corr[ chan ] = ppm;
-          return dev->set_freq_corr( ppm, dev_chan );
-        } else { return _freq_corr[ chan ]; }
-      }
+  wait_channel_time( chan );
+  auto lock = lock_state();
 
-  return 0;
+  if ( chan >= _chans.size() )
+    return 0;
+
+  channel_t &ch = _chans[ chan ];
+  if ( ch.freq_corr != ppm ) {
+    ch.freq_corr = ppm;
+    ch.act_center_freq.invalidate(); /* may be reported corrected */
+    return ch.act_freq_corr.set( ch.dev->set_freq_corr( ppm, ch.dev_chan ) );
+  } else { return ch.freq_corr; }
 }
 
 double sink_impl::get_freq_corr( size_t chan )
 {
-  size_t channel = 0;
-  BOOST_FOREACH( sink_iface *dev, _devs )
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ )
-        return dev->get_freq_corr( dev_chan );
+  auto lock = lock_state();
+
+  if ( chan >= _chans.size() )
+    return 0;
 
-  return 0;
+  channel_t &ch = _chans[ chan ];
+  return ch.act_freq_corr.get( [&ch]() { return ch.dev->get_freq_corr( ch.dev_chan ); } );
 }
 
 std::vector<std::string> sink_impl::get_gain_names( size_t chan )
 {
-  size_t channel = 0;
-  BOOST_FOREACH( sink_iface *dev, _devs )
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ )
-        return dev->get_gain_names( dev_chan );
+  auto lock = lock_state();
+
+  if ( chan >= _chans.size() )
+    return std::vector< std::string >();
 
-  return std::vector< std::string >();
+  channel_t &ch = _chans[ chan ];
+  return ch.gain_names.get( [&ch]() { return ch.dev->get_gain_names( ch.dev_chan ); } );
 }
 
 osmosdr::gain_range_t sink_impl::get_gain_range( size_t chan )
 {
-  size_t channel = 0;
-  BOOST_FOREACH( sink_iface *dev, _devs )
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ )
-        return dev->get_gain_range( dev_chan );
+  auto lock = lock_state();
 
-  return osmosdr::gain_range_t();
+  if ( chan >= _chans.size() )
+    return osmosdr::gain_range_t();
+
+  channel_t &ch = _chans[ chan ];
+  return ch.gain_range.get( [&ch]() { return ch.dev->get_gain_range( ch.dev_chan ); } );
 }
 
 osmosdr::gain_range_t sink_impl::get_gain_range( const std::string & name, size_t chan )
 {
-  size_t channel = 0;
-  BOOST_FOREACH( sink_iface *dev, _devs )
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ )
-        return dev->get_gain_range( name, dev_chan );
+  auto lock = lock_state();
+
+  if ( chan >= _chans.size() )
+    return osmosdr::gain_range_t();
 
-  return osmosdr::gain_range_t();
+  channel_t &ch = _chans[ chan ];
+  return ch.named_gain_range.get( name, [&ch, &name]() {
+    return ch.dev->get_gain_range( name, ch.dev_chan );
+  } );
 }
 
 bool sink_impl::set_gain_mode( bool automatic, size_t chan )
 {
-  size_t channel = 0;
-  BOOST_FOREACH( sink_iface *dev, _devs )
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ ) {
-        if ( _gain_mode[ chan ] != automatic ) {
-          _gain_mode[ chan ] = automatic;
-          bool mode = dev->set_gain_mode( automatic, dev_chan );
-          if (!automatic) // reapply gain value when switched to manual mode
-            dev->set_gain( _gain[ chan ], dev_chan );
-          return mode;
-        } else { return _gain_mode[ chan ]; }
-      }
+  wait_channel_time( chan );
+  auto lock = lock_state();
 
-  return false;
+  if ( chan >= _chans.size() )
+    return false;
+
+  channel_t &ch = _chans[ chan ];
+  if ( ch.gain_mode != automatic ) {
+    ch.gain_mode = automatic;
+    ch.invalidate_gains();
+    bool mode = ch.act_gain_mode.set( ch.dev->set_gain_mode( automatic, ch.dev_chan ) );
+    if (!automatic) // reapply gain value when switched to manual mode
+      ch.act_gain.set( ch.dev->set_gain( ch.gain, ch.dev_chan ) );
+    return mode;
+  } else { return ch.gain_mode; }
 }
 
 bool sink_impl::get_gain_mode( size_t chan )
 {
-  size_t channel = 0;
-  BOOST_FOREACH( sink_iface *dev, _devs )
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ )
-        return dev->get_gain_mode( dev_chan );
+  auto lock = lock_state();
+
+  if ( chan >= _chans.size() )
+    return false;
 
-  return false;
+  channel_t &ch = _chans[ chan ];
+  return ch.act_gain_mode.get( [&ch]() { return ch.dev->get_gain_mode( ch.dev_chan ); } );
 }
 
 double sink_impl::set_gain( double gain, size_t chan )
 {
-  size_t channel = 0;
-  BOOST_FOREACH( sink_iface *dev, _devs )
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ ) {
-        if ( _gain[ chan ] != gain ) {
-          _gain[ chan ] = gain;
-          return dev->set_gain( gain, dev_chan );
-        } else { return _gain[ chan ]; }
-      }
+  wait_channel_time( chan );
+  auto lock = lock_state();
+
+  if ( chan >= _chans.size() )
+    return 0;
 
-  return 0;
+  channel_t &ch = _chans[ chan ];
+  if ( ch.gain != gain ) {
+    ch.gain = gain;
+    ch.act_named_gain.invalidate(); /* distributed over the stages */
+    return ch.act_gain.set( ch.dev->set_gain( gain, ch.dev_chan ) );
+  } else { return ch.gain; }
 }
 
 double sink_impl::set_gain( double gain, const std::string & name, size_t chan)
 {
-  size_t channel = 0;
-  BOOST_FOREACH( sink_iface *dev, _devs )
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ )
-        return dev->set_gain( gain, name, dev_chan );
+  wait_channel_time( chan );
+  auto lock = lock_state();
 
-  return 0;
+  if ( chan >= _chans.size() )
+    return 0;
+
+  channel_t &ch = _chans[ chan ];
+  ch.act_gain.invalidate();
+  return ch.act_named_gain.set( name, ch.dev->set_gain( gain, name, ch.dev_chan ) );
 }
 
 double sink_impl::get_gain( size_t chan )
 {
-  size_t channel = 0;
-  BOOST_FOREACH( sink_iface *dev, _devs )
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ )
-        return dev->get_gain( dev_chan );
+  auto lock = lock_state();
+
+  if ( chan >= _chans.size() )
+    return 0;
+
+  channel_t &ch = _chans[ chan ];
+  if ( ch.automatic_gain() ) /* the device changes it on its own */
+    return ch.dev->get_gain( ch.dev_chan );
 
-  return 0;
+  return ch.act_gain.get( [&ch]() { return ch.dev->get_gain( ch.dev_chan ); } );
 }
 
 double sink_impl::get_gain( const std::string & name, size_t chan )
 {
-  size_t channel = 0;
-  BOOST_FOREACH( sink_iface *dev, _devs )
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ )
-        return dev->get_gain( name, dev_chan );
+  auto lock = lock_state();
 
-  return 0;
+  if ( chan >= _chans.size() )
+    return 0;
+
+  channel_t &ch = _chans[ chan ];
+  if ( ch.automatic_gain() ) /* the device changes it on its own */
+    return ch.dev->get_gain( name, ch.dev_chan );
+
+  return ch.act_named_gain.get( name, [&ch, &name]() {
+    return ch.dev->get_gain( name, ch.dev_chan );
+  } );
 }
 
 double sink_impl::set_if_gain( double gain, size_t chan )
 {
-  size_t channel = 0;
-  BOOST_FOREACH( sink_iface *dev, _devs )
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ ) {
-        if ( _if_gain[ chan ] != gain ) {
-          _if_gain[ chan ] = gain;
-          return dev->set_if_gain( gain, dev_chan );
-        } else { return _if_gain[ chan ]; }
-      }
+  wait_channel_time( chan );
+  auto lock = lock_state();
+
+  if ( chan >= _chans.size() )
+    return 0;
 
-  return 0;
+  channel_t &ch = _chans[ chan ];
+  if ( ch.if_gain != gain ) {
+    ch.if_gain = gain;
+    ch.invalidate_gains();
+    return ch.dev->set_if_gain( gain, ch.dev_chan );
+  } else { return ch.if_gain; }
 }
 
 double sink_impl::set_bb_gain( double gain, size_t chan )
 {
-  size_t channel = 0;
-  BOOST_FOREACH( sink_iface *dev, _devs )
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ ) {
-        if ( _bb_gain[ chan ] != gain ) {
-          _bb_gain[ chan ] = gain;
-          return dev->set_bb_gain( gain, dev_chan );
-        } else { return _bb_gain[ chan ]; }
-      }
+  wait_channel_time( chan );
+  auto lock = lock_state();
 
-  return 0;
+  if ( chan >= _chans.size() )
+    return 0;
+
+  channel_t &ch = _chans[ chan ];
+  if ( ch.bb_gain != gain ) {
+    ch.bb_gain = gain;
+    ch.invalidate_gains();
+    return ch.dev->set_bb_gain( gain, ch.dev_chan );
+  } else { return ch.bb_gain; }
 }
 
 std::vector< std::string > sink_impl::get_antennas( size_t chan )
 {
-  size_t channel = 0;
-  BOOST_FOREACH( sink_iface *dev, _devs )
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ )
-        return dev->get_antennas( dev_chan );
+  auto lock = lock_state();
+
+  if ( chan >= _chans.size() )
+    return std::vector< std::string >();
 
-  return std::vector< std::string >();
+  channel_t &ch = _chans[ chan ];
+  return ch.antennas.get( [&ch]() { return ch.dev->get_antennas( ch.dev_chan ); } );
 }
 
 std::string sink_impl::set_antenna( const std::string & antenna, size_t chan )
 {
-  size_t channel = 0;
-  BOOST_FOREACH( sink_iface *dev, _devs )
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ ) {
-        if ( _antenna[ chan ] != antenna ) {
-          _antenna[ chan ] = antenna;
-          return dev->set_antenna( antenna, dev_chan );
-        } else { return _antenna[ chan ]; }
-      }
+  wait_channel_time( chan );
+  auto lock = lock_state();
 
-  return "";
+  if ( chan >= _chans.size() )
+    return "";
+
+  channel_t &ch = _chans[ chan ];
+  if ( ch.antenna != antenna ) {
+    ch.antenna = antenna;
+    ch.invalidate_band();
+    ch.invalidate_gains();
+    return ch.act_antenna.set( ch.dev->set_antenna( antenna, ch.dev_chan ) );
+  } else { return ch.antenna; }
 }
 
 std::string sink_impl::get_antenna( size_t chan )
 {
-  size_t channel = 0;
-  BOOST_FOREACH( sink_iface *dev, _devs )
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ )
-        return dev->get_antenna( dev_chan );
+  auto lock = lock_state();
+
+  if ( chan >= _chans.size() )
+    return "";
 
-  return "";
+  channel_t &ch = _chans[ chan ];
+  return ch.act_antenna.get( [&ch]() { return ch.dev->get_antenna( ch.dev_chan ); } );
 }
 
 void sink_impl::set_dc_offset( const std::complex<double> &offset, size_t chan )
 {
-  size_t channel = 0;
-  BOOST_FOREACH( sink_iface *dev, _devs )
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ )
-        dev->set_dc_offset( offset, dev_chan );
+  auto lock = lock_state();
+
+  if ( chan < _chans.size() )
+    _chans[ chan ].dev->set_dc_offset( offset, _chans[ chan ].dev_chan );
 }
 
 void sink_impl::set_iq_balance( const std::complex<double> &balance, size_t chan )
 {
-  size_t channel = 0;
-  BOOST_FOREACH( sink_iface *dev, _devs )
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ )
-        dev->set_iq_balance( balance, dev_chan );
+  auto lock = lock_state();
+
+  if ( chan < _chans.size() )
+    _chans[ chan ].dev->set_iq_balance( balance, _chans[ chan ].dev_chan );
 }
 
 double sink_impl::set_bandwidth( double bandwidth, size_t chan )
 {
-  size_t channel = 0;
-  BOOST_FOREACH( sink_iface *dev, _devs )
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ ) {
-        if ( _bandwidth[ chan ] != bandwidth || 0.0f == bandwidth ) {
-          _bandwidth[ chan ] = bandwidth;
-          return dev->set_bandwidth( bandwidth, dev_chan );
-        } else { return _bandwidth[ chan ]; }
-      }
+  wait_channel_time( chan );
+  auto lock = lock_state();
 
-  return 0;
+  if ( chan >= _chans.size() )
+    return 0;
+
+  channel_t &ch = _chans[ chan ];
+  if ( ch.bandwidth != bandwidth || 0.0f == bandwidth ) {
+    ch.bandwidth = bandwidth;
+    return ch.act_bandwidth.set( ch.dev->set_bandwidth( bandwidth, ch.dev_chan ) );
+  } else { return ch.bandwidth; }
 }
 
 double sink_impl::get_bandwidth( size_t chan )
 {
-  size_t channel = 0;
-  BOOST_FOREACH( sink_iface *dev, _devs )
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ )
-        return dev->get_bandwidth( dev_chan );
+  auto lock = lock_state();
+
+  if ( chan >= _chans.size() )
+    return 0;
 
-  return 0;
+  channel_t &ch = _chans[ chan ];
+  return ch.act_bandwidth.get( [&ch]() { return ch.dev->get_bandwidth( ch.dev_chan ); } );
 }
 
 osmosdr::freq_range_t sink_impl::get_bandwidth_range( size_t chan )
 {
-  size_t channel = 0;
-  BOOST_FOREACH( sink_iface *dev, _devs )
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ )
-        return dev->get_bandwidth_range( dev_chan );
+  auto lock = lock_state();
+
+  if ( chan >= _chans.size() )
+    return osmosdr::freq_range_t();
+
+  channel_t &ch = _chans[ chan ];
+  return ch.bandwidth_range.get( [&ch]() { return ch.dev->get_bandwidth_range( ch.dev_chan ); } );
+}
+
+osmosdr::settings_t sink_impl::apply_settings( const osmosdr::settings_t &settings )
+{
+  /* the devices reach their command times before the lock is taken, the
+   * setters find them passed then */
+  for (size_t i = 0; i < _devs.size(); i++) {
+    bool touched = !std::isnan( settings.sample_rate );
+    bool retune = !touched;
+
+    for (size_t chan = 0; chan < settings.channels.size(); chan++) {
+      const size_t dev_chan = chan;
+      if ( dev_chan >= _chans.size() || _chans[ dev_chan ].dev_index != i )
+        continue;
+
+      const osmosdr::channel_settings_t &req = settings.channels[ chan ];
+      if ( !std::isnan( req.bandwidth ) || !std::isnan( req.gain ) ) {
+        touched = true;
+        retune = false;
+      } else if ( !std::isnan( req.center_freq ) ) {
+        touched = true;
+      }
+    }
+
+    if ( touched )
+      wait_command_time( i, retune );
+  }
+
+  auto lock = lock_state();
+
+  osmosdr::settings_t actual;
+  actual.channels.resize( std::min( settings.channels.size(), _chans.size() ) );
+
+  /* the rate first, the bandwidths follow it */
+  if ( !std::isnan( settings.sample_rate ) )
+    set_sample_rate( settings.sample_rate );
 
-  return osmosdr::freq_range_t();
+  std::vector< task_t > tasks;
+
+  /* one task per device, each one touches only the channels of its device */
+  for (size_t i = 0; i < _devs.size(); i++) {
+    tasks.push_back( [this, i, &settings, &actual]() {
+      caller_holds_lock_t inherited;
+
+      for (size_t chan = 0; chan < actual.channels.size(); chan++) {
+        if ( _chans[ chan ].dev_index != i )
+          continue;
+
+        const osmosdr::channel_settings_t &req = settings.channels[ chan ];
+        osmosdr::channel_settings_t &res = actual.channels[ chan ];
+
+        if ( !std::isnan( req.bandwidth ) )
+          res.bandwidth = set_bandwidth( req.bandwidth, chan );
+        if ( !std::isnan( req.center_freq ) )
+          res.center_freq = set_center_freq( req.center_freq, chan );
+        if ( !std::isnan( req.gain ) )
+          res.gain = set_gain( req.gain, chan );
+      }
+    } );
+  }
+
+  run_in_parallel( tasks );
+
+  if ( !std::isnan( settings.sample_rate ) )
+    actual.sample_rate = _sample_rate;
+
+  return actual;
+}
+
+void sink_impl::handle_command( pmt::pmt_t msg )
+{
+  command_t cmd;
+
+  try {
+    cmd = parse_command( msg );
+  } catch ( std::exception &ex ) {
+    std::cerr << "Dropping command: " << ex.what() << std::endl;
+    return;
+  }
+
+  _control.post( [this, cmd]() {
+    try {
+      apply_command( cmd );
+    } catch ( std::exception &ex ) {
+      std::cerr << "Command failed: " << ex.what() << std::endl;
+    }
+  } );
+}
+
+void sink_impl::apply_command( const command_t &cmd )
+{
+  if ( cmd.chan >= long(_chans.size()) )
+    throw std::runtime_error( "no channel " + std::to_string( cmd.chan ) );
+
+  size_t first = cmd.chan < 0 ? 0 : cmd.chan;
+  size_t last = cmd.chan < 0 ? _chans.size() : cmd.chan + 1;
+
+  /* the antenna first, gains and filters may depend on it */
+  if ( cmd.antenna.length() )
+    for (size_t chan = first; chan < last; chan++)
+      set_antenna( cmd.antenna, chan );
+
+  osmosdr::settings_t settings;
+  settings.sample_rate = cmd.rate;
+  settings.channels.resize( last );
+
+  for (size_t chan = first; chan < last; chan++) {
+    settings.channels[ chan ].center_freq = cmd.freq;
+    settings.channels[ chan ].gain = cmd.gain;
+    settings.channels[ chan ].bandwidth = cmd.bandwidth;
+  }
+
+  apply_settings( settings );
+}
+
+std::future<double> sink_impl::set_sample_rate_async( double rate )
+{
+  return _control.submit( [=]() { return set_sample_rate( rate ); } );
+}
+
+std::future<double> sink_impl::set_center_freq_async( double freq, size_t chan )
+{
+  return _control.submit( [=]() { return set_center_freq( freq, chan ); } );
+}
+
+std::future<double> sink_impl::set_freq_corr_async( double ppm, size_t chan )
+{
+  return _control.submit( [=]() { return set_freq_corr( ppm, chan ); } );
+}
+
+std::future<bool> sink_impl::set_gain_mode_async( bool automatic, size_t chan )
+{
+  return _control.submit( [=]() { return set_gain_mode( automatic, chan ); } );
+}
+
+std::future<double> sink_impl::set_gain_async( double gain, size_t chan )
+{
+  return _control.submit( [=]() { return set_gain( gain, chan ); } );
+}
+
+std::future<double> sink_impl::set_gain_async( double gain, const std::string & name, size_t chan )
+{
+  return _control.submit( [=]() { return set_gain( gain, name, chan ); } );
+}
+
+std::future<double> sink_impl::set_if_gain_async( double gain, size_t chan )
+{
+  return _control.submit( [=]() { return set_if_gain( gain, chan ); } );
+}
+
+std::future<double> sink_impl::set_bb_gain_async( double gain, size_t chan )
+{
+  return _control.submit( [=]() { return set_bb_gain( gain, chan ); } );
+}
+
+std::future<std::string> sink_impl::set_antenna_async( const std::string & antenna, size_t chan )
+{
+  return _control.submit( [=]() { return set_antenna( antenna, chan ); } );
+}
+
+std::future<void> sink_impl::set_dc_offset_async( const std::complex<double> &offset, size_t chan )
+{
+  return _control.submit( [=]() { set_dc_offset( offset, chan ); } );
+}
+
+std::future<void> sink_impl::set_iq_balance_async( const std::complex<double> &balance, size_t chan )
+{
+  return _control.submit( [=]() { set_iq_balance( balance, chan ); } );
+}
+
+std::future<double> sink_impl::set_bandwidth_async( double bandwidth, size_t chan )
+{
+  return _control.submit( [=]() { return set_bandwidth( bandwidth, chan ); } );
+}
+
+std::future<osmosdr::settings_t> sink_impl::apply_settings_async( const osmosdr::settings_t &settings )
+{
+  return _control.submit( [=]() { return apply_settings( settings ); } );
 }
 
 void sink_impl::set_time_source(const std::string &source, const size_t mboard)
@@ -678,3 +955,61 @@ void sink_impl::set_time_unknown_pps(const osmosdr::time_spec_t &time_spec)
     dev->set_time_unknown_pps( time_spec );
   }
 }
+
+void sink_impl::set_command_time(const osmosdr::time_spec_t &time_spec, size_t mboard)
+{
+  for (size_t m = 0; m < _devs.size(); m++) {
+    if (mboard != osmosdr::ALL_MBOARDS && m != mboard)
+      continue;
+
+    /* emulated for the devices not timing the commands themselves */
+    const bool timed = _devs[m]->set_command_time( time_spec, mboard == osmosdr::ALL_MBOARDS ?
+                                                              osmosdr::ALL_MBOARDS : 0 );
+    if ( timed && ! _devs[m]->command_time_retunes_only() )
+      _command_timer.clear( m );
+    else
+      _command_timer.set( m, time_spec, timed );
+  }
+}
+
+void sink_impl::clear_command_time(size_t mboard)
+{
+  for (size_t m = 0; m < _devs.size(); m++) {
+    if (mboard != osmosdr::ALL_MBOARDS && m != mboard)
+      continue;
+
+    _devs[m]->clear_command_time( mboard == osmosdr::ALL_MBOARDS ?
+                                  osmosdr::ALL_MBOARDS : 0 );
+    _command_timer.clear( m );
+  }
+}
+
+uint64_t sink_impl::get_underflows(size_t mboard)
+{
+  uint64_t count = 0;
+
+  for (size_t m = 0; m < _devs.size(); m++) {
+    if (mboard != osmosdr::ALL_MBOARDS && m != mboard)
+      continue;
+
+    if ( tx_monitor *monitor = _devs[m]->get_tx_monitor() )
+      count += monitor->underflows();
+  }
+
+  return count;
+}
+
+void sink_impl::wait_command_time( size_t dev_index, bool retune )
+{
+  sink_iface *dev = _devs[ dev_index ];
+  _command_timer.wait( dev_index, [dev]() { return dev->get_time_now(); }, retune );
+}
+
+/* called ahead of the lock, the other callers must not wait along */
+void sink_impl::wait_channel_time( size_t chan, bool retune )
+{
+  chan = chan;
+
+  if ( chan < _chans.size() )
+    wait_command_time( _chans[ chan ].dev_index, retune );
+}
@@ -23,8 +23,14 @@
 #include "osmosdr/sink.h"
 
 #include "sink_iface.h"
+#include "command_port.h"
+#include "command_timer.h"
+#include "control_thread.h"
+#include "shadow_state.h"
 
 #include <map>
+#include <memory>
+#include <mutex>
 
 class sink_impl : public osmosdr::sink
 {
@@ -68,6 +74,24 @@ public:
   double get_bandwidth( size_t chan = 0 );
   osmosdr::freq_range_t get_bandwidth_range( size_t chan = 0 );
 
+  osmosdr::settings_t apply_settings( const osmosdr::settings_t &settings );
+
+  void refresh_state( void );
+
+  std::future<double> set_sample_rate_async( double rate );
+  std::future<double> set_center_freq_async( double freq, size_t chan = 0 );
+  std::future<double> set_freq_corr_async( double ppm, size_t chan = 0 );
+  std::future<bool> set_gain_mode_async( bool automatic, size_t chan = 0 );
+  std::future<double> set_gain_async( double gain, size_t chan = 0 );
+  std::future<double> set_gain_async( double gain, const std::string & name, size_t chan = 0 );
+  std::future<double> set_if_gain_async( double gain, size_t chan = 0 );
+  std::future<double> set_bb_gain_async( double gain, size_t chan = 0 );
+  std::future<std::string> set_antenna_async( const std::string & antenna, size_t chan = 0 );
+  std::future<void> set_dc_offset_async( const std::complex<double> &offset, size_t chan = 0 );
+  std::future<void> set_iq_balance_async( const std::complex<double> &balance, size_t chan = 0 );
+  std::future<double> set_bandwidth_async( double bandwidth, size_t chan = 0 );
+  std::future<osmosdr::settings_t> apply_settings_async( const osmosdr::settings_t &settings );
+
   void set_time_source(const std::string &source, const size_t mboard = 0);
   std::string get_time_source(const size_t mboard);
   std::vector<std::string> get_time_sources(const size_t mboard);
@@ -82,19 +106,82 @@ public:
   void set_time_next_pps(const ::osmosdr::time_spec_t &time_spec);
   void set_time_unknown_pps(const ::osmosdr::time_spec_t &time_spec);
 
+  void set_command_time(const ::osmosdr::time_spec_t &time_spec,
+                        size_t mboard = osmosdr::ALL_MBOARDS);
+  void clear_command_time(size_t mboard = osmosdr::ALL_MBOARDS);
+
+  uint64_t get_underflows(size_t mboard = osmosdr::ALL_MBOARDS);
+
 private:
+  std::unique_lock< std::recursive_mutex > lock_state( void );
+  void check_config_generations( void );
+  void rate_changed( void );
+  void handle_command( pmt::pmt_t msg );
+  void apply_command( const command_t &cmd );
+  void wait_command_time( size_t dev_index, bool retune = false );
+  void wait_channel_time( size_t chan, bool retune = false );
+
+  /* serializes the setters and getters, they are called from the flow
+   * graph and the control thread alike */
+  std::recursive_mutex _mutex;
+
+  /* of each device, as last seen by check_config_generations() */
+  std::vector< unsigned int > _config_generations;
+
   std::vector< sink_iface * > _devs;
 
-  /* cache to prevent multiple device calls with the same value coming from grc */
+  /* flat mapping of a channel index to its device and the device local index */
+  struct channel_t
+  {
+    channel_t( sink_iface *dev, size_t dev_index, size_t dev_chan );
+
+    sink_iface *dev;
+    size_t dev_index;
+    size_t dev_chan;
+
+    /* cache to prevent multiple device calls with the same value coming from grc */
+    double center_freq;
+    double freq_corr;
+    bool gain_mode;
+    double gain;
+    double if_gain;
+    double bb_gain;
+    std::string antenna;
+    double bandwidth;
+
+    /* values last reported by the device, served to the getters */
+    shadow_value< double > act_center_freq;
+    shadow_value< double > act_freq_corr;
+    shadow_value< bool > act_gain_mode;
+    shadow_value< double > act_gain;
+    shadow_map< std::string, double > act_named_gain;
+    shadow_value< std::string > act_antenna;
+    shadow_value< double > act_bandwidth;
+    shadow_value< osmosdr::freq_range_t > freq_range;
+    shadow_value< osmosdr::freq_range_t > bandwidth_range;
+    shadow_value< osmosdr::gain_range_t > gain_range;
+    shadow_map< std::string, osmosdr::gain_range_t > named_gain_range;
+    shadow_value< std::vector< std::string > > gain_names;
+    shadow_value< std::vector< std::string > > antennas;
+
+    /* gain readings are not cached while the device controls the gain */
+    bool automatic_gain( void );
+    void invalidate_gains( void );
+    void invalidate_band( void );
+    void invalidate( void );
+  };
+
+  std::vector< channel_t > _chans;
+
   double _sample_rate;
-  std::map< size_t, double > _center_freq;
-  std::map< size_t, double > _freq_corr;
-  std::map< size_t, bool > _gain_mode;
-  std::map< size_t, double > _gain;
-  std::map< size_t, double > _if_gain;
-  std::map< size_t, double > _bb_gain;
-  std::map< size_t, std::string > _antenna;
-  std::map< size_t, double > _bandwidth;
+  shadow_value< double > _act_sample_rate;
+  shadow_value< osmosdr::meta_range_t > _sample_rates;
+
+  /* command times of the devices without timed commands */
+  command_timer _command_timer;
+
+  /* applies queued requests, declared last to be stopped first */
+  control_thread _control;
 };
 
 #endif /* INCLUDED_OSMOSDR_SINK_IMPL_H */
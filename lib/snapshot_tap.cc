@@ -0,0 +1,110 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <gnuradio/io_signature.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include "snapshot_tap.h"
+
+snapshot_tap_sptr make_snapshot_tap( size_t itemsize, uint64_t length,
+                                     uint64_t interval )
+{
+  return gnuradio::get_initial_sptr( new snapshot_tap( itemsize, length, interval ) );
+}
+
+snapshot_tap::snapshot_tap( size_t itemsize, uint64_t length, uint64_t interval )
+  : gr::block( "snapshot_tap",
+               gr::io_signature::make(1, 1, itemsize),
+               gr::io_signature::make(1, 1, itemsize) ),
+    _itemsize( itemsize ),
+    _length( length ),
+    _interval( std::max( interval, length ) ),
+    _take( length ), /* the first snapshot right from the start */
+    _skip( 0 ),
+    _snapshots( 0 )
+{
+}
+
+void snapshot_tap::set_interval( uint64_t interval )
+{
+  std::lock_guard< std::mutex > lock( _mutex );
+
+  _interval = std::max( interval, _length );
+  _skip = std::min( _skip, _interval - _length );
+}
+
+void snapshot_tap::trigger()
+{
+  std::lock_guard< std::mutex > lock( _mutex );
+
+  if ( ! _take ) {
+    _take = _length;
+    _skip = 0;
+  }
+}
+
+uint64_t snapshot_tap::snapshots()
+{
+  std::lock_guard< std::mutex > lock( _mutex );
+  return _snapshots;
+}
+
+int snapshot_tap::general_work( int noutput_items,
+                                gr_vector_int &ninput_items,
+                                gr_vector_const_void_star &input_items,
+                                gr_vector_void_star &output_items )
+{
+  const char *in = static_cast< const char * >( input_items[0] );
+  char *out = static_cast< char * >( output_items[0] );
+
+  const uint64_t available = ninput_items[0];
+  uint64_t consumed = 0, produced = 0;
+
+  std::lock_guard< std::mutex > lock( _mutex );
+
+  while ( consumed < available ) {
+    if ( _take ) {
+      const uint64_t n = std::min( std::min( _take, available - consumed ),
+                                   uint64_t(noutput_items) - produced );
+      if ( ! n )
+        break; /* no room left for the snapshot */
+
+      memcpy( out + produced * _itemsize, in + consumed * _itemsize, n * _itemsize );
+      consumed += n;
+      produced += n;
+
+      if ( ! (_take -= n) ) {
+        _skip = _interval - _length;
+        _snapshots++;
+      }
+    } else {
+      const uint64_t n = std::min( _skip, available - consumed );
+      consumed += n;
+
+      if ( ! (_skip -= n) )
+        _take = _length;
+    }
+  }
+
+  consume_each( consumed );
+  return produced;
+}
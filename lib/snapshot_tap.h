@@ -0,0 +1,73 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef INCLUDED_OSMOSDR_SNAPSHOT_TAP_H
+#define INCLUDED_OSMOSDR_SNAPSHOT_TAP_H
+
+#include <gnuradio/block.h>
+
+#include <mutex>
+
+#include <stdint.h>
+
+class snapshot_tap;
+
+typedef boost::shared_ptr<snapshot_tap> snapshot_tap_sptr;
+
+snapshot_tap_sptr make_snapshot_tap( size_t itemsize, uint64_t length,
+                                     uint64_t interval );
+
+/*!
+ * \brief Passes on a snapshot of length items out of every interval items
+ * and drops the rest unread, feeding estimators which do not need to see
+ * the full rate stream. trigger() starts the next snapshot right away.
+ */
+class snapshot_tap : public gr::block
+{
+private:
+  friend snapshot_tap_sptr make_snapshot_tap( size_t itemsize, uint64_t length,
+                                              uint64_t interval );
+
+  snapshot_tap( size_t itemsize, uint64_t length, uint64_t interval );
+
+public:
+  void set_interval( uint64_t interval );
+  void trigger( void );
+
+  /* number of snapshots passed on completely */
+  uint64_t snapshots( void );
+
+  int general_work( int noutput_items,
+                    gr_vector_int &ninput_items,
+                    gr_vector_const_void_star &input_items,
+                    gr_vector_void_star &output_items );
+
+private:
+  std::mutex _mutex;
+
+  size_t _itemsize;
+  uint64_t _length;
+  uint64_t _interval;
+
+  uint64_t _take; /* left in the current snapshot */
+  uint64_t _skip; /* left to drop until the next one */
+  uint64_t _snapshots;
+};
+
+#endif /* INCLUDED_OSMOSDR_SNAPSHOT_TAP_H */
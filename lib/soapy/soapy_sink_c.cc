@@ -30,6 +30,7 @@
 
 #include <iostream>
 #include <algorithm> //find
+#include <limits>
 
 #include <boost/assign.hpp>
 #include <boost/format.hpp>
@@ -42,6 +43,7 @@
 #include "soapy_common.h"
 #include <SoapySDR/Device.hpp>
 #include <SoapySDR/Version.hpp>
+#include <SoapySDR/Errors.hpp>
 
 using namespace boost::assign;
 
@@ -60,16 +62,27 @@ soapy_sink_c_sptr make_soapy_sink_c (const std::string &args)
 soapy_sink_c::soapy_sink_c (const std::string &args)
   : gr::sync_block ("soapy_sink_c",
                     args_to_io_signature(args),
-                    gr::io_signature::make (0, 0, 0))
+                    gr::io_signature::make (0, 0, 0)),
+    _active(false),
+    _prefill(0)
 {
+    dict_t dict = params_to_dict(args);
+    if (dict.count("prefill"))
+    {
+        _monitor.set_prefill(dict["prefill"]);
+        dict.erase("prefill");
+    }
+    _monitor.attach(this);
+
     {
         std::lock_guard<std::mutex> l(get_soapy_maker_mutex());
-        _device = SoapySDR::Device::make(params_to_dict(args));
+        _device = SoapySDR::Device::make(dict);
     }
     _nchan = std::max(1, args_to_io_signature(args)->max_streams());
     std::vector<size_t> channels;
     for (size_t i = 0; i < _nchan; i++) channels.push_back(i);
     _stream = _device->setupStream(SOAPY_SDR_TX, "CF32", channels);
+    _held.resize(_nchan);
 }
 
 soapy_sink_c::~soapy_sink_c(void)
@@ -81,24 +94,80 @@ soapy_sink_c::~soapy_sink_c(void)
 
 bool soapy_sink_c::start()
 {
-    return _device->activateStream(_stream) == 0;
+    //the stream is activated by work() once prefilled
+    _active = false;
+    _prefill = _monitor.prefill(this->get_sample_rate(),
+                                _device->getStreamMTU(_stream),
+                                std::numeric_limits<uint64_t>::max());
+    for (size_t i = 0; i < _nchan; i++) _held[i].clear();
+    return true;
 }
 
 bool soapy_sink_c::stop()
 {
+    //a transmission shorter than the prefill still goes out
+    if (not _active and not _held[0].empty() and not activate()) return false;
+    if (not _active) return true;
+    _active = false;
     return _device->deactivateStream(_stream) == 0;
 }
 
+bool soapy_sink_c::activate(void)
+{
+    if (_device->activateStream(_stream) != 0) return false;
+    _active = true;
+
+    //write the held back samples in a row
+    size_t done = 0;
+    while (done < _held[0].size())
+    {
+        std::vector<const void *> buffs(_nchan);
+        for (size_t i = 0; i < _nchan; i++) buffs[i] = &_held[i][done];
+        int flags = 0;
+        int ret = _device->writeStream(
+            _stream, &buffs[0], _held[0].size() - done, flags, 0);
+        if (ret == SOAPY_SDR_UNDERFLOW) _monitor.underflow(0);
+        else if (ret < 0) break;
+        else done += ret;
+    }
+
+    for (size_t i = 0; i < _nchan; i++) _held[i].clear();
+    return true;
+}
+
+void soapy_sink_c::count_underflows(void)
+{
+    size_t chanMask = 0;
+    int flags = 0;
+    long long timeNs = 0;
+    while (_device->readStreamStatus(_stream, chanMask, flags, timeNs, 0) == SOAPY_SDR_UNDERFLOW)
+        _monitor.underflow(0);
+}
+
 int soapy_sink_c::work( int noutput_items,
                             gr_vector_const_void_star &input_items,
                             gr_vector_void_star &output_items )
 {
+    if (not _active)
+    {
+        for (size_t i = 0; i < _nchan; i++)
+        {
+            const gr_complex *in = (const gr_complex *)input_items[i];
+            _held[i].insert(_held[i].end(), in, in + noutput_items);
+        }
+        if (_held[0].size() >= _prefill and not activate()) return WORK_DONE;
+        return noutput_items;
+    }
+
+    count_underflows();
+
     int flags = 0;
     long long timeNs = 0;
     int ret = _device->writeStream(
         _stream, &input_items[0],
         noutput_items, flags, timeNs);
 
+    if (ret == SOAPY_SDR_UNDERFLOW) _monitor.underflow(0);
     if (ret < 0) return 0; //call again
     return ret;
 }
@@ -23,9 +23,13 @@
 
 #include <gnuradio/block.h>
 #include <gnuradio/sync_block.h>
+#include <gnuradio/gr_complex.h>
 
 #include "osmosdr/ranges.h"
 #include "sink_iface.h"
+#include "tx_monitor.h"
+
+#include <vector>
 
 class soapy_sink_c;
 
@@ -129,10 +133,20 @@ void set_time_now(const ::osmosdr::time_spec_t &time_spec,
 void set_time_next_pps(const ::osmosdr::time_spec_t &time_spec);
 void set_time_unknown_pps(const ::osmosdr::time_spec_t &time_spec);
 
+tx_monitor *get_tx_monitor( void ) { return &_monitor; }
+
 private:
+    bool activate(void);
+    void count_underflows(void);
+
     SoapySDR::Device *_device;
     SoapySDR::Stream *_stream;
     size_t _nchan;
+
+    bool _active; //activated once prefilled
+    uint64_t _prefill;
+    std::vector<std::vector<gr_complex> > _held;
+    tx_monitor _monitor;
 };
 
 #endif /* INCLUDED_SOAPY_SINK_C_H */
@@ -25,6 +25,12 @@
 #include <osmosdr/time_spec.h>
 #include <gnuradio/basic_block.h>
 
+#include "stream_type.h"
+
+class stream_tagger;
+class iq_corrector;
+class signal_monitor;
+
 /*!
  * TODO: document
  *
@@ -395,6 +401,84 @@ public:
    * \param time_spec the new time
    */
   virtual void set_time_unknown_pps(const ::osmosdr::time_spec_t &time_spec) { }
+
+  /*!
+   * Set the device time at which the following control calls take effect.
+   * \param time_spec the time the commands take effect at
+   * \param mboard the motherboard index 0 to M-1
+   * \return false if the device has no timed commands, the caller has to
+   * wait for the time itself then
+   */
+  virtual bool set_command_time(const ::osmosdr::time_spec_t &time_spec,
+                                size_t mboard = 0) { return false; }
+
+  /*!
+   * Tell whether set_command_time() only times the retunes of the device,
+   * the caller has to wait for the time before the other control calls.
+   */
+  virtual bool command_time_retunes_only( void ) { return false; }
+
+  /*!
+   * Apply the following control calls as soon as possible again.
+   * \param mboard the motherboard index 0 to M-1
+   */
+  virtual void clear_command_time(size_t mboard = 0) { }
+
+  /*!
+   * Get the tagger discarding the samples captured while the device was
+   * being reconfigured, required for frequency hopping.
+   * \return the tagger or NULL if the backend does not keep track
+   */
+  virtual stream_tagger *get_stream_tagger( void ) { return NULL; }
+
+  /*!
+   * Get the software DC offset and IQ imbalance correction the backend
+   * applies to its samples, making external correction blocks redundant.
+   * \return the corrector or NULL if the backend has none
+   */
+  virtual iq_corrector *get_iq_corrector( void ) { return NULL; }
+
+  /*!
+   * Get the statistics the backend gathers on its samples.
+   * \return the monitor or NULL if the backend does not gather any
+   */
+  virtual signal_monitor *get_signal_monitor( void ) { return NULL; }
+
+  /*!
+   * Shift the samples of a channel in frequency while converting them,
+   * bringing the given offset within the band to 0 Hz.
+   * \param freq the offset in Hz
+   * \param chan the channel index 0 to N-1
+   * \return false if the backend can't, the caller has to shift them then
+   */
+  virtual bool set_freq_shift( double freq, size_t chan = 0 ) { return false; }
+
+  /*!
+   * Switch the outputs of the block to the given sample type, called
+   * before the block is connected.
+   * \param type the stream type
+   * \return false if the backend only delivers fc32, it is converted then
+   */
+  virtual bool set_stream_type( stream_type_t type ) { return type == STREAM_FC32; }
+
+  /*!
+   * Record the settings instead of applying them, until commit_config()
+   * or the start of streaming. Backends not supporting this apply them
+   * right away.
+   */
+  virtual void begin_config( void ) { }
+
+  /*!
+   * Apply the final value of every setting recorded since begin_config().
+   */
+  virtual void commit_config( void ) { }
+
+  /*!
+   * Get a counter bumped whenever recorded settings were applied, by
+   * commit_config() or the start of streaming. Values read before a change
+   * may be stale.
+   */
+  virtual unsigned int get_config_generation( void ) { return 0; }
 };
 
 #endif // OSMOSDR_SOURCE_IFACE_H
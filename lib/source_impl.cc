@@ -32,73 +32,45 @@
 #include <gnuradio/blocks/throttle.h>
 #include <gnuradio/constants.h>
 
-#ifdef ENABLE_OSMOSDR
-#include <osmosdr_src_c.h>
-#endif
-
-#ifdef ENABLE_FCD
-#include <fcd_source_c.h>
-#endif
-
-#ifdef ENABLE_FILE
-#include <file_source_c.h>
-#endif
-
-#ifdef ENABLE_RTL
-#include <rtl_source_c.h>
-#endif
-
-#ifdef ENABLE_RTL_TCP
-#include <rtl_tcp_source_c.h>
-#endif
-
-#ifdef ENABLE_UHD
-#include <uhd_source_c.h>
-#endif
-
-#ifdef ENABLE_MIRI
-#include <miri_source_c.h>
-#endif
-
-#ifdef ENABLE_SDRPLAY
-#include <sdrplay_source_c.h>
-#endif
+#include <boost/algorithm/string.hpp>
+#include <boost/bind.hpp>
 
-#ifdef ENABLE_HACKRF
-#include <hackrf_source_c.h>
-#endif
+#include <osmosdr/device.h>
 
-#ifdef ENABLE_BLADERF
-#include <bladerf_source_c.h>
-#endif
+#include <algorithm>
+#include <iostream>
+#include <cmath>
 
-#ifdef ENABLE_RFSPACE
-#include <rfspace_source_c.h>
-#endif
-
-#ifdef ENABLE_AIRSPY
-#include <airspy_source_c.h>
-#endif
+#include "arg_helpers.h"
+#include "backend_registry.h"
+#include "channelizer.h"
+#include "energy_gate.h"
+#include "parallel_helpers.h"
+#include "psd_estimator.h"
+#include "signal_monitor.h"
+#include "source_impl.h"
+#include "stream_converter.h"
 
-#ifdef ENABLE_AIRSPYHF
-#include <airspyhf_source_c.h>
-#endif
+#define PSD_AVERAGES 8 /* FFTs averaged into one spectrum */
+#define PSD_RATE 10.0 /* spectra per second */
+#define PSD_WINDOW "blackmanharris"
 
-#ifdef ENABLE_SOAPY
-#include <soapy_source_c.h>
-#endif
+#define GATE_HYSTERESIS 3.0 /* dB between opening and closing */
+#define GATE_PRE_ROLL 1e-3 /* seconds */
+#define GATE_POST_ROLL 1e-3 /* seconds */
 
-#ifdef ENABLE_REDPITAYA
-#include <redpitaya_source_c.h>
-#endif
+#ifdef HAVE_IQBALANCE
+#define IQ_SNAPSHOT_LEN 8192 /* samples the estimator looks at in one go */
+#define IQ_SNAPSHOT_INTERVAL 1.0 /* seconds between snapshots */
+#define IQ_CACHE_FREQ_STEP 1e6 /* Hz covered by a cached correction */
+#define IQ_CACHE_GAIN_STEP 1.0 /* dB covered by a cached correction */
 
-#ifdef ENABLE_FREESRP
-#include <freesrp_source_c.h>
+static uint64_t iq_snapshot_interval( double rate )
+{
+  return uint64_t( rate * IQ_SNAPSHOT_INTERVAL );
+}
 #endif
 
-#include "arg_helpers.h"
-#include "source_impl.h"
-
 /*
  * Create a new instance of source_impl and return
  * a boost shared_ptr.  This is effectively the public constructor.
@@ -109,6 +81,20 @@ osmosdr::source::make( const std::string &args )
   return gnuradio::get_initial_sptr( new source_impl(args) );
 }
 
+/*
+ * Instantiate the backend selected by a single device argument string.
+ * block and iface are left untouched if no backend matches.
+ */
+static void make_source_dev( const std::string &arg,
+                             gr::basic_block_sptr &block,
+                             source_iface *&iface )
+{
+  backend_t backend;
+
+  if ( backend_registry::instance().find_source( arg, backend ) )
+    backend.make_source( arg, block, iface );
+}
+
 /*
  * The private constructor
  */
@@ -123,56 +109,8 @@ source_impl::source_impl( const std::string &args )
 
   std::vector< std::string > arg_list = args_to_vector(args);
 
-  std::vector< std::string > dev_types;
+  std::vector< std::string > dev_types = backend_registry::instance().source_names();
 
-#ifdef ENABLE_FILE
-  dev_types.push_back("file");
-#endif
-#ifdef ENABLE_OSMOSDR
-  dev_types.push_back("osmosdr");
-#endif
-#ifdef ENABLE_FCD
-  dev_types.push_back("fcd");
-#endif
-#ifdef ENABLE_RTL
-  dev_types.push_back("rtl");
-#endif
-#ifdef ENABLE_RTL_TCP
-  dev_types.push_back("rtl_tcp");
-#endif
-#ifdef ENABLE_UHD
-  dev_types.push_back("uhd");
-#endif
-#ifdef ENABLE_MIRI
-  dev_types.push_back("miri");
-#endif
-#ifdef ENABLE_SDRPLAY
-  dev_types.push_back("sdrplay");
-#endif
-#ifdef ENABLE_HACKRF
-  dev_types.push_back("hackrf");
-#endif
-#ifdef ENABLE_BLADERF
-  dev_types.push_back("bladerf");
-#endif
-#ifdef ENABLE_RFSPACE
-  dev_types.push_back("rfspace");
-#endif
-#ifdef ENABLE_AIRSPY
-  dev_types.push_back("airspy");
-#endif
-#ifdef ENABLE_AIRSPYHF
-  dev_types.push_back("airspyhf");
-#endif
-#ifdef ENABLE_SOAPY
-  dev_types.push_back("soapy");
-#endif
-#ifdef ENABLE_REDPITAYA
-  dev_types.push_back("redpitaya");
-#endif
-#ifdef ENABLE_FREESRP
-  dev_types.push_back("freesrp");
-#endif
   std::cerr << "gr-osmosdr "
             << GR_OSMOSDR_VERSION << " (" << GR_OSMOSDR_LIBVER << ") "
             << "gnuradio " << gr::version() << std::endl;
@@ -181,12 +119,8 @@ source_impl::source_impl( const std::string &args )
     std::cerr << dev_type << " ";
   std::cerr << std::endl;
 
-#ifdef ENABLE_RFSPACE
-  dev_types.push_back("sdr-iq"); /* additional aliases for rfspace backend */
-  dev_types.push_back("sdr-ip");
-  dev_types.push_back("netsdr");
-  dev_types.push_back("cloudiq");
-#endif
+  /* match on every key, including aliases like "sdr-iq" for rfspace */
+  dev_types = backend_registry::instance().source_keys();
 
   BOOST_FOREACH(std::string arg, arg_list) {
     dict_t dict = params_to_dict(arg);
@@ -199,220 +133,247 @@ source_impl::source_impl( const std::string &args )
   }
 
   if ( ! device_specified ) {
-    std::vector< std::string > dev_list;
-#ifdef ENABLE_OSMOSDR
-    BOOST_FOREACH( std::string dev, osmosdr_src_c::get_devices() )
-      dev_list.push_back( dev );
-#endif
-#ifdef ENABLE_FCD
-    BOOST_FOREACH( std::string dev, fcd_source_c::get_devices() )
-      dev_list.push_back( dev );
-#endif
-#ifdef ENABLE_RTL
-    BOOST_FOREACH( std::string dev, rtl_source_c::get_devices() )
-      dev_list.push_back( dev );
-#endif
-#ifdef ENABLE_UHD
-    BOOST_FOREACH( std::string dev, uhd_source_c::get_devices() )
-      dev_list.push_back( dev );
-#endif
-#ifdef ENABLE_MIRI
-    BOOST_FOREACH( std::string dev, miri_source_c::get_devices() )
-      dev_list.push_back( dev );
-#endif
-#ifdef ENABLE_SDRPLAY
-    BOOST_FOREACH( std::string dev, sdrplay_source_c::get_devices() )
-      dev_list.push_back( dev );
-#endif
-#ifdef ENABLE_BLADERF
-    BOOST_FOREACH( std::string dev, bladerf_source_c::get_devices() )
-      dev_list.push_back( dev );
-#endif
-#ifdef ENABLE_RFSPACE
-    BOOST_FOREACH( std::string dev, rfspace_source_c::get_devices() )
-      dev_list.push_back( dev );
-#endif
-#ifdef ENABLE_HACKRF
-    BOOST_FOREACH( std::string dev, hackrf_source_c::get_devices() )
-      dev_list.push_back( dev );
-#endif
-#ifdef ENABLE_AIRSPY
-    BOOST_FOREACH( std::string dev, airspy_source_c::get_devices() )
-      dev_list.push_back( dev );
-#endif
-#ifdef ENABLE_AIRSPYHF
-    BOOST_FOREACH( std::string dev, airspyhf_source_c::get_devices() )
-      dev_list.push_back( dev );
-#endif
-#ifdef ENABLE_SOAPY
-    BOOST_FOREACH( std::string dev, soapy_source_c::get_devices() )
-      dev_list.push_back( dev );
-#endif
-#ifdef ENABLE_REDPITAYA
-    BOOST_FOREACH( std::string dev, redpitaya_source_c::get_devices() )
-      dev_list.push_back( dev );
-#endif
-#ifdef ENABLE_FREESRP
-    BOOST_FOREACH( std::string dev, freesrp_source_c::get_devices() )
-      dev_list.push_back( dev );
-#endif
-
-//    std::cerr << std::endl;
-//    BOOST_FOREACH( std::string dev, dev_list )
-//      std::cerr << "'" << dev << "'" << std::endl;
+    /* goes through the shared discovery cache instead of probing again */
+    osmosdr::devices_t dev_list = osmosdr::device::find( osmosdr::device_t("nofake") );
 
     if ( dev_list.size() )
-      arg_list.push_back( dev_list.front() );
+      arg_list.push_back( dev_list.front().to_string() );
     else
       throw std::runtime_error("No supported devices found (check the connection and/or udev rules).");
   }
 
-  BOOST_FOREACH(std::string arg, arg_list) {
+  /* open and configure the devices concurrently, but keep the results in
+   * argument order so the channel numbering does not depend on scheduling */
+  std::vector< gr::basic_block_sptr > blocks( arg_list.size() );
+  std::vector< source_iface * > ifaces( arg_list.size(), NULL );
+  std::vector< task_t > tasks;
 
-    dict_t dict = params_to_dict(arg);
+  for (size_t d = 0; d < arg_list.size(); d++)
+    tasks.push_back( [&arg_list, &blocks, &ifaces, d]() {
+      make_source_dev( arg_list[d], blocks[d], ifaces[d] );
+    } );
 
-//    std::cerr << std::endl;
-//    BOOST_FOREACH( dict_t::value_type &entry, dict )
-//      std::cerr << "'" << entry.first << "' = '" << entry.second << "'" << std::endl;
+  run_in_parallel( tasks, arg_list );
 
-    source_iface *iface = NULL;
-    gr::basic_block_sptr block;
+  message_port_register_hier_out( pmt::mp("psd") );
+  message_port_register_hier_out( pmt::mp("signal_stats") );
 
-#ifdef ENABLE_OSMOSDR
-    if ( dict.count("osmosdr") ) {
-      osmosdr_src_c_sptr src = osmosdr_make_src_c( arg );
-      block = src; iface = src.get();
-    }
-#endif
+  const stream_type_t stream_type = args_to_stream_type( args );
 
-#ifdef ENABLE_FCD
-    if ( dict.count("fcd") ) {
-      fcd_source_c_sptr src = make_fcd_source_c( arg );
-      block = src; iface = src.get();
-    }
-#endif
+  /* virtual channels are numbered after all the device channels */
+  std::vector< std::pair< gr::basic_block_sptr, int > > virt_outputs;
 
-#ifdef ENABLE_FILE
-    if ( dict.count("file") ) {
-      file_source_c_sptr src = make_file_source_c( arg );
-      block = src; iface = src.get();
-    }
-#endif
+  for (size_t d = 0; d < arg_list.size(); d++) {
+    source_iface *iface = ifaces[d];
+    gr::basic_block_sptr block = blocks[d];
 
-#ifdef ENABLE_RTL
-    if ( dict.count("rtl") ) {
-      rtl_source_c_sptr src = make_rtl_source_c( arg );
-      block = src; iface = src.get();
-    }
-#endif
+    if ( iface != NULL && long(block.get()) != 0 ) {
+      _devs.push_back( iface );
 
-#ifdef ENABLE_RTL_TCP
-    if ( dict.count("rtl_tcp") ) {
-      rtl_tcp_source_c_sptr src = make_rtl_tcp_source_c( arg );
-      block = src; iface = src.get();
-    }
-#endif
+      const bool native = iface->set_stream_type( stream_type );
 
-#ifdef ENABLE_UHD
-    if ( dict.count("uhd") ) {
-      uhd_source_c_sptr src = make_uhd_source_c( arg );
-      block = src; iface = src.get();
-    }
-#endif
+      if ( signal_monitor *monitor = iface->get_signal_monitor() ) {
+        monitor->set_first_channel( _chans.size() );
+        msg_connect( block, "signal_stats", self(), "signal_stats" );
+      }
 
-#ifdef ENABLE_MIRI
-    if ( dict.count("miri") ) {
-      miri_source_c_sptr src = make_miri_source_c( arg );
-      block = src; iface = src.get();
-    }
-#endif
+      /* the full band output of each channel, where virtual channels tap in,
+       * connected to the outputs of the block after all of them are made */
+      std::vector< std::pair< gr::basic_block_sptr, int > > wideband;
 
-#ifdef ENABLE_SDRPLAY
-    if ( dict.count("sdrplay") ) {
-      sdrplay_source_c_sptr src = make_sdrplay_source_c( arg );
-      block = src; iface = src.get();
-    }
+      for (size_t i = 0; i < iface->get_num_channels(); i++) {
+        _chans.push_back( channel_t( iface, _devs.size() - 1, i ) );
+
+        /* integer samples are passed on without software correction */
+        if ( stream_type != STREAM_FC32 ) {
+          if ( native ) {
+            wideband.push_back( std::make_pair( block, int(i) ) );
+          } else {
+            stream_converter_sptr conv = make_stream_converter( STREAM_FC32, stream_type );
+            connect(block, i, conv, 0);
+            wideband.push_back( std::make_pair( conv, 0 ) );
+          }
+#ifdef HAVE_IQBALANCE
+          _iq_opt.push_back( NULL );
+          _iq_fix.push_back( NULL );
+          _iq_tap.push_back( NULL );
 #endif
+          continue;
+        }
 
-#ifdef ENABLE_HACKRF
-    if ( dict.count("hackrf") ) {
-      hackrf_source_c_sptr src = make_hackrf_source_c( arg );
-      block = src; iface = src.get();
-    }
-#endif
+#ifdef HAVE_IQBALANCE
+        if ( iface->get_iq_corrector() ) { /* corrected by the backend */
+          wideband.push_back( std::make_pair( block, int(i) ) );
+          _iq_opt.push_back( NULL );
+          _iq_fix.push_back( NULL );
+          _iq_tap.push_back( NULL );
+          continue;
+        }
 
-#ifdef ENABLE_BLADERF
-    if ( dict.count("bladerf") ) {
-      bladerf_source_c_sptr src = make_bladerf_source_c( arg );
-      block = src; iface = src.get();
-    }
-#endif
+        gr::iqbalance::optimize_c::sptr iq_opt = gr::iqbalance::optimize_c::make( 0 );
+        gr::iqbalance::fix_cc::sptr     iq_fix = gr::iqbalance::fix_cc::make();
 
-#ifdef ENABLE_RFSPACE
-    if ( dict.count("rfspace") ||
-         dict.count("sdr-iq") ||
-         dict.count("sdr-ip") ||
-         dict.count("netsdr") ||
-         dict.count("cloudiq") ) {
-      rfspace_source_c_sptr src = make_rfspace_source_c( arg );
-      block = src; iface = src.get();
-    }
-#endif
+        /* the estimator only looks at short snapshots of the stream */
+        snapshot_tap_sptr iq_tap =
+            make_snapshot_tap( sizeof(gr_complex), IQ_SNAPSHOT_LEN,
+                               iq_snapshot_interval( iface->get_sample_rate() ) );
 
-#ifdef ENABLE_AIRSPY
-    if ( dict.count("airspy") ) {
-      airspy_source_c_sptr src = make_airspy_source_c( arg );
-      block = src; iface = src.get();
-    }
-#endif
+        connect(block, i, iq_fix, 0);
+        wideband.push_back( std::make_pair( iq_fix, 0 ) );
 
-#ifdef ENABLE_AIRSPYHF
-    if ( dict.count("airspyhf") ) {
-      airspyhf_source_c_sptr src = make_airspyhf_source_c( arg );
-      block = src; iface = src.get();
-    }
-#endif
+        connect(block, i, iq_tap, 0);
+        connect(iq_tap, 0, iq_opt, 0);
+        msg_connect(iq_opt, "iqbal_corr", iq_fix, "iqbal_corr");
 
-#ifdef ENABLE_SOAPY
-    if ( dict.count("soapy") ) {
-      soapy_source_c_sptr src = make_soapy_source_c( arg );
-      block = src; iface = src.get();
-    }
+        _iq_opt.push_back( iq_opt.get() );
+        _iq_fix.push_back( iq_fix.get() );
+        _iq_tap.push_back( iq_tap.get() );
+#else
+        wideband.push_back( std::make_pair( block, int(i) ) );
 #endif
+      }
 
-#ifdef ENABLE_REDPITAYA
-    if ( dict.count("redpitaya") ) {
-      redpitaya_source_c_sptr src = make_redpitaya_source_c( arg );
-      block = src; iface = src.get();
-    }
-#endif
+      dict_t dict = params_to_dict( arg_list[d] );
 
-#ifdef ENABLE_FREESRP
-    if ( dict.count("freesrp") ) {
-      freesrp_source_c_sptr src = make_freesrp_source_c( arg );
-      block = src; iface = src.get();
-    }
-#endif
+      if ( dict.count( "lo_shift" ) ) {
+        if ( stream_type != STREAM_FC32 )
+          throw std::runtime_error( "lo_shift needs fc32 samples." );
 
-    if ( iface != NULL && long(block.get()) != 0 ) {
-      _devs.push_back( iface );
+        const double lo_shift = boost::lexical_cast< double >( dict["lo_shift"] );
 
-      for (size_t i = 0; i < iface->get_num_channels(); i++) {
-#ifdef HAVE_IQBALANCE
-        gr::iqbalance::optimize_c::sptr iq_opt = gr::iqbalance::optimize_c::make( 0 );
-        gr::iqbalance::fix_cc::sptr     iq_fix = gr::iqbalance::fix_cc::make();
+        /* the rx_freq tags report the channel, not the device */
+        if ( stream_tagger *tagger = iface->get_stream_tagger() )
+          tagger->set_freq_offset( -lo_shift );
 
-        connect(block, i, iq_fix, 0);
-        connect(iq_fix, 0, self(), channel++);
+        for (size_t i = 0; i < wideband.size(); i++) {
+          channel_t &ch = _chans[ _chans.size() - wideband.size() + i ];
+          ch.soft_tune = true;
+          ch.lo_shift = lo_shift;
 
-        connect(block, i, iq_opt, 0);
-        msg_connect(iq_opt, "iqbal_corr", iq_fix, "iqbal_corr");
+          /* shifted back while converting, by a rotator if the backend can't */
+          if ( ! iface->set_freq_shift( -lo_shift, ch.dev_chan ) ) {
+            gr::blocks::rotator_cc::sptr rotator = gr::blocks::rotator_cc::make( 0 );
+            connect(wideband[i].first, wideband[i].second, rotator, 0);
+            wideband[i] = std::make_pair( rotator, 0 );
+            ch.rotator = rotator.get();
+          }
+        }
+      }
 
-        _iq_opt.push_back( iq_opt.get() );
-        _iq_fix.push_back( iq_fix.get() );
-#else
-        connect(block, i, self(), channel++);
-#endif
+      if ( dict.count( "gate" ) ) {
+        if ( stream_type != STREAM_FC32 )
+          throw std::runtime_error( "gate needs fc32 samples." );
+
+        double hysteresis = GATE_HYSTERESIS, pre_roll = GATE_PRE_ROLL;
+        double post_roll = GATE_POST_ROLL, min_duration = 0;
+        if ( dict.count( "gate_hyst" ) )
+          hysteresis = boost::lexical_cast< double >( dict["gate_hyst"] );
+        if ( dict.count( "gate_pre" ) )
+          pre_roll = boost::lexical_cast< double >( dict["gate_pre"] );
+        if ( dict.count( "gate_post" ) )
+          post_roll = boost::lexical_cast< double >( dict["gate_post"] );
+        if ( dict.count( "gate_min" ) )
+          min_duration = boost::lexical_cast< double >( dict["gate_min"] );
+
+        for (size_t i = 0; i < wideband.size(); i++) {
+          energy_gate_sptr gate =
+              make_energy_gate( boost::lexical_cast< double >( dict["gate"] ),
+                                hysteresis, pre_roll, post_roll, min_duration );
+          gate->set_rate( iface->get_sample_rate() );
+
+          connect(wideband[i].first, wideband[i].second, gate, 0);
+          connect(gate, 0, self(), channel++);
+          _gates.push_back( gate.get() );
+        }
+      } else {
+        for (size_t i = 0; i < wideband.size(); i++)
+          connect(wideband[i].first, wideband[i].second, self(), channel++);
+      }
+
+      if ( dict.count( "channelize" ) ) {
+        if ( stream_type != STREAM_FC32 )
+          throw std::runtime_error( "channelize needs fc32 samples." );
+
+        const size_t nchan = boost::lexical_cast< size_t >( dict["channelize"] );
+        size_t nthreads = 1;
+        if ( dict.count( "threads" ) )
+          nthreads = boost::lexical_cast< size_t >( dict["threads"] );
+
+        for (size_t i = 0; i < wideband.size(); i++) {
+          channelizer_sptr chz = make_channelizer( nchan, nthreads );
+          if ( dict.count( "bw" ) )
+            chz->set_bandwidth( boost::lexical_cast< double >( dict["bw"] ) );
+
+          connect(wideband[i].first, wideband[i].second, chz, 0);
+          _channelizers.push_back( chz.get() );
+
+          for (size_t k = 0; k < nchan; k++) {
+            virtual_channel_t virt = { _chans.size() - wideband.size() + i, chz.get(), NULL, k };
+            _virt.push_back( virt );
+            virt_outputs.push_back( std::make_pair( chz, int(k) ) );
+          }
+        }
+      }
+
+      if ( dict.count( "vfos" ) ) {
+        if ( stream_type != STREAM_FC32 )
+          throw std::runtime_error( "vfos need fc32 samples." );
+
+        /* one decimation per receiver, the last one repeated for the rest */
+        std::vector< size_t > decimations( boost::lexical_cast< size_t >( dict["vfos"] ), 1 );
+        std::vector< std::string > factors;
+        if ( dict.count( "vfo_decim" ) )
+          boost::algorithm::split( factors, dict["vfo_decim"], boost::is_any_of( ":" ) );
+
+        for (size_t k = 0; k < decimations.size() && factors.size(); k++)
+          decimations[k] = boost::lexical_cast< size_t >( factors[ std::min( k, factors.size() - 1 ) ] );
+
+        for (size_t i = 0; i < wideband.size(); i++) {
+          vfo_bank_sptr vfos = make_vfo_bank( decimations );
+
+          connect(wideband[i].first, wideband[i].second, vfos, 0);
+          _vfo_banks.push_back( vfos.get() );
+
+          for (size_t k = 0; k < decimations.size(); k++) {
+            virtual_channel_t virt = { _chans.size() - wideband.size() + i, NULL, vfos.get(), k };
+            _virt.push_back( virt );
+            virt_outputs.push_back( std::make_pair( vfos, int(k) ) );
+          }
+        }
+      }
+
+      if ( dict.count( "psd" ) ) {
+        if ( stream_type != STREAM_FC32 )
+          throw std::runtime_error( "psd needs fc32 samples." );
+
+        const size_t fft_size = boost::lexical_cast< size_t >( dict["psd"] );
+        size_t averages = PSD_AVERAGES;
+        if ( dict.count( "psd_avg" ) )
+          averages = boost::lexical_cast< size_t >( dict["psd_avg"] );
+        double frame_rate = PSD_RATE;
+        if ( dict.count( "psd_rate" ) )
+          frame_rate = boost::lexical_cast< double >( dict["psd_rate"] );
+        std::string window = PSD_WINDOW;
+        if ( dict.count( "psd_window" ) )
+          window = dict["psd_window"];
+
+        for (size_t i = 0; i < wideband.size(); i++) {
+          psd_estimator_sptr psd =
+              make_psd_estimator( _chans.size() - wideband.size() + i,
+                                  fft_size, averages, window, frame_rate );
+          psd->set_rate( iface->get_sample_rate() );
+
+          /* the scheduler only moves the samples the spectra are made of */
+          snapshot_tap_sptr psd_tap =
+              make_snapshot_tap( sizeof(gr_complex), psd->snapshot_length(),
+                                 psd->snapshot_interval() );
+
+          connect(wideband[i].first, wideband[i].second, psd_tap, 0);
+          connect(psd_tap, 0, psd, 0);
+          msg_connect(psd, "psd", self(), "psd");
+
+          _psd.push_back( std::make_pair( psd_tap.get(), psd.get() ) );
+        }
       }
     } else if ( (iface != NULL) || (long(block.get()) != 0) )
       throw std::runtime_error("Either iface or block are NULL.");
@@ -421,35 +382,342 @@ source_impl::source_impl( const std::string &args )
 
   if (!_devs.size())
     throw std::runtime_error("No devices specified via device arguments.");
+
+  for (size_t i = 0; i < virt_outputs.size(); i++)
+    connect(virt_outputs[i].first, virt_outputs[i].second, self(), channel++);
+
+  _hoppers.resize( _devs.size() );
+  _config_generations.resize( _devs.size(), 0 );
+
+#ifdef HAVE_IQBALANCE
+  iq_tuning_t untuned = { NAN, NAN, 0 };
+  _iq_tuning.resize( _chans.size(), untuned );
+#endif
+
+  /* the streams of several devices start together from a common epoch */
+  std::vector< stream_tagger * > taggers;
+  for (source_iface *dev : _devs)
+    if ( stream_tagger *tagger = dev->get_stream_tagger() )
+      taggers.push_back( tagger );
+
+  if ( taggers.size() > 1 ) {
+    std::shared_ptr< start_barrier > barrier =
+        std::make_shared< start_barrier >( taggers.size() );
+
+    for (stream_tagger *tagger : taggers)
+      tagger->set_start_barrier( barrier );
+  }
+
+  _command_timer.resize( _devs.size() );
+
+  for (size_t i = 0; i < _chans.size(); i++)
+    if ( _chans[i].rotator )
+      update_shift( i );
+
+  message_port_register_hier_in( pmt::mp("command") );
+  msg_connect( self(), "command",
+               make_command_port( boost::bind( &source_impl::handle_command, this, _1 ) ),
+               "command" );
+}
+
+source_impl::channel_t::channel_t( source_iface *dev, size_t dev_index, size_t dev_chan )
+  : dev(dev),
+    dev_index(dev_index),
+    dev_chan(dev_chan),
+    center_freq(0),
+    freq_corr(0),
+    gain_mode(false),
+    gain(0),
+    if_gain(0),
+    bb_gain(0),
+    bandwidth(0),
+    soft_tune(false),
+    lo_shift(0),
+    freq_residual(0),
+    rotator(NULL)
+{
+}
+
+bool source_impl::channel_t::automatic_gain()
+{
+  return act_gain_mode.get( [this]() { return dev->get_gain_mode( dev_chan ); } );
+}
+
+void source_impl::channel_t::invalidate_gains()
+{
+  act_gain.invalidate();
+  act_named_gain.invalidate();
+}
+
+void source_impl::channel_t::invalidate_band()
+{
+  /* some devices have different gain stages or ranges per band */
+  gain_range.invalidate();
+  named_gain_range.invalidate();
+  invalidate_gains();
+}
+
+void source_impl::channel_t::invalidate()
+{
+  act_center_freq.invalidate();
+  act_freq_corr.invalidate();
+  act_gain_mode.invalidate();
+  act_antenna.invalidate();
+  act_bandwidth.invalidate();
+  freq_range.invalidate();
+  bandwidth_range.invalidate();
+  gain_names.invalidate();
+  antennas.invalidate();
+  invalidate_band();
+}
+
+/* set in the tasks apply_settings() runs for the devices in parallel, they
+ * act under the lock their caller holds */
+static thread_local bool _caller_holds_lock = false;
+
+struct caller_holds_lock_t
+{
+  caller_holds_lock_t() : prev(_caller_holds_lock) { _caller_holds_lock = true; }
+  ~caller_holds_lock_t() { _caller_holds_lock = prev; }
+
+  bool prev;
+};
+
+std::unique_lock< std::recursive_mutex > source_impl::lock_state()
+{
+  if ( _caller_holds_lock )
+    return std::unique_lock< std::recursive_mutex >();
+
+  std::unique_lock< std::recursive_mutex > lock( _mutex );
+  check_config_generations();
+
+  return lock;
+}
+
+/* the devices apply what they recorded on their own as well, at the start
+ * of streaming, the values cached until then may be stale */
+void source_impl::check_config_generations()
+{
+  bool changed = false;
+
+  for (size_t i = 0; i < _devs.size() && i < _config_generations.size(); i++) {
+    const unsigned int generation = _devs[i]->get_config_generation();
+    if ( generation != _config_generations[i] ) {
+      _config_generations[i] = generation;
+      changed = true;
+    }
+  }
+
+  if ( ! changed )
+    return;
+
+  /* the recorded values were reported so far, not the actual ones */
+  refresh_state();
+
+  /* what follows the rate has to catch up with the committed one */
+  const double rate = get_sample_rate();
+  if ( rate != _sample_rate ) {
+    _sample_rate = rate;
+    rate_changed();
+
+#ifdef HAVE_IQBALANCE
+    reset_iq_optimizers();
+#endif
+  }
+
+  for (size_t i = 0; i < _chans.size(); i++) {
+    channel_t &ch = _chans[i];
+    if ( ch.soft_tune ) {
+      ch.freq_residual = ch.freq_corr - ch.dev->get_freq_corr( ch.dev_chan );
+      update_shift( i );
+    }
+  }
 }
 
 size_t source_impl::get_num_channels()
 {
-  size_t channels = 0;
+  return _chans.size() + _virt.size();
+}
 
-  BOOST_FOREACH( source_iface *dev, _devs )
-    channels += dev->get_num_channels();
+size_t source_impl::get_mboard( size_t chan )
+{
+  chan = device_channel( chan );
+
+  if ( chan >= _chans.size() )
+    throw std::runtime_error( "no channel " + std::to_string( chan ) );
+
+  return _chans[ chan ].dev_index;
+}
 
-  return channels;
+source_impl::virtual_channel_t *source_impl::virtual_channel( size_t chan )
+{
+  if ( chan < _chans.size() || chan - _chans.size() >= _virt.size() )
+    return NULL;
+
+  return &_virt[ chan - _chans.size() ];
+}
+
+/* the offset within the band of a soft tuned channel to bring to 0 Hz: the
+ * shift of the device and what it is off by the uncorrected fraction of ppm */
+void source_impl::update_shift( size_t chan )
+{
+  channel_t &ch = _chans[ chan ];
+  if ( ! ch.soft_tune )
+    return;
+
+  const double lo = ch.act_center_freq.get( [&ch]() { return ch.dev->get_center_freq( ch.dev_chan ); } );
+  const double offset = lo * ch.freq_residual * 1e-6 - ch.lo_shift;
+
+  if ( ! ch.rotator ) {
+    ch.dev->set_freq_shift( offset, ch.dev_chan );
+    return;
+  }
+
+  const double rate = get_sample_rate();
+  if ( rate > 0 )
+    ch.rotator->set_phase_inc( -2.0 * M_PI * offset / rate );
+}
+
+/* virtual channels are controlled through the device channel they come from */
+size_t source_impl::device_channel( size_t chan )
+{
+  virtual_channel_t *virt = virtual_channel( chan );
+  return virt ? virt->parent : chan;
+}
+
+void source_impl::rate_changed()
+{
+  _act_sample_rate.set( _sample_rate );
+
+  for (channelizer *chz : _channelizers)
+    chz->set_rate( _sample_rate );
+
+  for (vfo_bank *vfos : _vfo_banks)
+    vfos->set_rate( _sample_rate );
+
+  for (energy_gate *gate : _gates)
+    gate->set_rate( _sample_rate );
+
+  for (size_t i = 0; i < _chans.size(); i++)
+    if ( _chans[i].rotator )
+      update_shift( i );
+
+  for (size_t i = 0; i < _psd.size(); i++) {
+    _psd[i].second->set_rate( _sample_rate );
+    _psd[i].first->set_interval( _psd[i].second->snapshot_interval() );
+  }
+
+  /* automatic filter selection follows the sample rate */
+  for (size_t i = 0; i < _chans.size(); i++) {
+    _chans[i].act_bandwidth.invalidate();
+    _chans[i].bandwidth_range.invalidate();
+  }
+}
+
+void source_impl::refresh_state()
+{
+  auto lock = lock_state();
+
+  _sample_rates.invalidate();
+  _act_sample_rate.invalidate();
+
+  for (size_t i = 0; i < _chans.size(); i++)
+    _chans[i].invalidate();
+}
+
+void source_impl::begin_config()
+{
+  auto lock = lock_state();
+
+  for (source_iface *dev : _devs)
+    dev->begin_config();
+}
+
+void source_impl::commit_config()
+{
+  auto lock = lock_state();
+
+  std::vector< task_t > tasks;
+
+  for (source_iface *dev : _devs)
+    tasks.push_back( [dev]() { dev->commit_config(); } );
+
+  run_in_parallel( tasks );
+
+  check_config_generations();
+}
+
+void source_impl::set_hop_schedule( const osmosdr::hop_schedule_t &hops, size_t chan )
+{
+  chan = device_channel( chan );
+
+  if ( chan >= _chans.size() )
+    return;
+
+  channel_t &ch = _chans[ chan ];
+
+  std::lock_guard< std::mutex > hop_lock( _hop_mutex );
+
+  /* stop the running schedule before the device is handed to a new one,
+   * without the lock its last hop may be waiting for */
+  std::unique_ptr< hop_scheduler > running;
+  {
+    auto lock = lock_state();
+    running.swap( _hoppers[ ch.dev_index ] );
+  }
+  running.reset();
+
+  if ( hops.empty() )
+    return;
+
+  auto lock = lock_state();
+
+  /* the device hops off the center as well */
+  osmosdr::hop_schedule_t device_hops = hops;
+  for (osmosdr::hop_t &hop : device_hops)
+    hop.center_freq += ch.lo_shift;
+
+  _hoppers[ ch.dev_index ].reset(
+        new hop_scheduler( ch.dev, ch.dev_chan, device_hops, [this, &ch, chan]( double freq, double gain ) {
+    auto lock = lock_state();
+
+    ch.center_freq = NAN; /* the next set_center_freq() has to reach the device */
+    ch.act_center_freq.set( freq );
+    ch.invalidate_band();
+    update_shift( chan );
+
+    if ( !std::isnan( gain ) ) {
+      ch.gain = NAN;
+      ch.act_gain.set( gain );
+    }
+#ifdef HAVE_IQBALANCE
+    iq_retuned( chan, freq, gain );
+#endif
+  } ) );
 }
 
 bool source_impl::seek( long seek_point, int whence, size_t chan )
 {
-  size_t channel = 0;
-  BOOST_FOREACH( source_iface *dev, _devs )
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ )
-        return dev->seek( seek_point, whence, dev_chan );
+  auto lock = lock_state();
+
+  chan = device_channel( chan );
 
-  return false;
+  if ( chan >= _chans.size() )
+    return false;
+
+  return _chans[ chan ].dev->seek( seek_point, whence, _chans[ chan ].dev_chan );
 }
 
 #define NO_DEVICES_MSG  "FATAL: No device(s) available to work with."
 
 osmosdr::meta_range_t source_impl::get_sample_rates()
 {
+  auto lock = lock_state();
+
   if ( ! _devs.empty() )
-    return _devs[0]->get_sample_rates(); // assume same devices used in the group
+    return _sample_rates.get( [this]() { // assume same devices used in the group
+      return _devs[0]->get_sample_rates();
+    } );
 #if 0
   else
     throw std::runtime_error(NO_DEVICES_MSG);
@@ -457,48 +725,118 @@ osmosdr::meta_range_t source_impl::get_sample_rates()
   return osmosdr::meta_range_t();;
 }
 
-double source_impl::set_sample_rate(double rate)
-{
-  double sample_rate = 0;
+double source_impl::set_sample_rate(double rate)
+{
+  for (size_t i = 0; i < _devs.size(); i++)
+    wait_command_time( i );
+
+  auto lock = lock_state();
+
+  if (_sample_rate != rate) {
+#if 0
+    if (_devs.empty())
+      throw std::runtime_error(NO_DEVICES_MSG);
+#endif
+    /* every device blocks on its own control transfers, so do them at once */
+    std::vector< double > rates( _devs.size(), 0 );
+    std::vector< task_t > tasks;
+
+    for (size_t i = 0; i < _devs.size(); i++) {
+      double *actual = &rates[i];
+      tasks.push_back( [this, i, rate, actual]() {
+        *actual = _devs[i]->set_sample_rate( rate );
+      } );
+    }
+
+    run_in_parallel( tasks );
+
+    _sample_rate = rates.empty() ? 0 : rates.back();
+    rate_changed();
+
+#ifdef HAVE_IQBALANCE
+    reset_iq_optimizers();
+#endif
+  }
+
+  return _sample_rate;
+}
+
+#ifdef HAVE_IQBALANCE
+void source_impl::reset_iq_optimizers()
+{
+  for (size_t channel = 0; channel < _chans.size() && channel < _iq_opt.size(); channel++) {
+    gr::iqbalance::optimize_c *opt = _iq_opt[channel];
+
+    if ( opt )
+      _iq_tap[channel]->set_interval(
+            iq_snapshot_interval( _chans[channel].dev->get_sample_rate() ) );
+
+    if ( opt && opt->period() > 0 ) { /* optimize is enabled */
+      opt->set_period( IQ_SNAPSHOT_LEN );
+      opt->reset();
+      _iq_tap[channel]->trigger();
+    }
+  }
+}
+
+void source_impl::iq_retuned( size_t chan, double freq, double gain )
+{
+  if ( chan >= _iq_opt.size() || _iq_opt[chan] == NULL )
+    return;
+
+  gr::iqbalance::optimize_c *opt = _iq_opt[chan];
+  gr::iqbalance::fix_cc *fix = _iq_fix[chan];
+  snapshot_tap *tap = _iq_tap[chan];
+
+  if ( opt->period() == 0 ) /* automatic optimization disabled */
+    return;
+
+  /* the one not changed is served from the cached device state */
+  if ( std::isnan( freq ) )
+    freq = get_center_freq( chan );
+  if ( std::isnan( gain ) )
+    gain = get_gain( chan );
 
-  if (_sample_rate != rate) {
-#if 0
-    if (_devs.empty())
-      throw std::runtime_error(NO_DEVICES_MSG);
-#endif
-    BOOST_FOREACH( source_iface *dev, _devs )
-      sample_rate = dev->set_sample_rate(rate);
+  std::lock_guard< std::mutex > lock( _iq_mutex );
 
-#ifdef HAVE_IQBALANCE
-    size_t channel = 0;
-    BOOST_FOREACH( source_iface *dev, _devs ) {
-      for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++) {
-        if ( channel < _iq_opt.size() ) {
-          gr::iqbalance::optimize_c *opt = _iq_opt[channel];
-
-          if ( opt->period() > 0 ) { /* optimize is enabled */
-            opt->set_period( dev->get_sample_rate() / 5 );
-            opt->reset();
-          }
-        }
+  iq_tuning_t &tuning = _iq_tuning[chan];
 
-        channel++;
-      }
-    }
-#endif
+  /* remember the correction for the old setting once it has been estimated */
+  if ( !std::isnan( tuning.freq ) && tap->snapshots() > tuning.snapshots ) {
+    iq_key_t key( chan, std::llround( tuning.freq / IQ_CACHE_FREQ_STEP ),
+                  std::lround( tuning.gain / IQ_CACHE_GAIN_STEP ) );
+    _iq_cache[ key ] = std::make_pair( fix->mag(), fix->phase() );
+  }
+
+  tuning.freq = freq;
+  tuning.gain = gain;
+  tuning.snapshots = tap->snapshots();
 
-    _sample_rate = sample_rate;
+  iq_key_t key( chan, std::llround( freq / IQ_CACHE_FREQ_STEP ),
+                std::lround( gain / IQ_CACHE_GAIN_STEP ) );
+
+  auto cached = _iq_cache.find( key );
+  if ( cached != _iq_cache.end() ) {
+    fix->set_mag( cached->second.first );
+    fix->set_phase( cached->second.second );
+  } else {
+    opt->reset(); /* start over, the old estimate does not apply */
   }
 
-  return _sample_rate;
+  tap->trigger(); /* refine for the new setting right away */
 }
+#endif
 
 double source_impl::get_sample_rate()
 {
+  auto lock = lock_state();
+
   double sample_rate = 0;
 
   if (!_devs.empty())
-    sample_rate = _devs[0]->get_sample_rate(); // assume same devices used in the group
+    sample_rate = _act_sample_rate.get( [this]() { // assume same devices used in the group
+      return _devs[0]->get_sample_rate();
+    } );
 #if 0
   else
     throw std::runtime_error(NO_DEVICES_MSG);
@@ -508,365 +846,658 @@ double source_impl::get_sample_rate()
 
 osmosdr::freq_range_t source_impl::get_freq_range( size_t chan )
 {
-  size_t channel = 0;
-  BOOST_FOREACH( source_iface *dev, _devs )
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ )
-        return dev->get_freq_range( dev_chan );
+  auto lock = lock_state();
+
+  chan = device_channel( chan );
+
+  if ( chan >= _chans.size() )
+    return osmosdr::freq_range_t();
 
-  return osmosdr::freq_range_t();
+  channel_t &ch = _chans[ chan ];
+  return ch.freq_range.get( [&ch]() { return ch.dev->get_freq_range( ch.dev_chan ); } );
 }
 
 double source_impl::set_center_freq( double freq, size_t chan )
 {
-  size_t channel = 0;
-  BOOST_FOREACH( source_iface *dev, _devs )
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ ) {
-        if ( _center_freq[ chan ] != freq ) {
-          _center_freq[ chan ] = freq;
-          return dev->set_center_freq( freq, dev_chan );
-        } else { return _center_freq[ chan ]; }
-      }
+  wait_channel_time( chan, true );
+  auto lock = lock_state();
+
+  if ( virtual_channel_t *virt = virtual_channel( chan ) ) {
+    if ( virt->vfos ) { /* retuned within the band, the device stays */
+      const double center = get_center_freq( virt->parent );
+      return center + virt->vfos->set_offset( virt->index, freq - center );
+    }
+
+    /* moves the whole grid */
+    const double offset = virt->chz->offset( virt->index ) * get_sample_rate();
+    return set_center_freq( freq - offset, virt->parent ) + offset;
+  }
+
+  if ( chan >= _chans.size() )
+    return 0;
 
-  return 0;
+  channel_t &ch = _chans[ chan ];
+  if ( ch.center_freq != freq ) {
+    ch.center_freq = freq;
+    ch.invalidate_band();
+    double actual = ch.act_center_freq.set( ch.dev->set_center_freq( freq + ch.lo_shift, ch.dev_chan ) );
+#ifdef HAVE_IQBALANCE
+    iq_retuned( chan, actual, NAN );
+#endif
+    update_shift( chan );
+    return actual - ch.lo_shift;
+  } else { return ch.center_freq; }
 }
 
 double source_impl::get_center_freq( size_t chan )
 {
-  size_t channel = 0;
-  BOOST_FOREACH( source_iface *dev, _devs )
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ )
-        return dev->get_center_freq( dev_chan );
+  auto lock = lock_state();
+
+  if ( virtual_channel_t *virt = virtual_channel( chan ) ) {
+    if ( virt->vfos )
+      return get_center_freq( virt->parent ) + virt->vfos->offset( virt->index );
+
+    return get_center_freq( virt->parent ) +
+           virt->chz->offset( virt->index ) * get_sample_rate();
+  }
+
+  if ( chan >= _chans.size() )
+    return 0;
 
-  return 0;
+  channel_t &ch = _chans[ chan ];
+  return ch.act_center_freq.get( [&ch]() { return ch.dev->get_center_freq( ch.dev_chan ); } ) -
+         ch.lo_shift;
 }
 
 double source_impl::set_freq_corr( double ppm, size_t chan )
 {
-  size_t channel = 0;
-  BOOST_FOREACH( source_iface *dev, _devs )
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ ) {
-        if ( _freq_corr[ chan ] != ppm ) {
-          _freq_corr[ chan ] = ppm;
-          return dev->set_freq_corr( ppm, dev_chan );
-        } else { return _freq_corr[ chan ]; }
-      }
-
-  return 0;
+  wait_channel_time( chan );
+  auto lock = lock_state();
+
+  chan = device_channel( chan );
+
+  if ( chan >= _chans.size() )
+    return 0;
+
+  channel_t &ch = _chans[ chan ];
+  if ( ch.freq_corr != ppm ) {
+    ch.freq_corr = ppm;
+    ch.act_center_freq.invalidate(); /* may be reported corrected */
+    double actual = ch.dev->set_freq_corr( ppm, ch.dev_chan );
+    if ( ch.soft_tune ) { /* the shift takes what the device can't */
+      ch.freq_residual = ppm - actual;
+      update_shift( chan );
+      actual = ppm;
+    }
+    return ch.act_freq_corr.set( actual );
+  } else { return ch.freq_corr; }
 }
 
 double source_impl::get_freq_corr( size_t chan )
 {
-  size_t channel = 0;
-  BOOST_FOREACH( source_iface *dev, _devs )
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ )
-        return dev->get_freq_corr( dev_chan );
+  auto lock = lock_state();
+
+  chan = device_channel( chan );
 
-  return 0;
+  if ( chan >= _chans.size() )
+    return 0;
+
+  channel_t &ch = _chans[ chan ];
+  return ch.act_freq_corr.get( [&ch]() {
+    return ch.dev->get_freq_corr( ch.dev_chan ) + ch.freq_residual;
+  } );
 }
 
 std::vector<std::string> source_impl::get_gain_names( size_t chan )
 {
-  size_t channel = 0;
-  BOOST_FOREACH( source_iface *dev, _devs )
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ )
-        return dev->get_gain_names( dev_chan );
+  auto lock = lock_state();
+
+  chan = device_channel( chan );
 
-  return std::vector< std::string >();
+  if ( chan >= _chans.size() )
+    return std::vector< std::string >();
+
+  channel_t &ch = _chans[ chan ];
+  return ch.gain_names.get( [&ch]() { return ch.dev->get_gain_names( ch.dev_chan ); } );
 }
 
 osmosdr::gain_range_t source_impl::get_gain_range( size_t chan )
 {
-  size_t channel = 0;
-  BOOST_FOREACH( source_iface *dev, _devs )
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ )
-        return dev->get_gain_range( dev_chan );
+  auto lock = lock_state();
+
+  chan = device_channel( chan );
 
-  return osmosdr::gain_range_t();
+  if ( chan >= _chans.size() )
+    return osmosdr::gain_range_t();
+
+  channel_t &ch = _chans[ chan ];
+  return ch.gain_range.get( [&ch]() { return ch.dev->get_gain_range( ch.dev_chan ); } );
 }
 
 osmosdr::gain_range_t source_impl::get_gain_range( const std::string & name, size_t chan )
 {
-  size_t channel = 0;
-  BOOST_FOREACH( source_iface *dev, _devs )
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ )
-        return dev->get_gain_range( name, dev_chan );
+  auto lock = lock_state();
+
+  chan = device_channel( chan );
 
-  return osmosdr::gain_range_t();
+  if ( chan >= _chans.size() )
+    return osmosdr::gain_range_t();
+
+  channel_t &ch = _chans[ chan ];
+  return ch.named_gain_range.get( name, [&ch, &name]() {
+    return ch.dev->get_gain_range( name, ch.dev_chan );
+  } );
 }
 
 bool source_impl::set_gain_mode( bool automatic, size_t chan )
 {
-  size_t channel = 0;
-  BOOST_FOREACH( source_iface *dev, _devs )
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ ) {
-        if ( _gain_mode[ chan ] != automatic ) {
-          _gain_mode[ chan ] = automatic;
-          bool mode = dev->set_gain_mode( automatic, dev_chan );
-          if (!automatic) // reapply gain value when switched to manual mode
-            dev->set_gain( _gain[ chan ], dev_chan );
-          return mode;
-        } else { return _gain_mode[ chan ]; }
-      }
-
-  return false;
+  wait_channel_time( chan );
+  auto lock = lock_state();
+
+  chan = device_channel( chan );
+
+  if ( chan >= _chans.size() )
+    return false;
+
+  channel_t &ch = _chans[ chan ];
+  if ( ch.gain_mode != automatic ) {
+    ch.gain_mode = automatic;
+    ch.invalidate_gains();
+    bool mode = ch.act_gain_mode.set( ch.dev->set_gain_mode( automatic, ch.dev_chan ) );
+    if (!automatic) // reapply gain value when switched to manual mode
+      ch.act_gain.set( ch.dev->set_gain( ch.gain, ch.dev_chan ) );
+    return mode;
+  } else { return ch.gain_mode; }
 }
 
 bool source_impl::get_gain_mode( size_t chan )
 {
-  size_t channel = 0;
-  BOOST_FOREACH( source_iface *dev, _devs )
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ )
-        return dev->get_gain_mode( dev_chan );
+  auto lock = lock_state();
+
+  chan = device_channel( chan );
 
-  return false;
+  if ( chan >= _chans.size() )
+    return false;
+
+  channel_t &ch = _chans[ chan ];
+  return ch.act_gain_mode.get( [&ch]() { return ch.dev->get_gain_mode( ch.dev_chan ); } );
 }
 
 double source_impl::set_gain( double gain, size_t chan )
 {
-  size_t channel = 0;
-  BOOST_FOREACH( source_iface *dev, _devs )
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ ) {
-        if ( _gain[ chan ] != gain ) {
-          _gain[ chan ] = gain;
-          return dev->set_gain( gain, dev_chan );
-        } else { return _gain[ chan ]; }
-      }
+  wait_channel_time( chan );
+  auto lock = lock_state();
 
-  return 0;
+  chan = device_channel( chan );
+
+  if ( chan >= _chans.size() )
+    return 0;
+
+  channel_t &ch = _chans[ chan ];
+  if ( ch.gain != gain ) {
+    ch.gain = gain;
+    ch.act_named_gain.invalidate(); /* distributed over the stages */
+    double actual = ch.act_gain.set( ch.dev->set_gain( gain, ch.dev_chan ) );
+#ifdef HAVE_IQBALANCE
+    iq_retuned( chan, NAN, actual );
+#endif
+    return actual;
+  } else { return ch.gain; }
 }
 
 double source_impl::set_gain( double gain, const std::string & name, size_t chan)
 {
-  size_t channel = 0;
-  BOOST_FOREACH( source_iface *dev, _devs )
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ )
-        return dev->set_gain( gain, name, dev_chan );
+  wait_channel_time( chan );
+  auto lock = lock_state();
+
+  chan = device_channel( chan );
+
+  if ( chan >= _chans.size() )
+    return 0;
 
-  return 0;
+  channel_t &ch = _chans[ chan ];
+  ch.act_gain.invalidate();
+  return ch.act_named_gain.set( name, ch.dev->set_gain( gain, name, ch.dev_chan ) );
 }
 
 double source_impl::get_gain( size_t chan )
 {
-  size_t channel = 0;
-  BOOST_FOREACH( source_iface *dev, _devs )
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ )
-        return dev->get_gain( dev_chan );
+  auto lock = lock_state();
+
+  chan = device_channel( chan );
+
+  if ( chan >= _chans.size() )
+    return 0;
 
-  return 0;
+  channel_t &ch = _chans[ chan ];
+  if ( ch.automatic_gain() ) /* the device changes it on its own */
+    return ch.dev->get_gain( ch.dev_chan );
+
+  return ch.act_gain.get( [&ch]() { return ch.dev->get_gain( ch.dev_chan ); } );
 }
 
 double source_impl::get_gain( const std::string & name, size_t chan )
 {
-  size_t channel = 0;
-  BOOST_FOREACH( source_iface *dev, _devs )
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ )
-        return dev->get_gain( name, dev_chan );
+  auto lock = lock_state();
+
+  chan = device_channel( chan );
 
-  return 0;
+  if ( chan >= _chans.size() )
+    return 0;
+
+  channel_t &ch = _chans[ chan ];
+  if ( ch.automatic_gain() ) /* the device changes it on its own */
+    return ch.dev->get_gain( name, ch.dev_chan );
+
+  return ch.act_named_gain.get( name, [&ch, &name]() {
+    return ch.dev->get_gain( name, ch.dev_chan );
+  } );
 }
 
 double source_impl::set_if_gain( double gain, size_t chan )
 {
-  size_t channel = 0;
-  BOOST_FOREACH( source_iface *dev, _devs )
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ ) {
-        if ( _if_gain[ chan ] != gain ) {
-          _if_gain[ chan ] = gain;
-          return dev->set_if_gain( gain, dev_chan );
-        } else { return _if_gain[ chan ]; }
-      }
+  wait_channel_time( chan );
+  auto lock = lock_state();
+
+  chan = device_channel( chan );
 
-  return 0;
+  if ( chan >= _chans.size() )
+    return 0;
+
+  channel_t &ch = _chans[ chan ];
+  if ( ch.if_gain != gain ) {
+    ch.if_gain = gain;
+    ch.invalidate_gains();
+    return ch.dev->set_if_gain( gain, ch.dev_chan );
+  } else { return ch.if_gain; }
 }
 
 double source_impl::set_bb_gain( double gain, size_t chan )
 {
-  size_t channel = 0;
-  BOOST_FOREACH( source_iface *dev, _devs )
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ ) {
-        if ( _bb_gain[ chan ] != gain ) {
-          _bb_gain[ chan ] = gain;
-          return dev->set_bb_gain( gain, dev_chan );
-        } else { return _bb_gain[ chan ]; }
-      }
+  wait_channel_time( chan );
+  auto lock = lock_state();
+
+  chan = device_channel( chan );
+
+  if ( chan >= _chans.size() )
+    return 0;
 
-  return 0;
+  channel_t &ch = _chans[ chan ];
+  if ( ch.bb_gain != gain ) {
+    ch.bb_gain = gain;
+    ch.invalidate_gains();
+    return ch.dev->set_bb_gain( gain, ch.dev_chan );
+  } else { return ch.bb_gain; }
 }
 
 std::vector< std::string > source_impl::get_antennas( size_t chan )
 {
-  size_t channel = 0;
-  BOOST_FOREACH( source_iface *dev, _devs )
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ )
-        return dev->get_antennas( dev_chan );
+  auto lock = lock_state();
+
+  chan = device_channel( chan );
+
+  if ( chan >= _chans.size() )
+    return std::vector< std::string >();
 
-  return std::vector< std::string >();
+  channel_t &ch = _chans[ chan ];
+  return ch.antennas.get( [&ch]() { return ch.dev->get_antennas( ch.dev_chan ); } );
 }
 
 std::string source_impl::set_antenna( const std::string & antenna, size_t chan )
 {
-  size_t channel = 0;
-  BOOST_FOREACH( source_iface *dev, _devs )
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ ) {
-        if ( _antenna[ chan ] != antenna ) {
-          _antenna[ chan ] = antenna;
-          return dev->set_antenna( antenna, dev_chan );
-        } else { return _antenna[ chan ]; }
-      }
+  wait_channel_time( chan );
+  auto lock = lock_state();
+
+  chan = device_channel( chan );
 
-  return "";
+  if ( chan >= _chans.size() )
+    return "";
+
+  channel_t &ch = _chans[ chan ];
+  if ( ch.antenna != antenna ) {
+    ch.antenna = antenna;
+    ch.invalidate_band();
+    ch.invalidate_gains();
+    return ch.act_antenna.set( ch.dev->set_antenna( antenna, ch.dev_chan ) );
+  } else { return ch.antenna; }
 }
 
 std::string source_impl::get_antenna( size_t chan )
 {
-  size_t channel = 0;
-  BOOST_FOREACH( source_iface *dev, _devs )
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ )
-        return dev->get_antenna( dev_chan );
+  auto lock = lock_state();
+
+  chan = device_channel( chan );
 
-  return "";
+  if ( chan >= _chans.size() )
+    return "";
+
+  channel_t &ch = _chans[ chan ];
+  return ch.act_antenna.get( [&ch]() { return ch.dev->get_antenna( ch.dev_chan ); } );
 }
 
 void source_impl::set_dc_offset_mode( int mode, size_t chan )
 {
-  size_t channel = 0;
-  BOOST_FOREACH( source_iface *dev, _devs )
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ )
-        dev->set_dc_offset_mode( mode, dev_chan );
+  auto lock = lock_state();
+
+  chan = device_channel( chan );
+
+  if ( chan < _chans.size() )
+    _chans[ chan ].dev->set_dc_offset_mode( mode, _chans[ chan ].dev_chan );
 }
 
 void source_impl::set_dc_offset( const std::complex<double> &offset, size_t chan )
 {
-  size_t channel = 0;
-  BOOST_FOREACH( source_iface *dev, _devs )
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ )
-        dev->set_dc_offset( offset, dev_chan );
+  auto lock = lock_state();
+
+  chan = device_channel( chan );
+
+  if ( chan < _chans.size() )
+    _chans[ chan ].dev->set_dc_offset( offset, _chans[ chan ].dev_chan );
 }
 
 void source_impl::set_iq_balance_mode( int mode, size_t chan )
 {
-  size_t channel = 0;
+  auto lock = lock_state();
+
+  chan = device_channel( chan );
+
+  if ( chan >= _chans.size() )
+    return;
+
 #ifdef HAVE_IQBALANCE
-  BOOST_FOREACH( source_iface *dev, _devs ) {
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++) {
-      if ( chan == channel++ ) {
-        if ( chan < _iq_opt.size() && chan < _iq_fix.size() ) {
-          gr::iqbalance::optimize_c *opt = _iq_opt[chan];
-          gr::iqbalance::fix_cc *fix = _iq_fix[chan];
-
-          if ( IQBalanceOff == mode  ) {
-            opt->set_period( 0 );
-            /* store current values in order to be able to restore them later */
-            _vals[ chan ] = std::pair< float, float >( fix->mag(), fix->phase() );
-            fix->set_mag( 0.0f );
-            fix->set_phase( 0.0f );
-          } else if ( IQBalanceManual == mode ) {
-            if ( opt->period() == 0 ) { /* transition from Off to Manual */
-              /* restore previous values */
-              std::pair< float, float > val = _vals[ chan ];
-              fix->set_mag( val.first );
-              fix->set_phase( val.second );
-            }
-            opt->set_period( 0 );
-          } else if ( IQBalanceAutomatic == mode ) {
-            opt->set_period( dev->get_sample_rate() / 5 );
-            opt->reset();
-          }
-        }
+  if ( chan < _iq_opt.size() && _iq_opt[chan] == NULL ) {
+    _chans[ chan ].dev->set_iq_balance_mode( mode, _chans[ chan ].dev_chan );
+  } else if ( chan < _iq_opt.size() && chan < _iq_fix.size() ) {
+    gr::iqbalance::optimize_c *opt = _iq_opt[chan];
+    gr::iqbalance::fix_cc *fix = _iq_fix[chan];
+
+    if ( IQBalanceOff == mode  ) {
+      opt->set_period( 0 );
+      /* store current values in order to be able to restore them later */
+      _vals[ chan ] = std::pair< float, float >( fix->mag(), fix->phase() );
+      fix->set_mag( 0.0f );
+      fix->set_phase( 0.0f );
+    } else if ( IQBalanceManual == mode ) {
+      if ( opt->period() == 0 ) { /* transition from Off to Manual */
+        /* restore previous values */
+        std::pair< float, float > val = _vals[ chan ];
+        fix->set_mag( val.first );
+        fix->set_phase( val.second );
       }
+      opt->set_period( 0 );
+    } else if ( IQBalanceAutomatic == mode ) {
+      opt->set_period( IQ_SNAPSHOT_LEN );
+      opt->reset();
+      _iq_tap[chan]->trigger();
     }
   }
 #else
-  BOOST_FOREACH( source_iface *dev, _devs )
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ )
-        return dev->set_iq_balance_mode( mode, dev_chan );
+  _chans[ chan ].dev->set_iq_balance_mode( mode, _chans[ chan ].dev_chan );
 #endif
 }
 
 void source_impl::set_iq_balance( const std::complex<double> &balance, size_t chan )
 {
-  size_t channel = 0;
+  auto lock = lock_state();
+
+  chan = device_channel( chan );
+
+  if ( chan >= _chans.size() )
+    return;
+
 #ifdef HAVE_IQBALANCE
-  BOOST_FOREACH( source_iface *dev, _devs ) {
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++) {
-      if ( chan == channel++ ) {
-        if ( chan < _iq_opt.size() && chan < _iq_fix.size() ) {
-          gr::iqbalance::optimize_c *opt = _iq_opt[chan];
-          gr::iqbalance::fix_cc *fix = _iq_fix[chan];
-
-          if ( opt->period() == 0 ) { /* automatic optimization desabled */
-            fix->set_mag( balance.real() );
-            fix->set_phase( balance.imag() );
-          }
-        }
-      }
+  if ( chan < _iq_opt.size() && _iq_opt[chan] == NULL ) {
+    _chans[ chan ].dev->set_iq_balance( balance, _chans[ chan ].dev_chan );
+  } else if ( chan < _iq_opt.size() && chan < _iq_fix.size() ) {
+    gr::iqbalance::optimize_c *opt = _iq_opt[chan];
+    gr::iqbalance::fix_cc *fix = _iq_fix[chan];
+
+    if ( opt->period() == 0 ) { /* automatic optimization desabled */
+      fix->set_mag( balance.real() );
+      fix->set_phase( balance.imag() );
     }
   }
 #else
-  BOOST_FOREACH( source_iface *dev, _devs )
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ )
-        return dev->set_iq_balance( balance, dev_chan );
+  _chans[ chan ].dev->set_iq_balance( balance, _chans[ chan ].dev_chan );
 #endif
 }
 
 double source_impl::set_bandwidth( double bandwidth, size_t chan )
 {
-  size_t channel = 0;
-  BOOST_FOREACH( source_iface *dev, _devs )
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ ) {
-        if ( _bandwidth[ chan ] != bandwidth || 0.0f == bandwidth ) {
-          _bandwidth[ chan ] = bandwidth;
-          return dev->set_bandwidth( bandwidth, dev_chan );
-        } else { return _bandwidth[ chan ]; }
-      }
+  wait_channel_time( chan );
+  auto lock = lock_state();
+
+  if ( virtual_channel_t *virt = virtual_channel( chan ) ) {
+    if ( virt->vfos )
+      return virt->vfos->set_bandwidth( virt->index, bandwidth );
 
-  return 0;
+    virt->chz->set_bandwidth( bandwidth ); /* of all its channels */
+    return virt->chz->bandwidth();
+  }
+
+  if ( chan >= _chans.size() )
+    return 0;
+
+  channel_t &ch = _chans[ chan ];
+  if ( ch.bandwidth != bandwidth || 0.0f == bandwidth ) {
+    ch.bandwidth = bandwidth;
+    return ch.act_bandwidth.set( ch.dev->set_bandwidth( bandwidth, ch.dev_chan ) );
+  } else { return ch.bandwidth; }
 }
 
 double source_impl::get_bandwidth( size_t chan )
 {
-  size_t channel = 0;
-  BOOST_FOREACH( source_iface *dev, _devs )
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ )
-        return dev->get_bandwidth( dev_chan );
+  auto lock = lock_state();
+
+  if ( virtual_channel_t *virt = virtual_channel( chan ) )
+    return virt->vfos ? virt->vfos->bandwidth( virt->index ) : virt->chz->bandwidth();
 
-  return 0;
+  if ( chan >= _chans.size() )
+    return 0;
+
+  channel_t &ch = _chans[ chan ];
+  return ch.act_bandwidth.get( [&ch]() { return ch.dev->get_bandwidth( ch.dev_chan ); } );
 }
 
 osmosdr::freq_range_t source_impl::get_bandwidth_range( size_t chan )
 {
-  size_t channel = 0;
-  BOOST_FOREACH( source_iface *dev, _devs )
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ )
-        return dev->get_bandwidth_range( dev_chan );
+  auto lock = lock_state();
+
+  chan = device_channel( chan );
+
+  if ( chan >= _chans.size() )
+    return osmosdr::freq_range_t();
+
+  channel_t &ch = _chans[ chan ];
+  return ch.bandwidth_range.get( [&ch]() { return ch.dev->get_bandwidth_range( ch.dev_chan ); } );
+}
+
+osmosdr::settings_t source_impl::apply_settings( const osmosdr::settings_t &settings )
+{
+  /* the devices reach their command times before the lock is taken, the
+   * setters find them passed then */
+  for (size_t i = 0; i < _devs.size(); i++) {
+    bool touched = !std::isnan( settings.sample_rate );
+    bool retune = !touched;
+
+    for (size_t chan = 0; chan < settings.channels.size(); chan++) {
+      const size_t dev_chan = device_channel( chan );
+      if ( dev_chan >= _chans.size() || _chans[ dev_chan ].dev_index != i )
+        continue;
+
+      const osmosdr::channel_settings_t &req = settings.channels[ chan ];
+      if ( !std::isnan( req.bandwidth ) || !std::isnan( req.gain ) ) {
+        touched = true;
+        retune = false;
+      } else if ( !std::isnan( req.center_freq ) ) {
+        touched = true;
+      }
+    }
+
+    if ( touched )
+      wait_command_time( i, retune );
+  }
+
+  auto lock = lock_state();
+
+  osmosdr::settings_t actual;
+  actual.channels.resize( std::min( settings.channels.size(), get_num_channels() ) );
+
+  /* the rate first, bandwidths and the rotators follow it */
+  if ( !std::isnan( settings.sample_rate ) )
+    set_sample_rate( settings.sample_rate );
+
+  std::vector< task_t > tasks;
+
+  /* one task per device, each one touches only the channels of its device */
+  for (size_t i = 0; i < _devs.size(); i++) {
+    tasks.push_back( [this, i, &settings, &actual]() {
+      caller_holds_lock_t inherited;
+
+      for (size_t chan = 0; chan < actual.channels.size(); chan++) {
+        if ( _chans[ device_channel( chan ) ].dev_index != i )
+          continue;
+
+        const osmosdr::channel_settings_t &req = settings.channels[ chan ];
+        osmosdr::channel_settings_t &res = actual.channels[ chan ];
+
+        if ( !std::isnan( req.bandwidth ) )
+          res.bandwidth = set_bandwidth( req.bandwidth, chan );
+        if ( !std::isnan( req.center_freq ) )
+          res.center_freq = set_center_freq( req.center_freq, chan );
+        if ( !std::isnan( req.gain ) )
+          res.gain = set_gain( req.gain, chan );
+      }
+    } );
+  }
+
+  run_in_parallel( tasks );
+
+  if ( !std::isnan( settings.sample_rate ) )
+    actual.sample_rate = _sample_rate;
+
+  return actual;
+}
+
+void source_impl::handle_command( pmt::pmt_t msg )
+{
+  command_t cmd;
+
+  try {
+    cmd = parse_command( msg );
+  } catch ( std::exception &ex ) {
+    std::cerr << "Dropping command: " << ex.what() << std::endl;
+    return;
+  }
+
+  _control.post( [this, cmd]() {
+    try {
+      apply_command( cmd );
+    } catch ( std::exception &ex ) {
+      std::cerr << "Command failed: " << ex.what() << std::endl;
+    }
+  } );
+}
+
+void source_impl::apply_command( const command_t &cmd )
+{
+  if ( cmd.chan >= long(get_num_channels()) )
+    throw std::runtime_error( "no channel " + std::to_string( cmd.chan ) );
+
+  size_t first = cmd.chan < 0 ? 0 : cmd.chan;
+  size_t last = cmd.chan < 0 ? _chans.size() : cmd.chan + 1;
+
+  /* the antenna first, gains and filters may depend on it */
+  if ( cmd.antenna.length() )
+    for (size_t chan = first; chan < last; chan++)
+      set_antenna( cmd.antenna, chan );
+
+  osmosdr::settings_t settings;
+  settings.sample_rate = cmd.rate;
+  settings.channels.resize( last );
+
+  for (size_t chan = first; chan < last; chan++) {
+    settings.channels[ chan ].center_freq = cmd.freq;
+    settings.channels[ chan ].gain = cmd.gain;
+    settings.channels[ chan ].bandwidth = cmd.bandwidth;
+  }
+
+  apply_settings( settings );
+}
+
+std::future<double> source_impl::set_sample_rate_async( double rate )
+{
+  return _control.submit( [=]() { return set_sample_rate( rate ); } );
+}
 
-  return osmosdr::freq_range_t();
+std::future<double> source_impl::set_center_freq_async( double freq, size_t chan )
+{
+  return _control.submit( [=]() { return set_center_freq( freq, chan ); } );
+}
+
+std::future<double> source_impl::set_freq_corr_async( double ppm, size_t chan )
+{
+  return _control.submit( [=]() { return set_freq_corr( ppm, chan ); } );
+}
+
+std::future<bool> source_impl::set_gain_mode_async( bool automatic, size_t chan )
+{
+  return _control.submit( [=]() { return set_gain_mode( automatic, chan ); } );
+}
+
+std::future<double> source_impl::set_gain_async( double gain, size_t chan )
+{
+  return _control.submit( [=]() { return set_gain( gain, chan ); } );
+}
+
+std::future<double> source_impl::set_gain_async( double gain, const std::string & name, size_t chan )
+{
+  return _control.submit( [=]() { return set_gain( gain, name, chan ); } );
+}
+
+std::future<double> source_impl::set_if_gain_async( double gain, size_t chan )
+{
+  return _control.submit( [=]() { return set_if_gain( gain, chan ); } );
+}
+
+std::future<double> source_impl::set_bb_gain_async( double gain, size_t chan )
+{
+  return _control.submit( [=]() { return set_bb_gain( gain, chan ); } );
+}
+
+std::future<std::string> source_impl::set_antenna_async( const std::string & antenna, size_t chan )
+{
+  return _control.submit( [=]() { return set_antenna( antenna, chan ); } );
+}
+
+std::future<void> source_impl::set_dc_offset_mode_async( int mode, size_t chan )
+{
+  return _control.submit( [=]() { set_dc_offset_mode( mode, chan ); } );
+}
+
+std::future<void> source_impl::set_dc_offset_async( const std::complex<double> &offset, size_t chan )
+{
+  return _control.submit( [=]() { set_dc_offset( offset, chan ); } );
+}
+
+std::future<void> source_impl::set_iq_balance_mode_async( int mode, size_t chan )
+{
+  return _control.submit( [=]() { set_iq_balance_mode( mode, chan ); } );
+}
+
+std::future<void> source_impl::set_iq_balance_async( const std::complex<double> &balance, size_t chan )
+{
+  return _control.submit( [=]() { set_iq_balance( balance, chan ); } );
+}
+
+std::future<double> source_impl::set_bandwidth_async( double bandwidth, size_t chan )
+{
+  return _control.submit( [=]() { return set_bandwidth( bandwidth, chan ); } );
+}
+
+std::future<osmosdr::settings_t> source_impl::apply_settings_async( const osmosdr::settings_t &settings )
+{
+  return _control.submit( [=]() { return apply_settings( settings ); } );
 }
 
 void source_impl::set_time_source(const std::string &source, const size_t mboard)
@@ -967,3 +1598,61 @@ void source_impl::set_time_unknown_pps(const osmosdr::time_spec_t &time_spec)
     dev->set_time_unknown_pps( time_spec );
   }
 }
+
+void source_impl::set_command_time(const osmosdr::time_spec_t &time_spec, size_t mboard)
+{
+  for (size_t m = 0; m < _devs.size(); m++) {
+    if (mboard != osmosdr::ALL_MBOARDS && m != mboard)
+      continue;
+
+    /* emulated for the devices not timing the commands themselves */
+    const bool timed = _devs[m]->set_command_time( time_spec, mboard == osmosdr::ALL_MBOARDS ?
+                                                              osmosdr::ALL_MBOARDS : 0 );
+    if ( timed && ! _devs[m]->command_time_retunes_only() )
+      _command_timer.clear( m );
+    else
+      _command_timer.set( m, time_spec, timed );
+  }
+}
+
+void source_impl::clear_command_time(size_t mboard)
+{
+  for (size_t m = 0; m < _devs.size(); m++) {
+    if (mboard != osmosdr::ALL_MBOARDS && m != mboard)
+      continue;
+
+    _devs[m]->clear_command_time( mboard == osmosdr::ALL_MBOARDS ?
+                                  osmosdr::ALL_MBOARDS : 0 );
+    _command_timer.clear( m );
+  }
+}
+
+osmosdr::signal_stats_t source_impl::get_signal_stats(size_t chan)
+{
+  auto lock = lock_state();
+
+  chan = device_channel( chan );
+
+  if ( chan >= _chans.size() )
+    return osmosdr::signal_stats_t();
+
+  if ( signal_monitor *monitor = _chans[chan].dev->get_signal_monitor() )
+    return monitor->stats( _chans[chan].dev_chan );
+
+  return osmosdr::signal_stats_t();
+}
+
+void source_impl::wait_command_time( size_t dev_index, bool retune )
+{
+  source_iface *dev = _devs[ dev_index ];
+  _command_timer.wait( dev_index, [dev]() { return dev->get_time_now(); }, retune );
+}
+
+/* called ahead of the lock, the other callers must not wait along */
+void source_impl::wait_channel_time( size_t chan, bool retune )
+{
+  chan = device_channel( chan );
+
+  if ( chan < _chans.size() )
+    wait_command_time( _chans[ chan ].dev_index, retune );
+}
@@ -27,9 +27,24 @@
 #include <gnuradio/iqbalance/fix_cc.h>
 #endif
 
+#include <gnuradio/blocks/rotator_cc.h>
+
 #include <source_iface.h>
+#include "command_port.h"
+#include "command_timer.h"
+#include "channelizer.h"
+#include "energy_gate.h"
+#include "vfo_bank.h"
+#include "control_thread.h"
+#include "hop_scheduler.h"
+#include "psd_estimator.h"
+#include "shadow_state.h"
+#include "snapshot_tap.h"
 
 #include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
 
 class source_impl : public osmosdr::source
 {
@@ -37,6 +52,7 @@ public:
   source_impl( const std::string & args );
 
   size_t get_num_channels( void );
+  size_t get_mboard( size_t chan = 0 );
 
   bool seek( long seek_point, int whence, size_t chan );
 
@@ -77,6 +93,31 @@ public:
   double get_bandwidth( size_t chan = 0 );
   osmosdr::freq_range_t get_bandwidth_range( size_t chan = 0 );
 
+  osmosdr::settings_t apply_settings( const osmosdr::settings_t &settings );
+
+  void refresh_state( void );
+
+  void begin_config( void );
+  void commit_config( void );
+
+  void set_hop_schedule( const osmosdr::hop_schedule_t &hops, size_t chan = 0 );
+
+  std::future<double> set_sample_rate_async( double rate );
+  std::future<double> set_center_freq_async( double freq, size_t chan = 0 );
+  std::future<double> set_freq_corr_async( double ppm, size_t chan = 0 );
+  std::future<bool> set_gain_mode_async( bool automatic, size_t chan = 0 );
+  std::future<double> set_gain_async( double gain, size_t chan = 0 );
+  std::future<double> set_gain_async( double gain, const std::string & name, size_t chan = 0 );
+  std::future<double> set_if_gain_async( double gain, size_t chan = 0 );
+  std::future<double> set_bb_gain_async( double gain, size_t chan = 0 );
+  std::future<std::string> set_antenna_async( const std::string & antenna, size_t chan = 0 );
+  std::future<void> set_dc_offset_mode_async( int mode, size_t chan = 0 );
+  std::future<void> set_dc_offset_async( const std::complex<double> &offset, size_t chan = 0 );
+  std::future<void> set_iq_balance_mode_async( int mode, size_t chan = 0 );
+  std::future<void> set_iq_balance_async( const std::complex<double> &balance, size_t chan = 0 );
+  std::future<double> set_bandwidth_async( double bandwidth, size_t chan = 0 );
+  std::future<osmosdr::settings_t> apply_settings_async( const osmosdr::settings_t &settings );
+
   void set_time_source(const std::string &source, const size_t mboard = 0);
   std::string get_time_source(const size_t mboard);
   std::vector<std::string> get_time_sources(const size_t mboard);
@@ -91,24 +132,141 @@ public:
   void set_time_next_pps(const ::osmosdr::time_spec_t &time_spec);
   void set_time_unknown_pps(const ::osmosdr::time_spec_t &time_spec);
 
+  void set_command_time(const ::osmosdr::time_spec_t &time_spec,
+                        size_t mboard = osmosdr::ALL_MBOARDS);
+  void clear_command_time(size_t mboard = osmosdr::ALL_MBOARDS);
+
+  osmosdr::signal_stats_t get_signal_stats(size_t chan = 0);
+
 private:
+  struct virtual_channel_t;
+
+  std::unique_lock< std::recursive_mutex > lock_state( void );
+  void check_config_generations( void );
+  void rate_changed( void );
+  void update_shift( size_t chan );
+  virtual_channel_t *virtual_channel( size_t chan );
+  size_t device_channel( size_t chan );
+  void handle_command( pmt::pmt_t msg );
+  void apply_command( const command_t &cmd );
+  void wait_command_time( size_t dev_index, bool retune = false );
+  void wait_channel_time( size_t chan, bool retune = false );
+#ifdef HAVE_IQBALANCE
+  void reset_iq_optimizers( void );
+  void iq_retuned( size_t chan, double freq, double gain );
+#endif
+
+  /* serializes the setters and getters, they are called from the flow
+   * graph, the control thread and the hopping threads alike */
+  std::recursive_mutex _mutex;
+
+  /* of each device, as last seen by check_config_generations() */
+  std::vector< unsigned int > _config_generations;
+
   std::vector< source_iface * > _devs;
 
-  /* cache to prevent multiple device calls with the same value coming from grc */
+  /* flat mapping of a channel index to its device and the device local index */
+  struct channel_t
+  {
+    channel_t( source_iface *dev, size_t dev_index, size_t dev_chan );
+
+    source_iface *dev;
+    size_t dev_index;
+    size_t dev_chan;
+
+    /* cache to prevent multiple device calls with the same value coming from grc */
+    double center_freq;
+    double freq_corr;
+    bool gain_mode;
+    double gain;
+    double if_gain;
+    double bb_gain;
+    std::string antenna;
+    double bandwidth;
+
+    /* tuning off the center, given by lo_shift= */
+    bool soft_tune;
+    double lo_shift; /* of the device above the channel */
+    double freq_residual; /* ppm of the correction the device did not apply */
+    gr::blocks::rotator_cc *rotator; /* if the backend does not shift itself */
+
+    /* values last reported by the device, served to the getters */
+    shadow_value< double > act_center_freq;
+    shadow_value< double > act_freq_corr;
+    shadow_value< bool > act_gain_mode;
+    shadow_value< double > act_gain;
+    shadow_map< std::string, double > act_named_gain;
+    shadow_value< std::string > act_antenna;
+    shadow_value< double > act_bandwidth;
+    shadow_value< osmosdr::freq_range_t > freq_range;
+    shadow_value< osmosdr::freq_range_t > bandwidth_range;
+    shadow_value< osmosdr::gain_range_t > gain_range;
+    shadow_map< std::string, osmosdr::gain_range_t > named_gain_range;
+    shadow_value< std::vector< std::string > > gain_names;
+    shadow_value< std::vector< std::string > > antennas;
+
+    /* gain readings are not cached while the device controls the gain */
+    bool automatic_gain( void );
+    void invalidate_gains( void );
+    void invalidate_band( void );
+    void invalidate( void );
+  };
+
+  std::vector< channel_t > _chans;
+
+  /* a narrow channel cut out of a device channel, numbered after _chans */
+  struct virtual_channel_t
+  {
+    size_t parent; /* index in _chans */
+    channelizer *chz; /* either a channelizer output */
+    vfo_bank *vfos; /* or a tunable receiver */
+    size_t index; /* of the output */
+  };
+
+  std::vector< virtual_channel_t > _virt;
+  std::vector< channelizer * > _channelizers;
+  std::vector< vfo_bank * > _vfo_banks;
+
+  /* passing on the bursts of each device channel if gated */
+  std::vector< energy_gate * > _gates;
+
+  /* the averaged spectrum of each device channel, fed through its tap */
+  std::vector< std::pair< snapshot_tap *, psd_estimator * > > _psd;
+
   double _sample_rate;
-  std::map< size_t, double > _center_freq;
-  std::map< size_t, double > _freq_corr;
-  std::map< size_t, bool > _gain_mode;
-  std::map< size_t, double > _gain;
-  std::map< size_t, double > _if_gain;
-  std::map< size_t, double > _bb_gain;
-  std::map< size_t, std::string > _antenna;
+  shadow_value< double > _act_sample_rate;
+  shadow_value< osmosdr::meta_range_t > _sample_rates;
 #ifdef HAVE_IQBALANCE
   std::vector< gr::iqbalance::fix_cc * > _iq_fix;
   std::vector< gr::iqbalance::optimize_c * > _iq_opt;
+  std::vector< snapshot_tap * > _iq_tap;
   std::map< size_t, std::pair<float, float> > _vals;
+
+  /* the setting each channel is tuned to, NAN before the first retune */
+  struct iq_tuning_t
+  {
+    double freq;
+    double gain;
+    uint64_t snapshots; /* taken before arriving at it */
+  };
+
+  /* converged corrections by channel, frequency bin and gain bin */
+  typedef std::tuple< size_t, long long, long > iq_key_t;
+
+  std::mutex _iq_mutex;
+  std::vector< iq_tuning_t > _iq_tuning;
+  std::map< iq_key_t, std::pair<float, float> > _iq_cache;
 #endif
-  std::map< size_t, double > _bandwidth;
+
+  /* the running hopping schedule of each device, replaced one at a time */
+  std::vector< std::unique_ptr< hop_scheduler > > _hoppers;
+  std::mutex _hop_mutex;
+
+  /* command times of the devices without timed commands */
+  command_timer _command_timer;
+
+  /* applies queued requests, declared last to be stopped first */
+  control_thread _control;
 };
 
 #endif /* INCLUDED_OSMOSDR_SOURCE_IMPL_H */
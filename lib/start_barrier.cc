@@ -0,0 +1,58 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <iostream>
+
+#include "start_barrier.h"
+
+start_barrier::start_barrier( size_t count, double guard, double timeout )
+  : _count(count),
+    _waiting(0),
+    _generation(0),
+    _guard( std::chrono::duration_cast< clock::duration >(
+              std::chrono::duration< double >( guard ) ) ),
+    _timeout( std::chrono::duration_cast< clock::duration >(
+                std::chrono::duration< double >( timeout ) ) )
+{
+}
+
+start_barrier::clock::time_point start_barrier::arrive()
+{
+  std::unique_lock< std::mutex > lock( _mutex );
+
+  const uint64_t generation = _generation;
+
+  if ( ++_waiting < _count ) {
+    if ( _cond.wait_for( lock, _timeout,
+                         [&]{ return _generation != generation; } ) )
+      return _epoch;
+
+    std::cerr << "Not all devices are ready to stream, "
+              << "starting without them." << std::endl;
+  }
+
+  /* last one in (or timed out), release everybody of this round */
+  _epoch = clock::now() + _guard;
+  _waiting = 0;
+  _generation++;
+  _cond.notify_all();
+
+  return _epoch;
+}
@@ -0,0 +1,61 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef OSMOSDR_START_BARRIER_H
+#define OSMOSDR_START_BARRIER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+#include <stdint.h>
+
+/*
+ * Lines up the stream start of several devices. Each device prepares for
+ * streaming, then waits in arrive() until the others are ready as well and
+ * starts right after. The returned epoch lies far enough ahead for every
+ * device to be streaming by then, samples before it are to be discarded so
+ * all streams begin at the same host time.
+ *
+ * A device which never arrives (e.g. failed to start) does not block the
+ * others forever, they are released after a timeout.
+ */
+class start_barrier
+{
+public:
+  typedef std::chrono::system_clock clock;
+
+  start_barrier( size_t count, double guard = 0.05, double timeout = 2.0 );
+
+  clock::time_point arrive( void );
+
+private:
+  std::mutex _mutex;
+  std::condition_variable _cond;
+
+  size_t _count;
+  size_t _waiting;
+  uint64_t _generation;
+  clock::time_point _epoch;
+  clock::duration _guard;
+  clock::duration _timeout;
+};
+
+#endif // OSMOSDR_START_BARRIER_H
@@ -0,0 +1,69 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <gnuradio/io_signature.h>
+
+#include <volk/volk.h>
+
+#include "stream_converter.h"
+
+#define SC16_SCALE 32768.0f
+#define SC8_SCALE 128.0f
+
+stream_converter_sptr make_stream_converter( stream_type_t from, stream_type_t to )
+{
+  return gnuradio::get_initial_sptr( new stream_converter( from, to ) );
+}
+
+stream_converter::stream_converter( stream_type_t from, stream_type_t to )
+  : gr::sync_block( "stream_converter",
+                    gr::io_signature::make(1, 1, stream_item_size( from )),
+                    gr::io_signature::make(1, 1, stream_item_size( to )) ),
+    _from( from ),
+    _to( to )
+{
+  if ( (from == STREAM_FC32) == (to == STREAM_FC32) )
+    throw std::runtime_error( "stream_converter: one side has to be fc32." );
+}
+
+int stream_converter::work( int noutput_items,
+                            gr_vector_const_void_star &input_items,
+                            gr_vector_void_star &output_items )
+{
+  const unsigned int npoints = 2 * noutput_items; /* I and Q */
+
+  const float *fin = static_cast< const float * >( input_items[0] );
+  float *fout = static_cast< float * >( output_items[0] );
+
+  if ( _to == STREAM_SC16 )
+    volk_32f_s32f_convert_16i( static_cast< int16_t * >( output_items[0] ),
+                               fin, SC16_SCALE, npoints );
+  else if ( _to == STREAM_SC8 )
+    volk_32f_s32f_convert_8i( static_cast< int8_t * >( output_items[0] ),
+                              fin, SC8_SCALE, npoints );
+  else if ( _from == STREAM_SC16 )
+    volk_16i_s32f_convert_32f( fout, static_cast< const int16_t * >( input_items[0] ),
+                               SC16_SCALE, npoints );
+  else
+    volk_8i_s32f_convert_32f( fout, static_cast< const int8_t * >( input_items[0] ),
+                              SC8_SCALE, npoints );
+
+  return noutput_items;
+}
@@ -0,0 +1,56 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef INCLUDED_OSMOSDR_STREAM_CONVERTER_H
+#define INCLUDED_OSMOSDR_STREAM_CONVERTER_H
+
+#include <gnuradio/sync_block.h>
+
+#include "stream_type.h"
+
+class stream_converter;
+
+typedef boost::shared_ptr<stream_converter> stream_converter_sptr;
+
+stream_converter_sptr make_stream_converter( stream_type_t from, stream_type_t to );
+
+/*!
+ * \brief Converts the samples of a single stream between fc32 and one of
+ * the integer types, for the devices not delivering or taking the stream
+ * type the user asked for natively.
+ */
+class stream_converter : public gr::sync_block
+{
+private:
+  friend stream_converter_sptr make_stream_converter( stream_type_t from,
+                                                      stream_type_t to );
+
+  stream_converter( stream_type_t from, stream_type_t to );
+
+public:
+  int work( int noutput_items,
+            gr_vector_const_void_star &input_items,
+            gr_vector_void_star &output_items );
+
+private:
+  stream_type_t _from;
+  stream_type_t _to;
+};
+
+#endif /* INCLUDED_OSMOSDR_STREAM_CONVERTER_H */
@@ -0,0 +1,411 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+#include "stream_tagger.h"
+
+#define RETAG_INTERVAL 1.0 /* seconds between rx_time tags */
+
+static pmt::pmt_t time_value( double secs )
+{
+  const double full = std::floor( secs );
+  return pmt::make_tuple( pmt::from_uint64( uint64_t( full ) ),
+                          pmt::from_double( secs - full ) );
+}
+
+stream_tagger::stream_tagger()
+  : _received(0),
+    _consumed(0),
+    _latency(0),
+    _settle_time(0),
+    _rate(0),
+    _changing(false),
+    _change_start(0),
+    _drop_until(0),
+    _lost(0),
+    _dwelling(false),
+    _next_dwell(0),
+    _dwell_left(0),
+    _dwells_done(0),
+    _freq_offset(0),
+    _timed(false),
+    _next_index(0),
+    _retag_at(0),
+    _stream_rate(pmt::PMT_NIL),
+    _stream_freq(pmt::PMT_NIL)
+{
+}
+
+stream_tagger::overflow_policy
+stream_tagger::parse_overflow_policy( const std::string &value )
+{
+  if ( value == "drop_oldest" )
+    return DROP_OLDEST;
+  if ( value == "drop_newest" )
+    return DROP_NEWEST;
+  if ( value == "zero_fill" )
+    return ZERO_FILL;
+
+  throw std::runtime_error( "Unknown overflow policy '" + value + "', "
+                            "use drop_oldest, drop_newest or zero_fill." );
+}
+
+void stream_tagger::set_latency( uint64_t samples )
+{
+  std::lock_guard< std::mutex > lock( _mutex );
+  _latency = samples;
+}
+
+void stream_tagger::set_settle_time( double seconds )
+{
+  std::lock_guard< std::mutex > lock( _mutex );
+  _settle_time = seconds;
+}
+
+void stream_tagger::set_sample_rate( double rate )
+{
+  std::lock_guard< std::mutex > lock( _mutex );
+  _rate = rate;
+  _clock.reset( rate );
+  _retag_at = 0; /* time the first sample at the new rate */
+}
+
+void stream_tagger::set_start_barrier( const std::shared_ptr< start_barrier > &barrier )
+{
+  std::lock_guard< std::mutex > lock( _mutex );
+  _barrier = barrier;
+}
+
+void stream_tagger::sync_start()
+{
+  std::shared_ptr< start_barrier > barrier;
+  {
+    std::lock_guard< std::mutex > lock( _mutex );
+    barrier = _barrier;
+  }
+
+  if ( ! barrier )
+    return;
+
+  const start_barrier::clock::time_point epoch = barrier->arrive();
+  const double ahead = std::chrono::duration< double >(
+                         epoch - start_barrier::clock::now() ).count();
+  /* in the time base of the rx_time tags derived from arrival times */
+  const double secs = osmosdr::time_spec_t::get_system_time().get_real_secs() + ahead;
+
+  std::lock_guard< std::mutex > lock( _mutex );
+
+  mark_t mark;
+  mark.stale_from = _received;
+  mark.valid_from = _received + uint64_t( std::ceil( std::max( ahead, 0.0 ) * _rate ) );
+  mark.key = pmt::mp("rx_time");
+  mark.value = time_value( secs );
+  mark.dwell = 0;
+
+  _marks.push_back( mark );
+}
+
+void stream_tagger::add_pending( const pmt::pmt_t &key, const pmt::pmt_t &value,
+                                 bool replace )
+{
+  for (size_t p = 0; p < _pending.size(); p++) {
+    if ( pmt::eq( _pending[p].first, key ) ) {
+      if ( replace )
+        _pending[p].second = value;
+      return;
+    }
+  }
+
+  _pending.push_back( std::make_pair( key, value ) );
+}
+
+uint64_t stream_tagger::settle_samples() const
+{
+  return uint64_t( std::ceil( _settle_time * _rate ) );
+}
+
+void stream_tagger::received( uint64_t samples )
+{
+  std::lock_guard< std::mutex > lock( _mutex );
+  _received += samples;
+}
+
+void stream_tagger::received( uint64_t samples, const osmosdr::time_spec_t &arrival )
+{
+  std::lock_guard< std::mutex > lock( _mutex );
+  _received += samples;
+  _clock.update( _received, arrival.get_real_secs() );
+}
+
+void stream_tagger::skipped( uint64_t samples )
+{
+  std::lock_guard< std::mutex > lock( _mutex );
+  _consumed += samples;
+}
+
+void stream_tagger::lost_oldest( uint64_t samples )
+{
+  std::lock_guard< std::mutex > lock( _mutex );
+  _consumed += samples;
+  _lost += samples;
+}
+
+void stream_tagger::lost_newest( uint64_t samples )
+{
+  std::lock_guard< std::mutex > lock( _mutex );
+
+  gap_t gap;
+  gap.at = _received - samples;
+  gap.samples = samples;
+  gap.filled = false;
+  _gaps.push_back( gap );
+}
+
+void stream_tagger::zero_filled( uint64_t samples )
+{
+  std::lock_guard< std::mutex > lock( _mutex );
+
+  gap_t gap;
+  gap.at = _received - samples;
+  gap.samples = samples;
+  gap.filled = true;
+  _gaps.push_back( gap );
+}
+
+void stream_tagger::set_freq_offset( double offset )
+{
+  std::lock_guard< std::mutex > lock( _mutex );
+  _freq_offset = offset;
+}
+
+void stream_tagger::begin_change()
+{
+  std::lock_guard< std::mutex > lock( _mutex );
+
+  if ( ! _changing ) {
+    _changing = true;
+    _change_start = _received + _latency;
+  }
+}
+
+void stream_tagger::end_change( const pmt::pmt_t &key, const pmt::pmt_t &value,
+                                uint64_t delay )
+{
+  std::lock_guard< std::mutex > lock( _mutex );
+
+  mark_t mark;
+  mark.valid_from = _received + _latency + delay + settle_samples();
+  mark.stale_from = _changing ? _change_start : _received + _latency;
+  mark.stale_from += delay;
+  mark.key = key;
+  mark.value = value;
+  mark.dwell = 0;
+
+  /* a dwell follows the retune, whatever else is applied along with it */
+  if ( pmt::eq( key, pmt::mp("rx_freq") ) ) {
+    mark.dwell = _next_dwell;
+    _next_dwell = 0;
+  }
+
+  _changing = false;
+
+  /* a scheduled change may come after ones made since */
+  std::deque< mark_t >::iterator pos = _marks.end();
+  while ( pos != _marks.begin() && (pos - 1)->stale_from > mark.stale_from )
+    --pos;
+
+  _marks.insert( pos, mark );
+}
+
+void stream_tagger::start_dwells()
+{
+  std::lock_guard< std::mutex > lock( _mutex );
+  _dwelling = true;
+  _dwell_left = 0; /* closed until the first hop */
+  _dwells_done = 0;
+}
+
+void stream_tagger::stop_dwells()
+{
+  {
+    std::lock_guard< std::mutex > lock( _mutex );
+    _dwelling = false;
+    _next_dwell = 0;
+  }
+  _cond.notify_all();
+}
+
+void stream_tagger::set_next_dwell( uint64_t samples )
+{
+  std::lock_guard< std::mutex > lock( _mutex );
+  _next_dwell = samples;
+}
+
+uint64_t stream_tagger::dwells_done()
+{
+  std::lock_guard< std::mutex > lock( _mutex );
+  return _dwells_done;
+}
+
+bool stream_tagger::wait_dwells( uint64_t count )
+{
+  std::unique_lock< std::mutex > lock( _mutex );
+
+  _cond.wait( lock, [this, count]() { return !_dwelling || _dwells_done >= count; } );
+
+  return _dwells_done >= count;
+}
+
+int stream_tagger::process( gr::block *block, gr_vector_void_star &outputs,
+                            int nitems, size_t itemsize )
+{
+  bool notify = false;
+  uint64_t written = 0;
+
+  {
+    std::lock_guard< std::mutex > lock( _mutex );
+
+    const uint64_t base = _consumed;
+    uint64_t end = base + nitems;
+    uint64_t i = base;
+    uint64_t shift = 0; /* indexes lost in between, not in the outputs */
+
+    while ( i < end ) {
+      while ( !_gaps.empty() && _gaps.front().at <= i ) {
+        const gap_t &gap = _gaps.front();
+
+        if ( ! gap.filled ) {
+          i += gap.samples;
+          end += gap.samples;
+          shift += gap.samples;
+        }
+
+        _lost += gap.samples;
+        _gaps.pop_front();
+      }
+
+      while ( !_marks.empty() && _marks.front().stale_from <= i ) {
+        const mark_t &mark = _marks.front();
+
+        _drop_until = std::max( _drop_until, mark.valid_from );
+
+        pmt::pmt_t value = mark.value;
+
+        if ( pmt::eq( mark.key, pmt::mp("rx_rate") ) ) {
+          _stream_rate = value;
+        } else if ( pmt::eq( mark.key, pmt::mp("rx_freq") ) ) {
+          if ( _freq_offset != 0 && pmt::is_real( value ) )
+            value = pmt::from_double( pmt::to_double( value ) + _freq_offset );
+          _stream_freq = value;
+        }
+
+        add_pending( mark.key, value, true );
+
+        /* other changes in the middle of a dwell leave it running */
+        if ( _dwelling && mark.dwell )
+          _dwell_left = mark.dwell;
+
+        _marks.pop_front();
+      }
+
+      uint64_t next = end;
+      if ( !_marks.empty() )
+        next = std::min( next, _marks.front().stale_from );
+      if ( !_gaps.empty() )
+        next = std::min( next, _gaps.front().at );
+
+      if ( i < _drop_until ) { /* not settled yet */
+        i = std::min( next, _drop_until );
+        continue;
+      }
+
+      if ( _dwelling && _dwell_left == 0 ) { /* between dwells */
+        i = next;
+        continue;
+      }
+
+      /* restate the stream state after a discontinuity, like uhd does */
+      const bool gap = ! _timed || i != _next_index;
+      if ( gap && ! pmt::is_null( _stream_rate ) )
+        add_pending( pmt::mp("rx_rate"), _stream_rate, false );
+      if ( gap && ! pmt::is_null( _stream_freq ) )
+        add_pending( pmt::mp("rx_freq"), _stream_freq, false );
+
+      /* time the first sample, the ones following a gap and now and then */
+      double time;
+      if ( ( gap || i >= _retag_at ) && _clock.time_at( i, time ) ) {
+        add_pending( pmt::mp("rx_time"), time_value( time ), false );
+        _retag_at = i + uint64_t( _clock.rate() * RETAG_INTERVAL );
+      }
+
+      if ( _lost ) {
+        add_pending( pmt::mp("overflow"), pmt::from_uint64( _lost ), true );
+        _lost = 0;
+      }
+
+      uint64_t len = next - i;
+      if ( _dwelling )
+        len = std::min( len, _dwell_left );
+      if ( _retag_at > i )
+        len = std::min( len, _retag_at - i );
+
+      for (size_t n = 0; n < outputs.size(); n++) {
+        char *out = static_cast< char * >( outputs[n] );
+
+        for (size_t p = 0; p < _pending.size(); p++)
+          block->add_item_tag( n, block->nitems_written( n ) + written,
+                               _pending[p].first, _pending[p].second,
+                               block->alias_pmt() );
+
+        if ( i - base - shift != written )
+          memmove( out + written * itemsize, out + (i - base - shift) * itemsize,
+                   len * itemsize );
+      }
+
+      _pending.clear();
+
+      written += len;
+      i += len;
+
+      _timed = true;
+      _next_index = i;
+
+      if ( _dwelling ) {
+        _dwell_left -= len;
+        if ( _dwell_left == 0 ) {
+          _dwells_done++;
+          notify = true;
+        }
+      }
+    }
+
+    _consumed = end;
+  }
+
+  if ( notify )
+    _cond.notify_all();
+
+  return int(written);
+}
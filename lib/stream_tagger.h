@@ -0,0 +1,185 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef OSMOSDR_STREAM_TAGGER_H
+#define OSMOSDR_STREAM_TAGGER_H
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <stdint.h>
+
+#include <osmosdr/api.h>
+#include <osmosdr/time_spec.h>
+#include <gnuradio/block.h>
+#include <gnuradio/gr_complex.h>
+
+#include "clock_filter.h"
+#include "start_barrier.h"
+
+/*
+ * Keeps track of the samples of a source backend across reconfiguration.
+ *
+ * The producer side counts the samples received from the device. A setter
+ * brackets its device calls with begin_change() and end_change(), every
+ * sample captured from the start of the change until the device settled
+ * again is discarded by process() and the first valid sample carries the
+ * tag passed to end_change().
+ *
+ * Received samples are counted by index, a change starting at received
+ * sample N affects the samples from N + latency, where latency is what the
+ * device may have captured but not yet delivered (a transfer in flight).
+ *
+ * For frequency hopping the stream can be gated into dwells: after
+ * start_dwells() only the number of samples given to set_next_dwell() is
+ * passed on after the next rx_freq change, everything else is discarded.
+ *
+ * With a start barrier, the stream start is lined up with the other
+ * devices sharing it and the first valid sample is tagged rx_time.
+ *
+ * If the producer passes the host time its buffers arrived at, the first
+ * sample, every sample following a gap and one sample a second are tagged
+ * rx_time, estimated by a clock_filter over the arrival times. The first
+ * sample and those following a gap carry the last rx_rate and rx_freq too.
+ */
+class OSMOSDR_API stream_tagger
+{
+public:
+  stream_tagger();
+
+  /* what a producer does when its buffers are full */
+  enum overflow_policy
+  {
+    DROP_OLDEST,
+    DROP_NEWEST,
+    ZERO_FILL /* drop the newest, keep time with as many zeros */
+  };
+
+  /* from the overflow=drop_oldest|drop_newest|zero_fill device argument */
+  static overflow_policy parse_overflow_policy( const std::string &value );
+
+  /* samples the device may hold before they are received */
+  void set_latency( uint64_t samples );
+  /* time the device needs to settle after a change */
+  void set_settle_time( double seconds );
+  void set_sample_rate( double rate );
+
+  void set_start_barrier( const std::shared_ptr< start_barrier > &barrier );
+  /* called by start() right before the device begins to stream */
+  void sync_start( void );
+
+  /* producer side: samples received from the device */
+  void received( uint64_t samples );
+  void received( uint64_t samples, const osmosdr::time_spec_t &arrival );
+  /* received samples dropped before process() saw them, e.g. on overflow */
+  void skipped( uint64_t samples );
+
+  /*
+   * Overflow accounting, the first sample following lost ones is tagged
+   * overflow with their count. Lost are the oldest samples not yet passed
+   * to process(), the newest ones just received, or the newest ones just
+   * received when the producer puts as many zeros in their place.
+   */
+  void lost_oldest( uint64_t samples );
+  void lost_newest( uint64_t samples );
+  void zero_filled( uint64_t samples );
+
+  /* added to the rx_freq values, for a device tuned off the channel */
+  void set_freq_offset( double offset );
+
+  void begin_change( void );
+  /* delay is the number of samples a scheduled change takes effect after */
+  void end_change( const pmt::pmt_t &key, const pmt::pmt_t &value,
+                   uint64_t delay = 0 );
+
+  void start_dwells( void );
+  void stop_dwells( void );
+  void set_next_dwell( uint64_t samples );
+  uint64_t dwells_done( void );
+  /* false if the dwells were stopped before count of them completed */
+  bool wait_dwells( uint64_t count );
+
+  /*
+   * Drop the discarded samples out of the nitems just written to each of
+   * the outputs of block and add the pending tags to the first valid one.
+   * Returns the number of items left per output.
+   */
+  int process( gr::block *block, gr_vector_void_star &outputs, int nitems,
+               size_t itemsize = sizeof(gr_complex) );
+
+private:
+  uint64_t settle_samples( void ) const;
+  void add_pending( const pmt::pmt_t &key, const pmt::pmt_t &value, bool replace );
+
+  struct gap_t
+  {
+    uint64_t at;
+    uint64_t samples;
+    bool filled; /* zeros in the stream instead of nothing */
+  };
+
+  struct mark_t
+  {
+    uint64_t stale_from;
+    uint64_t valid_from;
+    pmt::pmt_t key;
+    pmt::pmt_t value;
+    uint64_t dwell;
+  };
+
+  std::mutex _mutex;
+  std::condition_variable _cond;
+
+  uint64_t _received;
+  uint64_t _consumed;
+  uint64_t _latency;
+  double _settle_time;
+  double _rate;
+
+  std::shared_ptr< start_barrier > _barrier;
+
+  bool _changing;
+  uint64_t _change_start;
+  std::deque< mark_t > _marks;
+  uint64_t _drop_until;
+  std::vector< std::pair< pmt::pmt_t, pmt::pmt_t > > _pending;
+  std::deque< gap_t > _gaps;
+  uint64_t _lost; /* not yet tagged */
+
+  bool _dwelling;
+  uint64_t _next_dwell;
+  uint64_t _dwell_left;
+  uint64_t _dwells_done;
+  double _freq_offset;
+
+  clock_filter _clock;
+  bool _timed; /* something was passed on since the start */
+  uint64_t _next_index; /* following the last sample passed on */
+  uint64_t _retag_at;
+  pmt::pmt_t _stream_rate; /* last rx_rate and rx_freq passed on */
+  pmt::pmt_t _stream_freq;
+};
+
+#endif // OSMOSDR_STREAM_TAGGER_H
@@ -0,0 +1,68 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef OSMOSDR_STREAM_TYPE_H
+#define OSMOSDR_STREAM_TYPE_H
+
+#include <stdexcept>
+#include <string>
+
+#include <stdint.h>
+
+#include <gnuradio/gr_complex.h>
+
+/*
+ * Sample formats of the streams, selected by the otype=fc32|sc16|sc8
+ * argument. Integer samples are interleaved I/Q at full scale, 32768 and
+ * 128 correspond to 1.0 of the fc32 samples.
+ */
+enum stream_type_t
+{
+  STREAM_FC32,
+  STREAM_SC16,
+  STREAM_SC8
+};
+
+inline stream_type_t stream_type_from_string( const std::string &name )
+{
+  if ( name == "fc32" )
+    return STREAM_FC32;
+  if ( name == "sc16" )
+    return STREAM_SC16;
+  if ( name == "sc8" )
+    return STREAM_SC8;
+
+  throw std::runtime_error( "Unsupported stream type '" + name +
+                            "', expected fc32, sc16 or sc8." );
+}
+
+inline size_t stream_item_size( stream_type_t type )
+{
+  switch ( type ) {
+  case STREAM_SC16:
+    return 2 * sizeof(int16_t);
+  case STREAM_SC8:
+    return 2 * sizeof(int8_t);
+  default:
+    return sizeof(gr_complex);
+  }
+}
+
+#endif // OSMOSDR_STREAM_TYPE_H
@@ -0,0 +1,206 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include <gnuradio/io_signature.h>
+#include <gnuradio/fft/window.h>
+
+#include "sweep_engine.h"
+
+sweep_stitcher::sweep_stitcher( size_t nsteps, size_t step_bins,
+                                double start_freq, double bin_width )
+  : _span( nsteps * step_bins, 0 ),
+    _done( nsteps, 0 ),
+    _ndone(0),
+    _step_bins(step_bins),
+    _start_freq(start_freq),
+    _bin_width(bin_width),
+    _sweeps(0)
+{
+}
+
+bool sweep_stitcher::add( size_t step, const float *bins, pmt::pmt_t &pdu )
+{
+  std::lock_guard< std::mutex > lock( _mutex );
+
+  if ( step >= _done.size() )
+    return false;
+
+  std::copy( bins, bins + _step_bins, _span.begin() + step * _step_bins );
+
+  if ( ! _done[ step ] ) {
+    _done[ step ] = 1;
+    _ndone++;
+  }
+
+  if ( _ndone < _done.size() )
+    return false;
+
+  pmt::pmt_t meta = pmt::make_dict();
+  meta = pmt::dict_add( meta, pmt::mp("start_freq"), pmt::from_double( _start_freq ) );
+  meta = pmt::dict_add( meta, pmt::mp("bin_width"), pmt::from_double( _bin_width ) );
+  meta = pmt::dict_add( meta, pmt::mp("sweep"), pmt::from_uint64( _sweeps++ ) );
+
+  pdu = pmt::cons( meta, pmt::init_f32vector( _span.size(), _span ) );
+
+  std::fill( _done.begin(), _done.end(), 0 );
+  _ndone = 0;
+
+  return true;
+}
+
+sweep_engine_sptr make_sweep_engine( size_t fft_size, size_t averages,
+                                     size_t step_bins,
+                                     const std::vector< double > &centers,
+                                     const std::vector< size_t > &steps,
+                                     sweep_stitcher_sptr stitcher )
+{
+  return gnuradio::get_initial_sptr(
+        new sweep_engine( fft_size, averages, step_bins, centers, steps, stitcher ) );
+}
+
+sweep_engine::sweep_engine( size_t fft_size, size_t averages, size_t step_bins,
+                            const std::vector< double > &centers,
+                            const std::vector< size_t > &steps,
+                            sweep_stitcher_sptr stitcher )
+  : gr::sync_block( "sweep_engine",
+                    gr::io_signature::make(1, 1, sizeof(gr_complex)),
+                    gr::io_signature::make(0, 0, 0) ),
+    _fft_size(fft_size),
+    _averages(averages),
+    _step_bins(step_bins),
+    _centers(centers),
+    _steps(steps),
+    _stitcher(stitcher),
+    _fft(fft_size, true),
+    _window(gr::fft::window::blackmanharris(fft_size)),
+    _step(-1),
+    _fill(0),
+    _frames(0),
+    _acc(fft_size, 0),
+    _bins(step_bins, 0)
+{
+  /* a full scale tone in the middle of a bin reads 0 dB */
+  float sum = 0;
+  for (size_t i = 0; i < _window.size(); i++)
+    sum += _window[i];
+  _scale = sum * sum;
+
+  message_port_register_out( pmt::mp("sweep") );
+}
+
+sweep_engine::~sweep_engine()
+{
+}
+
+void sweep_engine::begin_step( double freq )
+{
+  _step = -1;
+
+  double best = 0;
+  for (size_t i = 0; i < _centers.size(); i++) {
+    double dist = std::fabs( _centers[i] - freq );
+    if ( _step < 0 || dist < best ) {
+      _step = i;
+      best = dist;
+    }
+  }
+
+  _fill = 0;
+  _frames = 0;
+  std::fill( _acc.begin(), _acc.end(), 0 );
+}
+
+void sweep_engine::feed( const gr_complex *in, size_t nitems )
+{
+  gr_complex *frame = _fft.get_inbuf();
+
+  while ( nitems && _step >= 0 ) {
+    size_t n = std::min( nitems, _fft_size - _fill );
+
+    for (size_t i = 0; i < n; i++)
+      frame[_fill + i] = in[i] * _window[_fill + i];
+
+    _fill += n;
+    in += n;
+    nitems -= n;
+
+    if ( _fill == _fft_size )
+      finish_frame();
+  }
+}
+
+void sweep_engine::finish_frame()
+{
+  _fft.execute();
+
+  const gr_complex *out = _fft.get_outbuf();
+  for (size_t i = 0; i < _fft_size; i++)
+    _acc[i] += std::norm( out[i] );
+
+  _fill = 0;
+
+  if ( ++_frames < _averages )
+    return;
+
+  /* keep the center of the spectrum, the filter rolloff is at the edges */
+  const size_t first = (_fft_size - _step_bins) / 2;
+  const float scale = _scale * _averages;
+
+  for (size_t i = 0; i < _step_bins; i++) {
+    float power = _acc[ (first + i + _fft_size / 2) % _fft_size ] / scale;
+    _bins[i] = 10.0f * std::log10( std::max( power, 1e-20f ) );
+  }
+
+  pmt::pmt_t pdu;
+  if ( _stitcher->add( _steps[ _step ], &_bins[0], pdu ) )
+    message_port_pub( pmt::mp("sweep"), pdu );
+
+  _step = -1; /* the rest of the dwell is not used */
+}
+
+int sweep_engine::work( int noutput_items,
+                        gr_vector_const_void_star &input_items,
+                        gr_vector_void_star &output_items )
+{
+  const gr_complex *in = (const gr_complex *) input_items[0];
+  const uint64_t start = nitems_read(0);
+
+  std::vector< gr::tag_t > tags;
+  get_tags_in_range( tags, 0, start, start + noutput_items, pmt::mp("rx_freq") );
+  std::sort( tags.begin(), tags.end(),
+             []( const gr::tag_t &a, const gr::tag_t &b ) { return a.offset < b.offset; } );
+
+  size_t pos = 0;
+  for (size_t t = 0; t < tags.size(); t++) {
+    size_t at = tags[t].offset - start;
+
+    feed( in + pos, at - pos );
+    begin_step( pmt::to_double( tags[t].value ) );
+    pos = at;
+  }
+
+  feed( in + pos, noutput_items - pos );
+
+  return noutput_items;
+}
@@ -0,0 +1,120 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef INCLUDED_OSMOSDR_SWEEP_ENGINE_H
+#define INCLUDED_OSMOSDR_SWEEP_ENGINE_H
+
+#include <gnuradio/sync_block.h>
+#include <gnuradio/fft/fft.h>
+
+#include <boost/shared_ptr.hpp>
+
+#include <mutex>
+#include <vector>
+
+/*
+ * Collects the trimmed spectra of all steps of a sweep into one span and
+ * hands it out as soon as every step has been measured once.
+ */
+class sweep_stitcher
+{
+public:
+  sweep_stitcher( size_t nsteps, size_t step_bins,
+                  double start_freq, double bin_width );
+
+  /* true with the finished sweep in pdu if this step completed it */
+  bool add( size_t step, const float *bins, pmt::pmt_t &pdu );
+
+private:
+  std::mutex _mutex;
+  std::vector< float > _span;
+  std::vector< char > _done;
+  size_t _ndone;
+  size_t _step_bins;
+  double _start_freq;
+  double _bin_width;
+  uint64_t _sweeps;
+};
+
+typedef boost::shared_ptr< sweep_stitcher > sweep_stitcher_sptr;
+
+class sweep_engine;
+
+typedef boost::shared_ptr<sweep_engine> sweep_engine_sptr;
+
+/*
+ * centers are the tuning frequencies of the steps measured through this
+ * engine and steps their position within the span of the stitcher.
+ */
+sweep_engine_sptr make_sweep_engine( size_t fft_size, size_t averages,
+                                     size_t step_bins,
+                                     const std::vector< double > &centers,
+                                     const std::vector< size_t > &steps,
+                                     sweep_stitcher_sptr stitcher );
+
+/*!
+ * \brief Averages windowed FFTs over the dwell of each hop, which starts
+ * at an rx_freq tag, and passes the center bins on to the stitcher.
+ * Completed sweeps are published on the "sweep" message port.
+ */
+class sweep_engine : public gr::sync_block
+{
+private:
+  friend sweep_engine_sptr make_sweep_engine( size_t fft_size, size_t averages,
+                                              size_t step_bins,
+                                              const std::vector< double > &centers,
+                                              const std::vector< size_t > &steps,
+                                              sweep_stitcher_sptr stitcher );
+
+  sweep_engine( size_t fft_size, size_t averages, size_t step_bins,
+                const std::vector< double > &centers,
+                const std::vector< size_t > &steps,
+                sweep_stitcher_sptr stitcher );
+
+public:
+  ~sweep_engine();
+
+  int work( int noutput_items,
+            gr_vector_const_void_star &input_items,
+            gr_vector_void_star &output_items );
+
+private:
+  void begin_step( double freq );
+  void feed( const gr_complex *in, size_t nitems );
+  void finish_frame( void );
+
+  size_t _fft_size;
+  size_t _averages;
+  size_t _step_bins;
+  std::vector< double > _centers;
+  std::vector< size_t > _steps;
+  sweep_stitcher_sptr _stitcher;
+
+  gr::fft::fft_complex _fft;
+  std::vector< float > _window;
+  float _scale;
+
+  long _step;            /* index into _centers, -1 until the first tag */
+  size_t _fill;          /* samples in the current frame */
+  size_t _frames;        /* frames accumulated for the current step */
+  std::vector< float > _acc;
+  std::vector< float > _bins;
+};
+
+#endif /* INCLUDED_OSMOSDR_SWEEP_ENGINE_H */
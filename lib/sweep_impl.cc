@@ -0,0 +1,155 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <set>
+#include <stdexcept>
+
+#include <gnuradio/io_signature.h>
+#include <gnuradio/blocks/null_sink.h>
+
+#include "sweep_engine.h"
+#include "sweep_impl.h"
+
+/*
+ * Create a new instance of sweep_impl and return
+ * a boost shared_ptr.  This is effectively the public constructor.
+ */
+osmosdr::sweep::sptr
+osmosdr::sweep::make( osmosdr::source::sptr source,
+                      double start_freq, double stop_freq,
+                      size_t fft_size, size_t averages,
+                      double overlap, bool parallel )
+{
+  return gnuradio::get_initial_sptr( new sweep_impl( source, start_freq, stop_freq,
+                                                     fft_size, averages,
+                                                     overlap, parallel ) );
+}
+
+sweep_impl::sweep_impl( osmosdr::source::sptr source,
+                        double start_freq, double stop_freq,
+                        size_t fft_size, size_t averages,
+                        double overlap, bool parallel )
+  : gr::hier_block2 ("sweep_impl",
+        gr::io_signature::make(0, 0, 0),
+        gr::io_signature::make(0, 0, 0)),
+    _source(source)
+{
+  if ( stop_freq <= start_freq )
+    throw std::runtime_error( "The sweep span is empty." );
+
+  if ( fft_size < 2 || fft_size % 2 || averages < 1 )
+    throw std::runtime_error( "The FFT size has to be even and at least one average is needed." );
+
+  if ( overlap < 0 || overlap >= 1 )
+    throw std::runtime_error( "The overlap has to be within [0, 1)." );
+
+  const double rate = _source->get_sample_rate();
+  if ( rate <= 0 )
+    throw std::runtime_error( "The sample rate of the source has to be set first." );
+
+  _bin_width = rate / fft_size;
+
+  const size_t step_bins = std::max< size_t >( 1, std::lround( fft_size * (1 - overlap) ) );
+  const size_t nsteps = size_t( std::ceil( (stop_freq - start_freq) / (step_bins * _bin_width) ) );
+  const size_t first = (fft_size - step_bins) / 2;
+
+  _num_bins = nsteps * step_bins;
+
+  /* tune so the kept bins of consecutive steps line up edge to edge */
+  for (size_t step = 0; step < nsteps; step++)
+    _step_freqs.push_back( start_freq + (step * step_bins + fft_size / 2 - first) * _bin_width );
+
+  const size_t num_channels = _source->get_num_channels();
+
+  /* hop schedules are per device, so one channel of each */
+  _chans.push_back( 0 );
+
+  if ( parallel ) {
+    std::set< size_t > mboards;
+    mboards.insert( _source->get_mboard( 0 ) );
+
+    for (size_t chan = 1; chan < num_channels; chan++)
+      if ( mboards.insert( _source->get_mboard( chan ) ).second )
+        _chans.push_back( chan );
+
+    if ( _chans.size() < 2 )
+      throw std::runtime_error( "A parallel sweep needs channels on at least two devices." );
+
+    _chans.resize( std::min( _chans.size(), nsteps ) );
+  }
+
+  const size_t nchans = _chans.size();
+
+  sweep_stitcher_sptr stitcher( new sweep_stitcher( nsteps, step_bins,
+                                                    start_freq, _bin_width ) );
+
+  message_port_register_hier_out( pmt::mp("sweep") );
+
+  for (size_t chan = 0; chan < num_channels; chan++) {
+    const size_t part = std::find( _chans.begin(), _chans.end(), chan ) - _chans.begin();
+
+    if ( part == nchans ) {
+      connect( _source, chan, gr::blocks::null_sink::make( sizeof(gr_complex) ), 0 );
+      continue;
+    }
+
+    /* a contiguous part of the span per device */
+    std::vector< double > centers;
+    std::vector< size_t > steps;
+    osmosdr::hop_schedule_t hops;
+
+    for (size_t step = part * nsteps / nchans; step < (part + 1) * nsteps / nchans; step++) {
+      centers.push_back( _step_freqs[ step ] );
+      steps.push_back( step );
+      hops.push_back( osmosdr::hop_t( _step_freqs[ step ], fft_size * averages ) );
+    }
+
+    sweep_engine_sptr engine = make_sweep_engine( fft_size, averages, step_bins,
+                                                  centers, steps, stitcher );
+
+    connect( _source, chan, engine, 0 );
+    msg_connect( engine, "sweep", self(), "sweep" );
+
+    _source->set_hop_schedule( hops, chan );
+  }
+}
+
+sweep_impl::~sweep_impl()
+{
+  for (size_t chan : _chans)
+    _source->set_hop_schedule( osmosdr::hop_schedule_t(), chan );
+}
+
+size_t sweep_impl::get_num_bins()
+{
+  return _num_bins;
+}
+
+double sweep_impl::get_bin_width()
+{
+  return _bin_width;
+}
+
+std::vector< double > sweep_impl::get_step_freqs()
+{
+  return _step_freqs;
+}
@@ -0,0 +1,47 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef INCLUDED_OSMOSDR_SWEEP_IMPL_H
+#define INCLUDED_OSMOSDR_SWEEP_IMPL_H
+
+#include <osmosdr/sweep.h>
+
+class sweep_impl : public osmosdr::sweep
+{
+public:
+  sweep_impl( osmosdr::source::sptr source,
+              double start_freq, double stop_freq,
+              size_t fft_size, size_t averages,
+              double overlap, bool parallel );
+  ~sweep_impl();
+
+  size_t get_num_bins( void );
+  double get_bin_width( void );
+  std::vector< double > get_step_freqs( void );
+
+private:
+  osmosdr::source::sptr _source;
+  std::vector< size_t > _chans; /* swept, one per device */
+
+  size_t _num_bins;
+  double _bin_width;
+  std::vector< double > _step_freqs;
+};
+
+#endif /* INCLUDED_OSMOSDR_SWEEP_IMPL_H */
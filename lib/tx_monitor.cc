@@ -0,0 +1,103 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "tx_monitor.h"
+
+#define DEFAULT_PREFILL_BUFFERS 1
+
+tx_monitor::tx_monitor()
+  : _block(NULL),
+    _prefill_time(0),
+    _prefill_buffers(DEFAULT_PREFILL_BUFFERS),
+    _underflows(0),
+    _samples(0)
+{
+}
+
+void tx_monitor::attach( gr::basic_block *block )
+{
+  _block = block;
+  _block->message_port_register_out( pmt::mp("tx_underflow") );
+}
+
+void tx_monitor::set_prefill( const std::string &value )
+{
+  size_t pos = 0;
+  double amount = -1;
+
+  try {
+    amount = std::stod( value, &pos );
+  } catch ( std::exception & ) {
+  }
+
+  std::string unit = value.substr( std::min( pos, value.size() ) );
+
+  if ( amount < 0 || std::isnan( amount ) || (unit != "" && unit != "ms") )
+    throw std::runtime_error( "Invalid prefill '" + value +
+                              "', expected a number of buffers or milliseconds (e.g. 20ms)." );
+
+  if ( unit == "ms" ) {
+    _prefill_time = amount / 1000.0;
+    _prefill_buffers = 0;
+  } else {
+    _prefill_time = 0;
+    _prefill_buffers = uint64_t( std::ceil( amount ) );
+  }
+}
+
+uint64_t tx_monitor::prefill( double rate, uint64_t buffer_len, uint64_t capacity ) const
+{
+  uint64_t samples = _prefill_buffers * buffer_len;
+
+  if ( _prefill_time > 0 && rate > 0 )
+    samples = uint64_t( std::ceil( _prefill_time * rate ) );
+
+  return std::min( samples, capacity );
+}
+
+void tx_monitor::underflow( uint64_t samples )
+{
+  uint64_t count = ++_underflows;
+  uint64_t total = ( _samples += samples );
+
+  if ( ! _block )
+    return;
+
+  pmt::pmt_t msg = pmt::make_dict();
+  msg = pmt::dict_add( msg, pmt::mp("underflows"), pmt::from_uint64( count ) );
+  msg = pmt::dict_add( msg, pmt::mp("samples"), pmt::from_uint64( samples ) );
+  msg = pmt::dict_add( msg, pmt::mp("total_samples"), pmt::from_uint64( total ) );
+
+  _block->message_port_pub( pmt::mp("tx_underflow"), msg );
+}
+
+uint64_t tx_monitor::underflows( void ) const
+{
+  return _underflows;
+}
+
+uint64_t tx_monitor::underflow_samples( void ) const
+{
+  return _samples;
+}
@@ -0,0 +1,70 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef OSMOSDR_TX_MONITOR_H
+#define OSMOSDR_TX_MONITOR_H
+
+#include <atomic>
+#include <string>
+
+#include <stdint.h>
+
+#include <osmosdr/api.h>
+#include <gnuradio/basic_block.h>
+
+/*
+ * Start-up and underflow bookkeeping of a sink backend.
+ *
+ * The hardware is not started before prefill() samples are queued, given
+ * by the prefill=<n> (buffers) or prefill=<n>ms device argument. Once
+ * started, the backend reports every buffer it had to fill with zeros to
+ * underflow(), which counts it and publishes a dict on the tx_underflow
+ * message port of the block the monitor is attached to.
+ */
+class OSMOSDR_API tx_monitor
+{
+public:
+  tx_monitor();
+
+  /* registers the tx_underflow port, from the backend constructor */
+  void attach( gr::basic_block *block );
+
+  void set_prefill( const std::string &value );
+
+  /* samples to queue before starting, at most capacity */
+  uint64_t prefill( double rate, uint64_t buffer_len, uint64_t capacity ) const;
+
+  /* samples is 0 if the device does not tell */
+  void underflow( uint64_t samples );
+
+  uint64_t underflows( void ) const;
+  uint64_t underflow_samples( void ) const;
+
+private:
+  gr::basic_block *_block;
+
+  double _prefill_time;
+  uint64_t _prefill_buffers;
+
+  std::atomic< uint64_t > _underflows;
+  std::atomic< uint64_t > _samples;
+};
+
+#endif // OSMOSDR_TX_MONITOR_H
@@ -455,3 +455,14 @@ void uhd_source_c::set_time_unknown_pps(const osmosdr::time_spec_t &time_spec)
 {
   _src->set_time_unknown_pps( uhd::time_spec_t( time_spec.get_full_secs(), time_spec.get_frac_secs() ) );
 }
+
+bool uhd_source_c::set_command_time(const osmosdr::time_spec_t &time_spec, size_t mboard)
+{
+  _src->set_command_time( uhd::time_spec_t( time_spec.get_full_secs(), time_spec.get_frac_secs() ), mboard );
+  return true;
+}
+
+void uhd_source_c::clear_command_time(size_t mboard)
+{
+  _src->clear_command_time( mboard );
+}
@@ -0,0 +1,207 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <gnuradio/io_signature.h>
+#include <gnuradio/fft/window.h>
+
+#include <volk/volk.h>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "vfo_bank.h"
+
+#define TAPS_PER_DECIM 8 /* filter length per unit of decimation */
+#define DEFAULT_BANDWIDTH 0.8 /* of the output rate */
+
+vfo_bank_sptr make_vfo_bank( const std::vector< size_t > &decimations )
+{
+  return gnuradio::get_initial_sptr( new vfo_bank( decimations ) );
+}
+
+vfo_bank::vfo_bank( const std::vector< size_t > &decimations )
+  : gr::block( "vfo_bank",
+               gr::io_signature::make(1, 1, sizeof(gr_complex)),
+               gr::io_signature::make(decimations.size(), decimations.size(),
+                                      sizeof(gr_complex)) ),
+    _rate( 0 ),
+    _min_decim( 0 )
+{
+  if ( decimations.empty() )
+    throw std::runtime_error( "vfo_bank: no receivers given." );
+
+  for (size_t decim : decimations) {
+    vfo_t vfo;
+
+    vfo.decim = std::max( decim, size_t(1) );
+    vfo.offset = 0;
+    vfo.bandwidth = 0;
+    vfo.phase = gr_complex(1, 0);
+    vfo.taps.resize( vfo.decim * TAPS_PER_DECIM + 1 );
+    vfo.shifted.assign( vfo.taps.size() - 1, gr_complex(0, 0) );
+    vfo.skip = 0;
+    design( vfo );
+
+    _min_decim = _min_decim ? std::min( _min_decim, vfo.decim ) : vfo.decim;
+    _vfos.push_back( vfo );
+  }
+
+  set_tag_propagation_policy( TPP_DONT );
+  set_relative_rate( 1.0 / _min_decim );
+}
+
+void vfo_bank::set_rate( double rate )
+{
+  std::lock_guard< std::mutex > lock( _mutex );
+
+  _rate = rate;
+
+  for (vfo_t &vfo : _vfos)
+    design( vfo );
+}
+
+double vfo_bank::set_offset( size_t k, double offset )
+{
+  std::lock_guard< std::mutex > lock( _mutex );
+
+  if ( k >= _vfos.size() )
+    return 0;
+
+  if ( _rate > 0 ) /* within the input band */
+    offset = std::max( -_rate / 2, std::min( offset, _rate / 2 ) );
+
+  _vfos[k].offset = offset;
+  design( _vfos[k] );
+
+  return offset;
+}
+
+double vfo_bank::offset( size_t k )
+{
+  std::lock_guard< std::mutex > lock( _mutex );
+  return k < _vfos.size() ? _vfos[k].offset : 0;
+}
+
+double vfo_bank::set_bandwidth( size_t k, double bandwidth )
+{
+  std::lock_guard< std::mutex > lock( _mutex );
+
+  if ( k >= _vfos.size() )
+    return 0;
+
+  _vfos[k].bandwidth = bandwidth;
+  design( _vfos[k] );
+
+  return actual_bandwidth( _vfos[k] );
+}
+
+double vfo_bank::bandwidth( size_t k )
+{
+  std::lock_guard< std::mutex > lock( _mutex );
+  return k < _vfos.size() ? actual_bandwidth( _vfos[k] ) : 0;
+}
+
+size_t vfo_bank::decimation( size_t k )
+{
+  return k < _vfos.size() ? _vfos[k].decim : 0;
+}
+
+double vfo_bank::actual_bandwidth( const vfo_t &vfo )
+{
+  if ( vfo.bandwidth > 0 )
+    return _rate > 0 ? std::min( vfo.bandwidth, _rate ) : vfo.bandwidth;
+
+  return DEFAULT_BANDWIDTH * _rate / vfo.decim;
+}
+
+void vfo_bank::design( vfo_t &vfo )
+{
+  const size_t length = vfo.taps.size();
+  const double center = (length - 1) / 2.0;
+
+  double width = DEFAULT_BANDWIDTH / vfo.decim; /* of the input rate, both sides */
+  if ( _rate > 0 && vfo.bandwidth > 0 )
+    width = std::min( vfo.bandwidth / _rate, 1.0 );
+
+  const std::vector< float > window = gr::fft::window::blackmanharris( length );
+  std::vector< double > proto( length );
+  double sum = 0;
+
+  for (size_t n = 0; n < length; n++) {
+    const double x = width * (n - center);
+    proto[n] = width * (x == 0 ? 1.0 : std::sin( M_PI * x ) / ( M_PI * x )) * window[n];
+    sum += proto[n];
+  }
+
+  for (size_t n = 0; n < length; n++)
+    vfo.taps[n] = float( proto[n] / sum );
+
+  vfo.phase_inc = gr_complex(1, 0);
+  if ( _rate > 0 )
+    vfo.phase_inc = std::polar( 1.0f, float( -2 * M_PI * vfo.offset / _rate ) );
+}
+
+void vfo_bank::forecast( int noutput_items, gr_vector_int &ninput_items_required )
+{
+  ninput_items_required[0] = noutput_items * _min_decim;
+}
+
+int vfo_bank::general_work( int noutput_items,
+                            gr_vector_int &ninput_items,
+                            gr_vector_const_void_star &input_items,
+                            gr_vector_void_star &output_items )
+{
+  const gr_complex *in = static_cast< const gr_complex * >( input_items[0] );
+
+  std::lock_guard< std::mutex > lock( _mutex );
+
+  /* as many inputs as none of the receivers runs out of output space */
+  size_t nin = ninput_items[0];
+  for (const vfo_t &vfo : _vfos)
+    nin = std::min( nin, vfo.skip + size_t(noutput_items) * vfo.decim );
+
+  for (size_t k = 0; k < _vfos.size(); k++) {
+    vfo_t &vfo = _vfos[k];
+    gr_complex *out = static_cast< gr_complex * >( output_items[k] );
+    const size_t history = vfo.taps.size() - 1;
+
+    vfo.shifted.resize( history + nin );
+    volk_32fc_s32fc_x2_rotator_32fc( &vfo.shifted[history], in, vfo.phase_inc,
+                                     &vfo.phase, nin );
+
+    /* pos is the newest input of the next output, its window starts there */
+    size_t pos = vfo.skip, nout = 0;
+    for (; pos < nin; pos += vfo.decim)
+      volk_32fc_32f_dot_prod_32fc( &out[nout++], &vfo.shifted[pos],
+                                   &vfo.taps[0], vfo.taps.size() );
+
+    vfo.skip = pos - nin;
+
+    std::copy( vfo.shifted.end() - history, vfo.shifted.end(), vfo.shifted.begin() );
+    vfo.shifted.resize( history );
+
+    produce( k, nout );
+  }
+
+  consume_each( nin );
+
+  return WORK_CALLED_PRODUCE;
+}
@@ -0,0 +1,94 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef INCLUDED_OSMOSDR_VFO_BANK_H
+#define INCLUDED_OSMOSDR_VFO_BANK_H
+
+#include <gnuradio/block.h>
+
+#include <mutex>
+#include <vector>
+
+class vfo_bank;
+
+typedef boost::shared_ptr<vfo_bank> vfo_bank_sptr;
+
+vfo_bank_sptr make_vfo_bank( const std::vector< size_t > &decimations );
+
+/*!
+ * \brief Independent narrowband receivers reading one wideband stream,
+ * one output each. A receiver shifts its offset from the input center to
+ * 0 Hz with a volk rotator and filters and decimates by its own factor.
+ *
+ * Every call takes the same inputs for all receivers, keeping the filter
+ * history of each one across calls. The outputs run at different rates,
+ * so tags are not propagated.
+ */
+class vfo_bank : public gr::block
+{
+private:
+  friend vfo_bank_sptr make_vfo_bank( const std::vector< size_t > &decimations );
+
+  vfo_bank( const std::vector< size_t > &decimations );
+
+public:
+  /* the input rate, offsets and bandwidths are kept in Hz across changes */
+  void set_rate( double rate );
+
+  double set_offset( size_t k, double offset );
+  double offset( size_t k );
+
+  /* 0 selects 80% of the output rate */
+  double set_bandwidth( size_t k, double bandwidth );
+  double bandwidth( size_t k );
+
+  size_t decimation( size_t k );
+
+  void forecast( int noutput_items, gr_vector_int &ninput_items_required );
+
+  int general_work( int noutput_items,
+                    gr_vector_int &ninput_items,
+                    gr_vector_const_void_star &input_items,
+                    gr_vector_void_star &output_items );
+
+private:
+  struct vfo_t
+  {
+    size_t decim;
+    double offset;
+    double bandwidth;
+
+    gr_complex phase;
+    gr_complex phase_inc;
+    std::vector< float > taps;
+    std::vector< gr_complex > shifted; /* the filter history, then the inputs */
+    size_t skip; /* inputs to take before the next output */
+  };
+
+  void design( vfo_t &vfo );
+  double actual_bandwidth( const vfo_t &vfo );
+
+  std::mutex _mutex;
+
+  double _rate;
+  size_t _min_decim;
+  std::vector< vfo_t > _vfos;
+};
+
+#endif /* INCLUDED_OSMOSDR_VFO_BANK_H */
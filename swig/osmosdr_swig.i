@@ -12,8 +12,10 @@
 
 %{
 #include "osmosdr/device.h"
+#include "osmosdr/settings.h"
 #include "osmosdr/source.h"
 #include "osmosdr/sink.h"
+#include "osmosdr/sweep.h"
 %}
 
 // Workaround for a SWIG 2.0.4 bug with templates. Probably needs to be looked in to.
@@ -47,6 +49,10 @@
 
 %include <osmosdr/time_spec.h>
 
+%template(channel_settings_vector_t) std::vector<osmosdr::channel_settings_t>; //define before settings
+%template(hop_schedule_t) std::vector<osmosdr::hop_t>; //define before settings
+%include <osmosdr/settings.h>
+
 %extend osmosdr::time_spec_t{
     osmosdr::time_spec_t __add__(const osmosdr::time_spec_t &what)
     {
@@ -70,11 +76,16 @@ BASE_NAME = BASE_NAME.make;
 %}
 %enddef
 
+// std::future has no python mapping, the "command" port covers the use case
+%rename("$ignore", regextarget=1, fullname=1) "^osmosdr::(source|sink)::.*_async$";
+
 %include "osmosdr/source.h"
 %include "osmosdr/sink.h"
+%include "osmosdr/sweep.h"
 
 OSMOSDR_SWIG_BLOCK_MAGIC2(osmosdr,source);
 OSMOSDR_SWIG_BLOCK_MAGIC2(osmosdr,sink);
+OSMOSDR_SWIG_BLOCK_MAGIC2(osmosdr,sweep);
 
 %{
 static const size_t ALL_MBOARDS = osmosdr::ALL_MBOARDS;